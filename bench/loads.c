@@ -0,0 +1,212 @@
+/*
+ * File: loads.c
+ * -------------
+ * Benchmark of loading restaurants in sorted, reverse-sorted and shuffled order of names.
+ * Generates restaurants, writes them in every order to a file in the form of restaurants.txt
+ * and times reading the file into a knowledge base. Then adds the same restaurants one at a
+ * time, as the add command does, which inserts into the trees one node at a time. Height of
+ * the name tree is printed after each load, so an order that unbalances it shows.
+ *
+ * usage: loads [-b] [restaurants]
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "Arena.h"
+#include "KnowledgeBase.h"
+#include "readFile.h"
+
+#define RESTAURANTS 200000 // Restaurants generated by default.
+#define CITIES      500    // Cities restaurants are spread over.
+#define CATEGORIES  40     // Categories restaurants take two of.
+
+typedef enum { // Define orders restaurants are loaded in.
+  SORTED, REVERSE, SHUFFLED
+} Order;
+
+/*
+ * Returns current time of a monotonic clock.
+ *
+ * return: seconds.
+ */
+double now() {
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+ * Gets number of levels of a tree, counted down its leftmost path for a B+ tree.
+ *
+ * *bt:    pointer to a binary tree.
+ * return: height of the tree.
+ */
+int treeHeight(BinaryTree *bt) {
+  int height = 1;
+
+  if (bt->backend == AVL) { // If tree is AVL, nodes know their height.
+    return getHeight(bt->root);
+  }
+  for (BPNode *node = bt->bplus->root; !node->leaf; node = node->children[0]) { // Descend.
+    height++;
+  }
+  return height;
+}
+
+/*
+ * Fills a list of restaurant numbers in an order. Names are made from numbers, so numbers in
+ * increasing order give names in sorted order.
+ *
+ * *numbers: list to fill.
+ * count:    number of restaurants.
+ * order:    order to fill in.
+ */
+void orderNumbers(int *numbers, int count, Order order) {
+  for (int i = 0; i < count; i++) { // Put numbers in sorted or reverse order.
+    numbers[i] = order == REVERSE ? count - 1 - i : i;
+  }
+  if (order != SHUFFLED) { // If numbers need no shuffle.
+    return;
+  }
+  srand(1);
+  for (int i = count - 1; i > 0; i--) { // Swap every number with one before it at random.
+    int j = (int)(((long long)rand() * RAND_MAX + rand()) % (i + 1));
+    int swap = numbers[i];
+
+    numbers[i] = numbers[j];
+    numbers[j] = swap;
+  }
+}
+
+/*
+ * Writes fields of a generated restaurant to strings. Fields depend only on its number.
+ *
+ * number:      number of the restaurant.
+ * *name:       buffer of at least 32 bytes for the name.
+ * *city:       buffer of at least 32 bytes for the city.
+ * *categories: buffer of at least 32 bytes for the categories.
+ * *cost:       buffer of at least 8 bytes for the cost.
+ * *rank:       pointer to the rank.
+ * *reviewers:  pointer to the number of reviewers.
+ */
+void makeFields(int number, char *name, char *city, char *categories, char *cost,
+    float *rank, int *reviewers) {
+  unsigned int hash = (unsigned int)number * 2654435761u;
+
+  sprintf(name, "Place %07d", number);
+  sprintf(city, "City%03u", hash % CITIES);
+  sprintf(categories, "Cat%02u, Cat%02u", (hash >> 9) % CATEGORIES,
+      (hash >> 15) % CATEGORIES);
+  memset(cost, '$', 1 + (hash >> 21) % 4);
+  cost[1 + (hash >> 21) % 4] = 0;
+  *rank      = (hash >> 7) % 51 / 10.0f;
+  *reviewers = (hash >> 3) % 5000;
+}
+
+/*
+ * Writes generated restaurants in an order to a file in the form of restaurants.txt.
+ *
+ * *fileName: name of the file.
+ * *numbers:  numbers of restaurants in the order to write them in.
+ * count:     number of restaurants.
+ */
+void writeRestaurants(char *fileName, int *numbers, int count) {
+  FILE *file = fopen(fileName, "w");
+  char name[32], city[32], categories[32], cost[8];
+  float rank;
+  int reviewers;
+
+  for (int i = 0; i < count; i++) { // Write every restaurant.
+    makeFields(numbers[i], name, city, categories, cost, &rank, &reviewers);
+    fprintf(file, "%s\n%s\n%s\nMonday 11:00 22:00, Friday 17:00 1:30\n%s\n%.1f\n%d\n\n",
+        name, city, categories, cost, rank, reviewers);
+  }
+  fclose(file);
+}
+
+/*
+ * Adds generated restaurants in an order to a knowledge base one at a time.
+ *
+ * *kb:      pointer to a knowledge base.
+ * *numbers: numbers of restaurants in the order to add them in.
+ * count:    number of restaurants.
+ */
+void addRestaurants(KnowledgeBase *kb, int *numbers, int count) {
+  char name[32], city[32], categories[32], cost[8];
+  char hours[] = "Monday 11:00 22:00, Friday 17:00 1:30";
+  float rank;
+  int reviewers;
+
+  for (int i = 0; i < count; i++) { // Add every restaurant.
+    makeFields(numbers[i], name, city, categories, cost, &rank, &reviewers);
+    addToKnowledgeBase(kb, initRestaurant(name, city, makeCategoryList(categories), hours,
+        cost, rank, reviewers));
+  }
+}
+
+/*
+ * Runs the benchmark.
+ *
+ * argc:   number of arguments.
+ * **argv: -b for B+ trees, and number of restaurants, both optional.
+ * return: 0 upon successful execution, 1 if file could not be written.
+ */
+int main(int argc, char **argv) {
+  TreeBackend backend = argc > 1 && strcmp(argv[1], "-b") == 0 ? BPLUS : AVL;
+  int next  = backend == BPLUS ? 2 : 1;
+  int count = argc > next && atoi(argv[next]) > 0 ? atoi(argv[next]) : RESTAURANTS;
+  int *numbers = (int*)malloc(count * sizeof(int));
+  char fileName[] = "/tmp/loadsXXXXXX";
+  char *orders[3] = {"sorted", "reverse", "shuffled"};
+  int descriptor = mkstemp(fileName);
+
+  if (descriptor == -1) { // If file for generated restaurants cannot be made.
+    printf("Could not create file %s.\n", fileName);
+    return 1;
+  }
+  close(descriptor);
+
+  printf("%d restaurants, %s trees\n", count, backend == BPLUS ? "B+" : "AVL");
+  printf("%-10s %12s %12s %12s %12s\n", "order", "read s", "height", "add s", "height");
+  for (int o = SORTED; o <= SHUFFLED; o++) { // Load restaurants in every order.
+    Arena *arena;
+    KnowledgeBase *kb;
+    double start;
+    double read;
+    double add;
+    int readHeight;
+
+    orderNumbers(numbers, count, o);
+    writeRestaurants(fileName, numbers, count);
+
+    arena = createArena();
+    useArena(arena);
+    kb = createKnowledgeBase(backend);
+    start = now();
+    readFile(fileName, kb);
+    read = now() - start;
+    readHeight = treeHeight(kb->btName);
+    releaseArena(arena);
+
+    arena = createArena();
+    useArena(arena);
+    kb = createKnowledgeBase(backend);
+    start = now();
+    addRestaurants(kb, numbers, count);
+    add = now() - start;
+    printf("%-10s %12.3f %12d %12.3f %12d\n", orders[o], read, readHeight, add,
+        treeHeight(kb->btName));
+    releaseArena(arena);
+  }
+
+  unlink(fileName);
+  free(numbers);
+  return 0;
+}
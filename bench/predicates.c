@@ -0,0 +1,151 @@
+/*
+ * File: predicates.c
+ * ------------------
+ * Microbenchmark of predicate kernels. Fills cost, reviewers and rank columns with random
+ * values, selects the same range from them with scalar and AVX2 kernels, and prints how many
+ * million rows per second each kernel tests. Kernels are built with the flags of the rest of
+ * the program, so numbers follow its optimization level.
+ *
+ * usage: predicates [rows] [rounds]
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Predicate.h"
+
+#define ROWS   (4 * 1024 * 1024) // Rows of every column by default.
+#define ROUNDS 20                // Runs of every kernel by default, the best one is reported.
+
+typedef enum { // Define columns the kernels are run on.
+  BYTES, INTS, FLOATS
+} Kind;
+
+/*
+ * Returns current time of a monotonic clock.
+ *
+ * return: seconds.
+ */
+double now() {
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+ * Selects rows of a column within the range of its kind with a kernel.
+ *
+ * kind:    column to run on.
+ * simd:    1 to run the AVX2 kernel, 0 to run the scalar one.
+ * *column: first row of the column.
+ * rows:    number of rows.
+ * *words:  selection words with room for all rows.
+ */
+void runKernel(Kind kind, int simd, void *column, int rows, uint64_t *words) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (simd && kind == BYTES) { // If bytes are tested by AVX2.
+    selectBytesAVX2((unsigned char*)column, rows, 2, 3, words);
+    return;
+  } else if (simd && kind == INTS) { // If integers are tested by AVX2.
+    selectIntsAVX2((int*)column, rows, 100, 5000, words);
+    return;
+  } else if (simd) { // If floats are tested by AVX2.
+    selectFloatsAVX2((float*)column, rows, 4.0f, 5.0f, words);
+    return;
+  }
+#endif
+  if (kind == BYTES) { // If bytes are tested one at a time.
+    selectBytesScalar((unsigned char*)column, rows, 2, 3, words);
+  } else if (kind == INTS) { // If integers are tested one at a time.
+    selectIntsScalar((int*)column, rows, 100, 5000, words);
+  } else { // Floats are tested one at a time.
+    selectFloatsScalar((float*)column, rows, 4.0f, 5.0f, words);
+  }
+}
+
+/*
+ * Runs a kernel on a column and returns its best time over a number of rounds.
+ *
+ * kind:    column to run on.
+ * simd:    1 to run the AVX2 kernel, 0 to run the scalar one.
+ * *column: first row of the column.
+ * rows:    number of rows.
+ * rounds:  number of runs.
+ * *words:  selection words with room for all rows.
+ * return:  seconds of the fastest run.
+ */
+double timeKernel(Kind kind, int simd, void *column, int rows, int rounds, uint64_t *words) {
+  double best = 1e9;
+
+  for (int r = 0; r < rounds; r++) { // Run the kernel, keeping the fastest run.
+    double start = now();
+    double elapsed;
+
+    runKernel(kind, simd, column, rows, words);
+    elapsed = now() - start;
+    if (elapsed < best) { // If run is the fastest so far.
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+/*
+ * Runs the benchmark.
+ *
+ * argc:    number of arguments.
+ * **argv:  number of rows and of rounds, both optional.
+ * return:  0 upon successful execution, 1 if kernels disagree.
+ */
+int main(int argc, char **argv) {
+  int rows   = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : ROWS;
+  int rounds = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : ROUNDS;
+  int words  = (rows + 63) / 64;
+  unsigned char *costs = (unsigned char*)malloc(rows);
+  int *reviewers = (int*)malloc(rows * sizeof(int));
+  float *ranks = (float*)malloc(rows * sizeof(float));
+  uint64_t *scalarWords = (uint64_t*)malloc(words * sizeof(uint64_t));
+  uint64_t *simdWords = (uint64_t*)malloc(words * sizeof(uint64_t));
+  void *columns[3] = {costs, reviewers, ranks};
+  char *names[3] = {"cost (bytes)", "reviewers (ints)", "rank (floats)"};
+  int failed = 0;
+
+  srand(1);
+  for (int i = 0; i < rows; i++) { // Fill columns with random values.
+    costs[i]     = 1 + rand() % 4;
+    reviewers[i] = rand() % 10000;
+    ranks[i]     = (rand() % 51) / 10.0f;
+  }
+
+  printf("%d rows, best of %d rounds, AVX2 %s\n", rows, rounds,
+      simdPredicates() ? "supported" : "not supported");
+  printf("%-18s %16s %16s\n", "column", "scalar Mrows/s", "AVX2 Mrows/s");
+  for (int k = 0; k < 3; k++) { // Time both kernels of every column.
+    double scalar = timeKernel(k, 0, columns[k], rows, rounds, scalarWords);
+    double simd;
+
+    if (!simdPredicates()) { // If AVX2 kernels cannot run here.
+      printf("%-18s %16.0f %16s\n", names[k], rows / scalar / 1e6, "-");
+      continue;
+    }
+    simd = timeKernel(k, 1, columns[k], rows, rounds, simdWords);
+
+    printf("%-18s %16.0f %16.0f\n", names[k], rows / scalar / 1e6, rows / simd / 1e6);
+    if (memcmp(scalarWords, simdWords, words * sizeof(uint64_t)) != 0) { // If they disagree.
+      printf("kernels of %s select different rows\n", names[k]);
+      failed = 1;
+    }
+  }
+
+  free(costs);
+  free(reviewers);
+  free(ranks);
+  free(scalarWords);
+  free(simdWords);
+  return failed;
+}
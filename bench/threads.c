@@ -0,0 +1,173 @@
+/*
+ * File: threads.c
+ * ---------------
+ * Benchmark of scans and filters run in morsels on a pool of threads. Generates restaurants,
+ * loads them into a knowledge base and times column scans, candidate filters and a fuzzy
+ * search with 1 thread, then with twice as many up to the given number. Every operation is
+ * run a few times and the fastest run is printed, in milliseconds. Results of every number of
+ * threads are checked against those of 1 thread, as they should be the same.
+ *
+ * usage: threads [restaurants] [threads]
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "Arena.h"
+#include "KnowledgeBase.h"
+#include "readFile.h"
+#include "search.h"
+#include "ThreadPool.h"
+
+#define RESTAURANTS 1000000 // Restaurants generated by default.
+#define CITIES      500     // Cities restaurants are spread over.
+#define CATEGORIES  40      // Categories restaurants take two of.
+#define ROUNDS      5       // Runs of every operation, the fastest one is printed.
+#define OPERATIONS  5       // Number of timed operations.
+
+typedef struct { // Define data the timed operations run on.
+  KnowledgeBase *kb;
+  ColumnRange rank;       // Range of ranks that a rank scan and filter select.
+  ColumnRange cost;       // Range of costs that a cost scan selects.
+  Bitmap *candidates;     // Candidates of the filters.
+  LinkedList *categories; // Categories a category filter keeps.
+} Workload;
+
+/*
+ * Returns current time of a monotonic clock.
+ *
+ * return: seconds.
+ */
+double now() {
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/*
+ * Generates restaurants with fields depending only on their number, in order of names.
+ *
+ * count:  number of restaurants.
+ * return: pointer to an array list of generated restaurants.
+ */
+ArrayList *generateRestaurants(int count) {
+  ArrayList *list = createArrayList();
+  char hours[] = "Monday 11:00 22:00, Friday 17:00 1:30";
+  char name[32], city[32], categories[32], cost[8];
+
+  for (int i = 0; i < count; i++) { // Generate every restaurant.
+    unsigned int hash = (unsigned int)i * 2654435761u;
+
+    sprintf(name, "Place %07d", i);
+    sprintf(city, "City%03u", hash % CITIES);
+    sprintf(categories, "Cat%02u, Cat%02u", (hash >> 9) % CATEGORIES,
+        (hash >> 15) % CATEGORIES);
+    memset(cost, '$', 1 + (hash >> 21) % 4);
+    cost[1 + (hash >> 21) % 4] = 0;
+    insert(list, initRestaurant(name, city, makeCategoryList(categories), hours, cost,
+        (hash >> 7) % 51 / 10.0f, (hash >> 3) % 5000));
+  }
+  return list;
+}
+
+/*
+ * Runs an operation once on the current pool.
+ *
+ * *work:     pointer to the workload.
+ * operation: number of the operation.
+ * return:    number of found restaurants.
+ */
+int runOperation(Workload *work, int operation) {
+  Bitmap *found = NULL;
+  int count;
+
+  if (operation == 0) { // If ranks are scanned.
+    found = scanRange(work->kb->columns, &work->rank);
+  } else if (operation == 1) { // If costs are scanned.
+    found = scanRange(work->kb->columns, &work->cost);
+  } else if (operation == 2) { // If candidates are filtered by rank.
+    found = filterRange(work->kb, work->candidates, &work->rank);
+  } else if (operation == 3) { // If candidates are filtered by categories.
+    found = filterCategories(work->kb, work->candidates, work->categories);
+  } else { // Names are checked by a fuzzy search.
+    return getSize(fuzzySearch(work->kb, "Place 0123456", 2, -1));
+  }
+  count = bitmapCardinality(found);
+  freeBitmap(found);
+  return count;
+}
+
+/*
+ * Runs the benchmark.
+ *
+ * argc:   number of arguments.
+ * **argv: number of restaurants and most threads, both optional.
+ * return: 0 upon successful execution, 1 if results differ between numbers of threads.
+ */
+int main(int argc, char **argv) {
+  int count   = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : RESTAURANTS;
+  int threads = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2])
+      : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  char *names[OPERATIONS] = {"scan rank", "scan cost", "filter rank", "filter cats", "fuzzy"};
+  int expected[OPERATIONS];
+  char categories[] = "Cat01, Cat02, Cat03";
+  Workload work;
+  int failed = 0;
+  double start = now();
+
+  useArena(createArena());
+  work.kb = createKnowledgeBase(AVL);
+  loadKnowledgeBase(work.kb, generateRestaurants(count));
+  parseRange(">= 2.5", RANK_COLUMN, &work.rank);
+  parseRange("$$-$$$", COST_COLUMN, &work.cost);
+  work.candidates = scanRange(work.kb->columns, &work.cost);
+  work.categories = stringToList(categories);
+
+  printf("%d restaurants loaded in %.2f s, %ld processors online\n", count, now() - start,
+      sysconf(_SC_NPROCESSORS_ONLN));
+  printf("%-8s", "threads");
+  for (int o = 0; o < OPERATIONS; o++) { // Print name of every operation.
+    printf(" %12s", names[o]);
+  }
+  printf("   (ms, best of %d)\n", ROUNDS);
+
+  for (int t = 1; t > 0; t = t == threads ? 0 : t * 2 < threads ? t * 2 : threads) {
+    ThreadPool *pool = t > 1 ? createThreadPool(t) : NULL; // Run doubling threads up to all.
+
+    usePool(pool);
+    printf("%-8d", t);
+    for (int o = 0; o < OPERATIONS; o++) { // Time every operation.
+      double best = 1e9;
+
+      for (int r = 0; r < ROUNDS; r++) { // Run operation, keeping the fastest run.
+        double begin = now();
+        int found = runOperation(&work, o);
+        double elapsed = now() - begin;
+
+        best = elapsed < best ? elapsed : best;
+        if (t == 1 && r == 0) { // If this is the first run, its result is expected.
+          expected[o] = found;
+        } else if (found != expected[o]) { // If result differs from that of 1 thread.
+          failed = 1;
+        }
+      }
+      printf(" %12.2f", best * 1000);
+    }
+    printf("\n");
+    usePool(NULL);
+    if (pool != NULL) { // If workers were started, stop them.
+      freeThreadPool(pool);
+    }
+  }
+
+  if (failed) { // If some number of threads found other restaurants.
+    printf("results differ between numbers of threads\n");
+  }
+  return failed;
+}
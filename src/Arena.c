@@ -0,0 +1,193 @@
+/*
+ * file: Arena.c
+ * -------------
+ * Implements arena allocator for objects that live as long as the loaded knowledge base.
+ * Arena hands out memory from large blocks by bumping a pointer, and releases all of it at
+ * once. Constructors of restaurants, lists and tree nodes allocate from the current arena if
+ * one is in use, and from the heap otherwise. Every thread has its own current arena, so 
+ * threads parsing parts of a file allocate from arenas of their own.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Arena.h"
+
+static __thread Arena *currentArena = NULL; // Arena that constructors of this thread use.
+
+/*
+ * Initialyzes an empty arena. Blocks are only allocated on first use.
+ *
+ * return: pointer to a created arena.
+ */
+Arena *createArena() {
+  Arena *arena = (Arena*)malloc(sizeof(Arena));
+  arena->blocks   = NULL;
+  arena->nextSize = ARENA_FIRST_BLOCK;
+
+  return arena;
+}
+
+/*
+ * Allocates memory from an arena. Size is rounded up to keep allocations aligned. If the
+ * newest block has no room left, a new block is added, twice as large as the previous one
+ * until the maximum block size is reached, or large enough for the request.
+ *
+ * *arena: pointer to an arena to allocate from.
+ * size:   number of bytes to allocate.
+ * return: pointer to allocated memory.
+ */
+void *allocArena(Arena *arena, size_t size) {
+  ArenaBlock *block = arena->blocks;
+  void *memory;
+
+  size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+  if (block == NULL || block->used + size > block->size) { // If newest block is full.
+    size_t blockSize = arena->nextSize;
+
+    while (blockSize < size) { // Make sure request fits in the block.
+      blockSize *= 2;
+    }
+    if (arena->nextSize < ARENA_MAX_BLOCK) { // Grow blocks until the maximum size.
+      arena->nextSize *= 2;
+    }
+
+    block = (ArenaBlock*)malloc(ARENA_HEADER + blockSize);
+    block->next   = arena->blocks;
+    block->size   = blockSize;
+    block->used   = 0;
+    arena->blocks = block;
+  }
+
+  memory = (char*)block + ARENA_HEADER + block->used;
+  block->used += size;
+
+  return memory;
+}
+
+/*
+ * Checks if memory was allocated from an arena by comparing its address to every block.
+ *
+ * *arena:  pointer to an arena.
+ * *memory: pointer to memory.
+ * return:  1 if memory belongs to the arena, 0 otherwise.
+ */
+int ownsArena(Arena *arena, void *memory) {
+  for (ArenaBlock *block = arena->blocks; block != NULL; block = block->next) { // Check blocks.
+    char *data = (char*)block + ARENA_HEADER;
+
+    if ((char*)memory >= data && (char*)memory < data + block->size) { // If inside the block.
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Releases all memory allocated from an arena, block by block, and the arena itself. If the
+ * arena is in use, constructors go back to allocating from the heap.
+ *
+ * *arena: pointer to an arena to release.
+ */
+void releaseArena(Arena *arena) {
+  ArenaBlock *block = arena->blocks;
+
+  while (block != NULL) { // Free every block.
+    ArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+
+  if (currentArena == arena) { // Stop allocating from released arena.
+    currentArena = NULL;
+  }
+  free(arena);
+}
+
+/*
+ * Moves all blocks of an arena to another one, so they are released with it, and frees the 
+ * emptied arena. Blocks go after those of the other arena, which keeps allocating from its 
+ * newest block.
+ *
+ * *arena: pointer to an arena to move blocks to.
+ * *other: pointer to an arena to move blocks from.
+ */
+void mergeArena(Arena *arena, Arena *other) {
+  ArenaBlock **tail = &arena->blocks;
+
+  while (*tail != NULL) { // Find end of the list of blocks.
+    tail = &(*tail)->next;
+  }
+  *tail = other->blocks;
+  if (currentArena == other) { // Stop allocating from freed arena.
+    currentArena = NULL;
+  }
+  free(other);
+}
+
+/*
+ * Sets arena that constructors of the calling thread allocate from.
+ *
+ * *arena: pointer to an arena, NULL to allocate from the heap.
+ */
+void useArena(Arena *arena) {
+  currentArena = arena;
+}
+
+/*
+ * Gets arena that constructors of the calling thread allocate from.
+ *
+ * return: pointer to the arena, NULL if they allocate from the heap.
+ */
+Arena *getArena() {
+  return currentArena;
+}
+
+/*
+ * Allocates memory from the current arena, or from the heap if no arena is in use.
+ *
+ * size:   number of bytes to allocate.
+ * return: pointer to allocated memory.
+ */
+void *allocate(size_t size) {
+  if (currentArena != NULL) { // If arena is in use.
+    return allocArena(currentArena, size);
+  }
+  return malloc(size);
+}
+
+/*
+ * Allocates zeroed memory for an array from the current arena, or from the heap.
+ *
+ * count:  number of elements.
+ * size:   size of an element.
+ * return: pointer to allocated memory.
+ */
+void *allocateZeroed(size_t count, size_t size) {
+  void *memory;
+
+  if (currentArena == NULL) { // If allocating from the heap.
+    return calloc(count, size);
+  }
+
+  memory = allocArena(currentArena, count * size);
+  memset(memory, 0, count * size);
+
+  return memory;
+}
+
+/*
+ * Frees memory allocated from the heap. Memory that belongs to the current arena is left to
+ * be released with the arena.
+ *
+ * *memory: pointer to memory.
+ */
+void deallocate(void *memory) {
+  if (currentArena != NULL && ownsArena(currentArena, memory)) { // If memory is in the arena.
+    return;
+  }
+  free(memory);
+}
@@ -0,0 +1,116 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+/*
+ * file: Arena.h
+ * -------------
+ * Implements arena allocator for objects that live as long as the loaded knowledge base.
+ * Arena hands out memory from large blocks by bumping a pointer, and releases all of it at
+ * once. Constructors of restaurants, lists and tree nodes allocate from the current arena if
+ * one is in use, and from the heap otherwise. Every thread has its own current arena, so 
+ * threads parsing parts of a file allocate from arenas of their own.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stddef.h>
+
+#define ARENA_FIRST_BLOCK (64 * 1024)        // Size of the first block of an arena.
+#define ARENA_MAX_BLOCK   (16 * 1024 * 1024) // Size after which blocks stop growing.
+#define ARENA_ALIGN       16                 // Alignment of every allocation.
+
+typedef struct ArenaBlock { // Define block of memory that allocations are carved from.
+  struct ArenaBlock *next;
+  size_t size;
+  size_t used;
+} ArenaBlock;
+
+// Size of a block header, rounded up so that block data stays aligned.
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+typedef struct { // Define arena as a list of blocks, the newest one first.
+  ArenaBlock *blocks;
+  size_t nextSize;
+} Arena;
+
+/*
+ * Initialyzes an empty arena.
+ *
+ * return: pointer to a created arena.
+ */
+extern Arena *createArena();
+
+/*
+ * Allocates memory from an arena.
+ *
+ * Arena*: pointer to an arena to allocate from.
+ * size_t: number of bytes to allocate.
+ * return: pointer to allocated memory.
+ */
+extern void *allocArena(Arena*, size_t);
+
+/*
+ * Checks if memory was allocated from an arena.
+ *
+ * Arena*: pointer to an arena.
+ * void*:  pointer to memory.
+ * return: 1 if memory belongs to the arena, 0 otherwise.
+ */
+extern int ownsArena(Arena*, void*);
+
+/*
+ * Releases all memory allocated from an arena, and the arena itself.
+ *
+ * Arena*: pointer to an arena to release.
+ */
+extern void releaseArena(Arena*);
+
+/*
+ * Moves all blocks of an arena to another one and frees the emptied arena.
+ *
+ * Arena*: pointer to an arena to move blocks to.
+ * Arena*: pointer to an arena to move blocks from.
+ */
+extern void mergeArena(Arena*, Arena*);
+
+/*
+ * Sets arena that constructors of the calling thread allocate from.
+ *
+ * Arena*: pointer to an arena, NULL to allocate from the heap.
+ */
+extern void useArena(Arena*);
+
+/*
+ * Gets arena that constructors of the calling thread allocate from.
+ *
+ * return: pointer to the arena, NULL if they allocate from the heap.
+ */
+extern Arena *getArena();
+
+/*
+ * Allocates memory from the current arena, or from the heap if no arena is in use.
+ *
+ * size_t: number of bytes to allocate.
+ * return: pointer to allocated memory.
+ */
+extern void *allocate(size_t);
+
+/*
+ * Allocates zeroed memory for an array from the current arena, or from the heap.
+ *
+ * size_t: number of elements.
+ * size_t: size of an element.
+ * return: pointer to allocated memory.
+ */
+extern void *allocateZeroed(size_t, size_t);
+
+/*
+ * Frees memory allocated from the heap. Memory that belongs to the current arena is left to
+ * be released with the arena.
+ *
+ * void*: pointer to memory.
+ */
+extern void deallocate(void*);
+
+#endif
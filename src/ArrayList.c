@@ -11,18 +11,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ArrayList.h"
+#include "Arena.h"
 
 /*
  * Initialyzes array list. Allocates memory for the structure and ten individual element 
- * pointers. Sets space and size fields equal to zero. Space is total memory locations, size is 
- * occupied memory locations.
+ * pointers from the current arena, if one is in use. Sets space and size fields equal to zero. 
+ * Space is total memory locations, size is occupied memory locations.
  *
  * return: pointer to a created array list.
  */
 ArrayList *createArrayList() {
   ArrayList *arrayList;
-  arrayList = malloc(sizeof(ArrayList));
-  arrayList->restaurants = (Restaurant**)calloc(10, sizeof(Restaurant*));
+  arrayList = (ArrayList*)allocate(sizeof(ArrayList));
+  arrayList->restaurants = (Restaurant**)allocateZeroed(10, sizeof(Restaurant*));
   arrayList->space = 10;
   arrayList->size = 0;
 
@@ -61,18 +62,19 @@ Restaurant *getRestaurant(ArrayList *arrayList, int index) {
 
 /*
  * Inserts a new element pointer at the back of the array list. If array list is full, copies 
- * its element pointers to a new array list of double size, and adds new element at the end of 
- * a new list.
+ * its element pointers to a new array list of double size, releases the old one, and adds new 
+ * element at the end of a new list.
  *
  * *arrayList: pointer to a target array list.
  * restaurant: pointer to an element to be inserted in the list.
  */
 void insert(ArrayList *arrayList, Restaurant *restaurant) {
   if (getSize(arrayList) == getSpace(arrayList)) { // Check if list is full.
-    Restaurant **restaurants = (Restaurant**)calloc(getSpace(arrayList) * 2, 
+    Restaurant **restaurants = (Restaurant**)allocateZeroed(getSpace(arrayList) * 2, 
       sizeof(Restaurant*));
 
     copy(arrayList->restaurants, restaurants, getSpace(arrayList));
+    deallocate(arrayList->restaurants);
     arrayList->restaurants = restaurants;
     arrayList->space = getSpace(arrayList) * 2;
   }
@@ -135,6 +137,19 @@ char *toStringArrayList(ArrayList *arrayList) {
   return printbuf;
 }
 
+/*
+ * Writes information about all elements of the list to a file. Calls writeRestaurant() in a 
+ * loop.
+ *
+ * *arrayList: pointer to an array list.
+ * *file:      file to write to.
+ */
+void writeArrayList(ArrayList *arrayList, FILE *file) {
+  for (int i = 0; i < getSize(arrayList); i++) { // Write each restaurant.
+    writeRestaurant(arrayList->restaurants[i], file);
+  }
+}
+
 /*
  * Duplicates existing array list with all of its contents. Creates a new array list and 
  * iteratevly inserts elements from the first list into the new one.
@@ -92,6 +92,14 @@ extern void printAll(ArrayList*);
  */
 extern char* toStringArrayList(ArrayList*);
 
+/*
+ * Writes information about all elements of the list to a file.
+ *
+ * ArrayList*: pointer to an array list.
+ * FILE*:      file to write to.
+ */
+extern void writeArrayList(ArrayList*, FILE*);
+
 /*
  * Duplicates existing array list with all of its contents.
  * 
@@ -0,0 +1,497 @@
+/*
+ * file: BPlusTree.c
+ * -----------------
+ * Implements B+ tree data structure to store buckets of restaurants sharing a key. Internal
+ * nodes are wide, aligned to cache lines, and keep 8-byte key prefixes inline, so most
+ * comparisons on the way down never leave the node. Leaves are linked, so ordered traversal
+ * walks them sequentially. Functionality includes creating, inserting in, searching,
+ * removing from, and traversing a B+ tree.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "BPlusTree.h"
+#include "BinaryTree.h"
+#include "Arena.h"
+
+/*
+ * Initialyzes B+ tree. Root of an empty tree is an empty leaf.
+ *
+ * return: pointer to a created B+ tree.
+ */
+BPlusTree *createBPlusTree() {
+  BPlusTree *tree = (BPlusTree*)malloc(sizeof(BPlusTree));
+  tree->root = createBPNode(1);
+
+  return tree;
+}
+
+/*
+ * Creates an empty B+ tree node. Node size is rounded up to a whole number of cache lines and
+ * node is allocated on a cache line boundary, so the prefix array starts a fresh line.
+ *
+ * leaf:   1 if node is a leaf, 0 otherwise.
+ * return: pointer to a created node.
+ */
+BPNode *createBPNode(int leaf) {
+  size_t size = (sizeof(BPNode) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+  BPNode *node = (BPNode*)aligned_alloc(CACHE_LINE, size);
+
+  memset(node, 0, size);
+  node->leaf = leaf;
+
+  return node;
+}
+
+/*
+ * Packs first eight bytes of a key into an integer, most significant byte first. Shorter keys
+ * are padded with zeros, so comparing prefixes gives the same order as comparing keys, unless
+ * prefixes are equal.
+ *
+ * *key:   key to be packed.
+ * return: prefix of the key.
+ */
+uint64_t keyPrefix(char *key) {
+  uint64_t prefix = 0;
+
+  for (int i = 0; i < 8; i++) { // Shift in next byte, or zero past the end of the key.
+    prefix <<= 8;
+    if (*key != 0) { // If end of the key was not reached.
+      prefix |= (unsigned char)*key;
+      key++;
+    }
+  }
+  return prefix;
+}
+
+/*
+ * Compares a key to a key stored in a node. Inline prefixes are compared first, and full keys
+ * are only dereferenced when prefixes are equal.
+ *
+ * *node:  pointer to a node.
+ * index:  index of a key in the node.
+ * prefix: prefix of the key to compare.
+ * *key:   key to compare.
+ * return: negative, zero or positive if key is less, equal or greater than stored one.
+ */
+int compareBPKey(BPNode *node, int index, uint64_t prefix, char *key) {
+  if (prefix != node->prefixes[index]) { // If prefixes decide the order.
+    return prefix < node->prefixes[index] ? -1 : 1;
+  }
+  return strcmp(key, node->keys[index]);
+}
+
+/*
+ * Finds child of an internal node that covers a key. Keys equal to a separator belong to the
+ * right of it.
+ *
+ * *node:  pointer to an internal node.
+ * prefix: prefix of the key.
+ * *key:   key to route.
+ * return: index of a child.
+ */
+int findChild(BPNode *node, uint64_t prefix, char *key) {
+  int i = 0;
+
+  while (i < node->count && compareBPKey(node, i, prefix, key) >= 0) { // Skip lesser keys.
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Finds position of the first key in a leaf that is not less than a given key.
+ *
+ * *node:  pointer to a leaf.
+ * prefix: prefix of the key.
+ * *key:   key to search for.
+ * return: index of a slot.
+ */
+int findSlot(BPNode *node, uint64_t prefix, char *key) {
+  int i = 0;
+
+  while (i < node->count && compareBPKey(node, i, prefix, key) > 0) { // Skip lesser keys.
+    i++;
+  }
+  return i;
+}
+
+/*
+ * Moves keys and their prefixes between positions of two nodes.
+ *
+ * *dest:  pointer to a node to move keys to.
+ * to:     index of the first destination slot.
+ * *src:   pointer to a node to move keys from.
+ * from:   index of the first source slot.
+ * num:    number of keys to move.
+ */
+void moveBPKeys(BPNode *dest, int to, BPNode *src, int from, int num) {
+  memmove(dest->prefixes + to, src->prefixes + from, num * sizeof(uint64_t));
+  memmove(dest->keys + to, src->keys + from, num * sizeof(char*));
+}
+
+/*
+ * Splits a full child of a node in two. Leaf keeps lower half of its keys and a copy of the
+ * first key of the upper half becomes a separator in the parent. Internal node moves its
+ * middle key up to the parent.
+ *
+ * *parent: pointer to a node which child is full.
+ * index:   index of the full child.
+ */
+void splitBPChild(BPNode *parent, int index) {
+  BPNode *child   = parent->children[index];
+  BPNode *sibling = createBPNode(child->leaf);
+  int half = BP_FANOUT / 2;
+
+  if (child->leaf) { // Upper half moves to a new leaf linked after the child.
+    sibling->count = BP_FANOUT - half;
+    moveBPKeys(sibling, 0, child, half, sibling->count);
+    memcpy(sibling->buckets, child->buckets + half, sibling->count * sizeof(BTNode*));
+    sibling->next = child->next;
+    child->next   = sibling;
+  } else { // Keys after the middle one move to a new node with their children.
+    sibling->count = BP_FANOUT - half - 1;
+    moveBPKeys(sibling, 0, child, half + 1, sibling->count);
+    memcpy(sibling->children, child->children + half + 1,
+        (sibling->count + 1) * sizeof(BPNode*));
+  }
+  child->count = half;
+
+  moveBPKeys(parent, index + 1, parent, index, parent->count - index);
+  memmove(parent->children + index + 2, parent->children + index + 1,
+      (parent->count - index) * sizeof(BPNode*));
+  if (child->leaf) { // Separator is a copy of the first key in the new leaf.
+    parent->prefixes[index] = sibling->prefixes[0];
+    parent->keys[index]     = sibling->keys[0];
+  } else { // Separator is the middle key of the child.
+    parent->prefixes[index] = child->prefixes[half];
+    parent->keys[index]     = child->keys[half];
+  }
+  parent->children[index + 1] = sibling;
+  parent->count++;
+}
+
+/*
+ * Builds an empty B+ tree bottom-up from buckets sorted by their keys. Buckets are spread 
+ * evenly over the fewest leaves that can hold them, and each level is then spread the same 
+ * way over the fewest internal nodes, so every node except the root holds at least BP_MIN 
+ * keys. Separator in front of each node is the smallest key under it, and is carried up 
+ * from the level below.
+ *
+ * *tree:     pointer to an empty B+ tree.
+ * **buckets: array of pointers to sorted buckets with distinct keys.
+ * count:     number of buckets.
+ */
+void buildBPlusTree(BPlusTree *tree, BTNode **buckets, int count) {
+  int num = (count + BP_FANOUT - 1) / BP_FANOUT;
+  BPNode **level = (BPNode**)malloc((num + 1) * sizeof(BPNode*));
+  char **lowest  = (char**)malloc((num + 1) * sizeof(char*));
+  int done = 0;
+
+  if (count == 0) { // If there is nothing to build.
+    free(level);
+    free(lowest);
+    return;
+  }
+
+  for (int i = 0; i < num; i++) { // Fill leaves with even shares of buckets.
+    BPNode *leaf = createBPNode(1);
+    leaf->count = (count - done) / (num - i);
+
+    for (int j = 0; j < leaf->count; j++) { // Copy buckets and their keys.
+      leaf->buckets[j]  = buckets[done + j];
+      leaf->keys[j]     = buckets[done + j]->name;
+      leaf->prefixes[j] = keyPrefix(leaf->keys[j]);
+    }
+    if (i > 0) { // If leaf follows another one.
+      level[i - 1]->next = leaf;
+    }
+    level[i]  = leaf;
+    lowest[i] = leaf->keys[0];
+    done += leaf->count;
+  }
+
+  while (num > 1) { // Build the next level until it has a single node.
+    int parents = (num + BP_FANOUT) / (BP_FANOUT + 1);
+    done = 0;
+
+    for (int i = 0; i < parents; i++) { // Give each parent an even share of children.
+      BPNode *parent = createBPNode(0);
+      int children = (num - done) / (parents - i);
+
+      parent->count = children - 1;
+      for (int j = 0; j < children; j++) { // Link children and separators in front of them.
+        parent->children[j] = level[done + j];
+        if (j > 0) { // If child has a separator in front of it.
+          parent->keys[j - 1]     = lowest[done + j];
+          parent->prefixes[j - 1] = keyPrefix(lowest[done + j]);
+        }
+      }
+      lowest[i] = lowest[done];
+      level[i]  = parent;
+      done += children;
+    }
+    num = parents;
+  }
+
+  free(tree->root);
+  tree->root = level[0];
+
+  free(level);
+  free(lowest);
+}
+
+/*
+ * Inserts a restaurant in a bucket with a given key. Descends from the root, splitting full
+ * nodes on the way, so a leaf always has room for a new bucket. If a bucket with the key
+ * already exists, restaurant is inserted in its array list.
+ *
+ * *tree:       pointer to a B+ tree to insert in.
+ * *key:        key of the restaurant.
+ * *restaurant: pointer to a restaurant to insert.
+ * return:      pointer to the bucket holding the restaurant.
+ */
+struct BTNode *insertInBPlusTree(BPlusTree *tree, char *key, Restaurant *restaurant) {
+  uint64_t prefix = keyPrefix(key);
+  BPNode *node;
+  BTNode *bucket;
+  int i;
+
+  if (tree->root->count == BP_FANOUT) { // If root is full, grow the tree by one level.
+    BPNode *root = createBPNode(0);
+    root->children[0] = tree->root;
+    tree->root = root;
+    splitBPChild(root, 0);
+  }
+
+  node = tree->root;
+  while (!node->leaf) { // Descend to a leaf.
+    i = findChild(node, prefix, key);
+    if (node->children[i]->count == BP_FANOUT) { // Split full child before entering it.
+      splitBPChild(node, i);
+      if (compareBPKey(node, i, prefix, key) >= 0) { // If key belongs to the new half.
+        i++;
+      }
+    }
+    node = node->children[i];
+  }
+
+  i = findSlot(node, prefix, key);
+  if (i < node->count && compareBPKey(node, i, prefix, key) == 0) { // If bucket exists.
+    insert(node->buckets[i]->restaurants, restaurant);
+    return node->buckets[i];
+  }
+
+  bucket = createBTNode(restaurant);
+  bucket->name = key;
+  moveBPKeys(node, i + 1, node, i, node->count - i);
+  memmove(node->buckets + i + 1, node->buckets + i, (node->count - i) * sizeof(BTNode*));
+  node->prefixes[i] = prefix;
+  node->keys[i]     = key;
+  node->buckets[i]  = bucket;
+  node->count++;
+
+  return bucket;
+}
+
+/*
+ * Searches B+ tree for a bucket with a given key. Descends to a leaf comparing inline prefixes
+ * and checks the slot where key would be.
+ *
+ * *tree:  pointer to a B+ tree to search.
+ * *key:   key to be searched for.
+ * return: pointer to a found bucket, NULL otherwise.
+ */
+BTNode *searchBPlus(BPlusTree *tree, char *key) {
+  uint64_t prefix = keyPrefix(key);
+  BPNode *node = tree->root;
+  int i;
+
+  while (!node->leaf) { // Descend to a leaf.
+    node = node->children[findChild(node, prefix, key)];
+  }
+
+  i = findSlot(node, prefix, key);
+  if (i < node->count && compareBPKey(node, i, prefix, key) == 0) { // If key was found.
+    return node->buckets[i];
+  }
+  return NULL;
+}
+
+/*
+ * Moves one key from the left sibling of a child into the child. Leaf takes the last bucket
+ * of its sibling, internal node takes the separator and the last child of its sibling.
+ *
+ * *parent: pointer to a parent of the child.
+ * index:   index of the child.
+ */
+void borrowFromLeft(BPNode *parent, int index) {
+  BPNode *child = parent->children[index];
+  BPNode *left  = parent->children[index - 1];
+
+  moveBPKeys(child, 1, child, 0, child->count);
+  if (child->leaf) { // Last bucket of the sibling becomes the first one of the child.
+    memmove(child->buckets + 1, child->buckets, child->count * sizeof(BTNode*));
+    child->prefixes[0] = left->prefixes[left->count - 1];
+    child->keys[0]     = left->keys[left->count - 1];
+    child->buckets[0]  = left->buckets[left->count - 1];
+    parent->prefixes[index - 1] = child->prefixes[0];
+    parent->keys[index - 1]     = child->keys[0];
+  } else { // Separator comes down, last key of the sibling goes up.
+    memmove(child->children + 1, child->children, (child->count + 1) * sizeof(BPNode*));
+    child->prefixes[0] = parent->prefixes[index - 1];
+    child->keys[0]     = parent->keys[index - 1];
+    child->children[0] = left->children[left->count];
+    parent->prefixes[index - 1] = left->prefixes[left->count - 1];
+    parent->keys[index - 1]     = left->keys[left->count - 1];
+  }
+  left->count--;
+  child->count++;
+}
+
+/*
+ * Moves one key from the right sibling of a child into the child. Leaf takes the first bucket
+ * of its sibling, internal node takes the separator and the first child of its sibling.
+ *
+ * *parent: pointer to a parent of the child.
+ * index:   index of the child.
+ */
+void borrowFromRight(BPNode *parent, int index) {
+  BPNode *child = parent->children[index];
+  BPNode *right = parent->children[index + 1];
+
+  if (child->leaf) { // First bucket of the sibling becomes the last one of the child.
+    moveBPKeys(child, child->count, right, 0, 1);
+    child->buckets[child->count] = right->buckets[0];
+    moveBPKeys(right, 0, right, 1, right->count - 1);
+    memmove(right->buckets, right->buckets + 1, (right->count - 1) * sizeof(BTNode*));
+    parent->prefixes[index] = right->prefixes[0];
+    parent->keys[index]     = right->keys[0];
+  } else { // Separator comes down, first key of the sibling goes up.
+    child->prefixes[child->count]     = parent->prefixes[index];
+    child->keys[child->count]         = parent->keys[index];
+    child->children[child->count + 1] = right->children[0];
+    parent->prefixes[index] = right->prefixes[0];
+    parent->keys[index]     = right->keys[0];
+    moveBPKeys(right, 0, right, 1, right->count - 1);
+    memmove(right->children, right->children + 1, right->count * sizeof(BPNode*));
+  }
+  right->count--;
+  child->count++;
+}
+
+/*
+ * Merges two adjacent children of a node into the left one. Internal nodes also take the
+ * separator between them. Separator and the right child are removed from the parent.
+ *
+ * *parent: pointer to a parent of the children.
+ * index:   index of the left child.
+ */
+void mergeBPChildren(BPNode *parent, int index) {
+  BPNode *left  = parent->children[index];
+  BPNode *right = parent->children[index + 1];
+
+  if (left->leaf) { // Buckets of the right leaf are appended, and it is unlinked.
+    moveBPKeys(left, left->count, right, 0, right->count);
+    memcpy(left->buckets + left->count, right->buckets, right->count * sizeof(BTNode*));
+    left->count += right->count;
+    left->next   = right->next;
+  } else { // Separator and keys of the right node are appended with its children.
+    left->prefixes[left->count] = parent->prefixes[index];
+    left->keys[left->count]     = parent->keys[index];
+    moveBPKeys(left, left->count + 1, right, 0, right->count);
+    memcpy(left->children + left->count + 1, right->children,
+        (right->count + 1) * sizeof(BPNode*));
+    left->count += right->count + 1;
+  }
+
+  moveBPKeys(parent, index, parent, index + 1, parent->count - index - 1);
+  memmove(parent->children + index + 1, parent->children + index + 2,
+      (parent->count - index - 1) * sizeof(BPNode*));
+  parent->count--;
+  free(right);
+}
+
+/*
+ * Makes sure a child of a node holds more than the minimum number of keys, so one key can be
+ * removed from it. Borrows a key from a sibling if it can spare one, otherwise merges the
+ * child with a sibling.
+ *
+ * *parent: pointer to a parent of the child.
+ * index:   index of the child.
+ * return:  index of the child that covers the same keys afterwards.
+ */
+int fillBPChild(BPNode *parent, int index) {
+  if (index > 0 && parent->children[index - 1]->count > BP_MIN) { // Left sibling can spare.
+    borrowFromLeft(parent, index);
+  } else if (index < parent->count && parent->children[index + 1]->count > BP_MIN) {
+    borrowFromRight(parent, index);
+  } else if (index < parent->count) { // Merge with the right sibling.
+    mergeBPChildren(parent, index);
+  } else { // Merge with the left sibling.
+    mergeBPChildren(parent, index - 1);
+    index--;
+  }
+  return index;
+}
+
+/*
+ * Removes bucket with a given key from a B+ tree. Descends from the root, refilling children
+ * that hold the minimum number of keys on the way, so the leaf can lose a bucket without
+ * underflowing. If root is left without keys, its only child becomes the root.
+ *
+ * *tree: pointer to a B+ tree to remove from.
+ * *key:  key of the bucket to be removed.
+ */
+void removeBPlus(BPlusTree *tree, char *key) {
+  uint64_t prefix = keyPrefix(key);
+  BPNode *node = tree->root;
+  BTNode *bucket;
+  int i;
+
+  while (!node->leaf) { // Descend to a leaf.
+    i = findChild(node, prefix, key);
+    if (node->children[i]->count <= BP_MIN) { // Make sure child can lose a key.
+      i = fillBPChild(node, i);
+      if (node->count == 0) { // If root lost its last key, its only child becomes the root.
+        tree->root = node->children[0];
+        free(node);
+        node = tree->root;
+        continue;
+      }
+    }
+    node = node->children[i];
+  }
+
+  i = findSlot(node, prefix, key);
+  if (i == node->count || compareBPKey(node, i, prefix, key) != 0) { // If key is not stored.
+    return;
+  }
+
+  bucket = node->buckets[i];
+  moveBPKeys(node, i, node, i + 1, node->count - i - 1);
+  memmove(node->buckets + i, node->buckets + i + 1, (node->count - i - 1) * sizeof(BTNode*));
+  node->count--;
+
+  deallocate(bucket->restaurants->restaurants);
+  deallocate(bucket->restaurants);
+  deallocate(bucket);
+}
+
+/*
+ * Gets the leftmost leaf of a B+ tree by following first children from the root.
+ *
+ * *tree:  pointer to a B+ tree.
+ * return: pointer to the first leaf.
+ */
+BPNode *firstLeaf(BPlusTree *tree) {
+  BPNode *node = tree->root;
+
+  while (!node->leaf) { // Descend along the left edge.
+    node = node->children[0];
+  }
+  return node;
+}
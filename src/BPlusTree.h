@@ -0,0 +1,193 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+/*
+ * file: BPlusTree.h
+ * -----------------
+ * Implements B+ tree data structure to store buckets of restaurants sharing a key. Internal
+ * nodes are wide, aligned to cache lines, and keep 8-byte key prefixes inline, so most
+ * comparisons on the way down never leave the node. Leaves are linked, so ordered traversal
+ * walks them sequentially. Functionality includes creating, inserting in, searching,
+ * removing from, and traversing a B+ tree.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+#include "ArrayList.h"
+
+#define BP_FANOUT  16 // Maximum number of keys stored in a node.
+#define BP_MIN     7  // Minimum number of keys stored in a non-root node.
+#define CACHE_LINE 64 // Size of a cache line in bytes.
+
+struct BTNode;
+
+typedef struct BPNode { // Define B+ tree node holding keys and children or buckets.
+  int leaf;
+  int count;
+  uint64_t prefixes[BP_FANOUT];
+  char *keys[BP_FANOUT];
+  union {
+    struct BPNode *children[BP_FANOUT + 1];
+    struct BTNode *buckets[BP_FANOUT];
+  };
+  struct BPNode *next;
+} BPNode;
+
+typedef struct { // Define B+ tree structure.
+  BPNode *root;
+  int size;
+} BPlusTree;
+
+/*
+ * Initialyzes B+ tree with an empty leaf as a root.
+ *
+ * return: pointer to a created B+ tree.
+ */
+extern BPlusTree *createBPlusTree();
+
+/*
+ * Creates an empty B+ tree node aligned to a cache line.
+ *
+ * int:    1 if node is a leaf, 0 otherwise.
+ * return: pointer to a created node.
+ */
+extern BPNode *createBPNode(int);
+
+/*
+ * Packs first eight bytes of a key into an integer that compares like the key.
+ *
+ * char*:  key to be packed.
+ * return: prefix of the key.
+ */
+extern uint64_t keyPrefix(char*);
+
+/*
+ * Compares a key to a key stored in a node.
+ *
+ * BPNode*:  pointer to a node.
+ * int:      index of a key in the node.
+ * uint64_t: prefix of the key to compare.
+ * char*:    key to compare.
+ * return:   negative, zero or positive if key is less, equal or greater than stored one.
+ */
+extern int compareBPKey(BPNode*, int, uint64_t, char*);
+
+/*
+ * Finds child of an internal node that covers a key.
+ *
+ * BPNode*:  pointer to an internal node.
+ * uint64_t: prefix of the key.
+ * char*:    key to route.
+ * return:   index of a child.
+ */
+extern int findChild(BPNode*, uint64_t, char*);
+
+/*
+ * Finds position of the first key in a leaf that is not less than a given key.
+ *
+ * BPNode*:  pointer to a leaf.
+ * uint64_t: prefix of the key.
+ * char*:    key to search for.
+ * return:   index of a slot.
+ */
+extern int findSlot(BPNode*, uint64_t, char*);
+
+/*
+ * Moves keys and their prefixes between positions of two nodes.
+ *
+ * BPNode*: pointer to a node to move keys to.
+ * int:     index of the first destination slot.
+ * BPNode*: pointer to a node to move keys from.
+ * int:     index of the first source slot.
+ * int:     number of keys to move.
+ */
+extern void moveBPKeys(BPNode*, int, BPNode*, int, int);
+
+/*
+ * Splits a full child of a node in two.
+ *
+ * BPNode*: pointer to a node which child is full.
+ * int:     index of the full child.
+ */
+extern void splitBPChild(BPNode*, int);
+
+/*
+ * Moves one key from the left sibling of a child into the child.
+ *
+ * BPNode*: pointer to a parent of the child.
+ * int:     index of the child.
+ */
+extern void borrowFromLeft(BPNode*, int);
+
+/*
+ * Moves one key from the right sibling of a child into the child.
+ *
+ * BPNode*: pointer to a parent of the child.
+ * int:     index of the child.
+ */
+extern void borrowFromRight(BPNode*, int);
+
+/*
+ * Merges two adjacent children of a node into the left one.
+ *
+ * BPNode*: pointer to a parent of the children.
+ * int:     index of the left child.
+ */
+extern void mergeBPChildren(BPNode*, int);
+
+/*
+ * Makes sure a child of a node holds more than the minimum number of keys.
+ *
+ * BPNode*: pointer to a parent of the child.
+ * int:     index of the child.
+ * return:  index of the child that covers the same keys afterwards.
+ */
+extern int fillBPChild(BPNode*, int);
+
+/*
+ * Builds an empty B+ tree bottom-up from buckets sorted by their keys.
+ *
+ * BPlusTree*: pointer to an empty B+ tree.
+ * BTNode**:   array of pointers to sorted buckets with distinct keys.
+ * int:        number of buckets.
+ */
+extern void buildBPlusTree(BPlusTree*, struct BTNode**, int);
+
+/*
+ * Inserts a restaurant in a bucket with a given key, creating the bucket if needed.
+ *
+ * BPlusTree*:  pointer to a B+ tree to insert in.
+ * char*:       key of the restaurant.
+ * Restaurant*: pointer to a restaurant to insert.
+ * return:      pointer to the bucket holding the restaurant.
+ */
+extern struct BTNode *insertInBPlusTree(BPlusTree*, char*, Restaurant*);
+
+/*
+ * Searches B+ tree for a bucket with a given key.
+ *
+ * BPlusTree*: pointer to a B+ tree to search.
+ * char*:      key to be searched for.
+ * return:     pointer to a found bucket, NULL otherwise.
+ */
+extern struct BTNode *searchBPlus(BPlusTree*, char*);
+
+/*
+ * Removes bucket with a given key from a B+ tree.
+ *
+ * BPlusTree*: pointer to a B+ tree to remove from.
+ * char*:      key of the bucket to be removed.
+ */
+extern void removeBPlus(BPlusTree*, char*);
+
+/*
+ * Gets the leftmost leaf of a B+ tree.
+ *
+ * BPlusTree*: pointer to a B+ tree.
+ * return:     pointer to the first leaf.
+ */
+extern BPNode *firstLeaf(BPlusTree*);
+
+#endif
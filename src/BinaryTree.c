@@ -3,44 +3,60 @@
  * ------------------
  * Implements binary tree data structure to store array lists of restaurants grouped into
  * nodes depending on the ordering rule. Functionality includes creating, insertind in, 
- * removing from, and creting string of information stored in a binary tree.
+ * removing from, and writing information stored in a binary tree. Tree is kept 
+ * AVL-balanced on insertion and removal, so its height stays logarithmic for any order of 
+ * insertion. Alternatively, the same buckets can be stored in a B+ tree.
  *
  * author: Max Turkot
  * version: 12/11/21
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include "BinaryTree.h"
+#include "Arena.h"
+#include "ColumnStore.h"
 
 /*
- * Initialyzes binary tree. Sets all fields to initial values.
+ * Initialyzes binary tree. Sets all fields to initial values. B+ tree is only created for the 
+ * BPLUS backend.
  *
- * order:  tree ordering rule (NAME or LOCATION).
- * return: pointer to a created binary tree.
+ * order:   tree ordering rule.
+ * backend: data structure storing the tree (AVL or BPLUS).
+ * return:  pointer to a created binary tree.
  */
-BinaryTree *createBinaryTree(TreeOrder order) {
+BinaryTree *createBinaryTree(TreeOrder order, TreeBackend backend) {
   BinaryTree *bt = (BinaryTree*)malloc(sizeof(BinaryTree));
-  bt->root  = 0;
-  bt->order = order;
-  bt->size  = 0;
+  bt->root    = 0;
+  bt->bplus   = 0;
+  bt->order   = order;
+  bt->backend = backend;
+  bt->size    = 0;
+
+  if (backend == BPLUS) { // Create B+ tree to hold the buckets.
+    bt->bplus = createBPlusTree();
+  }
 
   return bt;
 }
 
 /*
  * Creates a bt node to hold pointer to an array list of restaurants. Sets fields to initial 
- * values, creates an array list and inserts first restaurant in that list.
+ * values, creates an array list and inserts first restaurant in that list. Memory comes from 
+ * the current arena, if one is in use.
  *
  * *restaurant: pointer to a restaurant to be added to the array list.
  * return:      pointer to a created bt node.
  */
 BTNode *createBTNode(Restaurant *restaurant) {
-  BTNode *node = (BTNode*)malloc(sizeof(BTNode));
+  BTNode *node = (BTNode*)allocate(sizeof(BTNode));
 
-  node->left  = 0;
-  node->right = 0;
+  node->left   = 0;
+  node->right  = 0;
+  node->name   = 0;
+  node->height = 1;
   node->restaurants = createArrayList();
   insert(node->restaurants, restaurant);
 
@@ -48,398 +64,874 @@ BTNode *createBTNode(Restaurant *restaurant) {
 }
 
 /*
- * Manages insertion of a new element. If tree is empty, root is created. If not, depending on 
- * the ordering rule node is inserted.
+ * Manages insertion of a new element. Element is inserted by the key of the ordering rule, 
+ * in the binary tree or in the B+ tree. Written keys are copied, and the copy is dropped if 
+ * a node with the key already exists.
  *
  * *bt:        pointer to a binery tree to insert in.
  * *resturant: pointer to a restaurant to insert.
+ * return:     pointer to the node holding the restaurant.
  */
-void insertInBinaryTree(BinaryTree *bt, Restaurant *restaurant) {
-  if (bt->size == 0) { // Check if tree is empty.
-    bt->root = createBTNode(restaurant);
-  } else { // Insert based on ordering rule.
-    if (bt->order == NAME) { // If ordering rule set to name.
-      insertNodeName(bt->root, restaurant);
-    } else if (bt->order == LOCATION) { // If ordering fule set to location.
-      insertNodeCity(bt->root, restaurant);
-    } else { // If ordering rule is unknown.
-      printf("Unknown order rule: %d", bt->order);
-    }
+BTNode *insertInBinaryTree(BinaryTree *bt, Restaurant *restaurant) {
+  char buffer[TREE_KEY_SIZE];
+  char *key = writeTreeKey(bt->order, restaurant, buffer);
+  int written = key == buffer;
+  BTNode *holder;
+
+  if (written) { // If key was written, copy it for a node that may keep it.
+    key = copyKey(buffer);
+  }
+  if (bt->backend == BPLUS) { // If tree is stored in a B+ tree.
+    holder = insertInBPlusTree(bt->bplus, key, restaurant);
+  } else { // Tree is stored in binary tree nodes.
+    holder = insertBTNode(bt, key, restaurant);
+  }
+  if (written && holder->name != key) { // If node with the key already existed.
+    deallocate(key);
   }
   bt->size++;
+
+  return holder;
 }
 
 /*
- * Inserts an element in a binary tree ordered by name. If name is less than that of current 
- * node and node has no left child, insert as a left child. If not, pass insertion to the 
- * left child. Same procedure if name is greater than that of a node, but on the right node.
- * If names are equal, insert element in the array list of current node.
+ * Copies a written key. Memory comes from the current arena, if one is in use.
  *
- * *parent:     pointer to a root of binary tree.
- * *restaurant: pointer to a restaurant to insert.
+ * *key:   key to copy.
+ * return: copy of the key.
  */
-void insertNodeName(BTNode *parent, Restaurant *restaurant) {
-  char *restaurantName = restaurant->name;
-  char *parentName     = getRestaurant(parent->restaurants, 0)->name;
+char *copyKey(char *key) {
+  char *copy = (char*)allocate(strlen(key) + 1);
 
-  int diff = strcmp(restaurantName, parentName);
+  strcpy(copy, key);
+  return copy;
+}
 
-  if (diff > 0) { // If new restaurant name is greater than that of node.
-    if (parent->right == 0) { // If no right child.
-      parent->right = createBTNode(restaurant);
-    } else { // Pass insertion to right child.
-      insertNodeName(parent->right, restaurant);
-    }
-  } else if (diff < 0) { // If new restaurant name is less than that of node.
-    if (parent->left == 0) { // If no left child.
-      parent->left = createBTNode(restaurant);
-    } else { // Pass insertion to left child.
-      insertNodeName(parent->left, restaurant);
-    }
-  } else { // Insert in the array list of node.
-    insert(parent->restaurants, restaurant);
+/*
+ * Gets key of a restaurant under an ordering rule. Name and city are keys 
+ * as they are. Numeric keys are written to a buffer as hex digits of values turned into 
+ * unsigned integers that compare like them, so they order restaurants from the best one: 
+ * rank and number of reviewers go from the greatest one, and cost from the cheapest one. 
+ * Every numeric key ends with the rank key, so restaurants with equal values are ordered by 
+ * rank and then by number of reviewers, and nodes stay small.
+ *
+ * order:       ordering rule.
+ * *restaurant: pointer to a restaurant.
+ * *buffer:     buffer with room for TREE_KEY_SIZE bytes.
+ * return:      key of the restaurant, the buffer if key was written to it.
+ */
+char *writeTreeKey(TreeOrder order, Restaurant *restaurant, char *buffer) {
+  if (order == NAME) { // If ordering rule set to name.
+    return restaurant->name;
+  } else if (order == LOCATION) { // If ordering rule set to location.
+    return restaurant->city;
+  } else if (order == RANK) { // If ordering rule set to rank.
+    writeRankKey(restaurant->rank, restaurant->reviewers, buffer);
+  } else if (order == REVIEWERS) { // If ordering rule set to number of reviewers.
+    writeHexKey(reviewersBits(restaurant->reviewers), 8, buffer);
+    writeHexKey(rankBits(restaurant->rank), 8, buffer + 8);
+  } else { // Ordering rule set to cost.
+    writeHexKey(costBits(costLevel(restaurant->cost)), 2, buffer);
+    writeRankKey(restaurant->rank, restaurant->reviewers, buffer + 2);
   }
+  return buffer;
 }
 
 /*
- * Inserts an element in a binary tree ordered by location. If location is less than that of 
- * current node and node has no left child, insert as a left child. If not, pass insertion to 
- * the left child. Same procedure if location is greater than that of a node, but on the right 
- * node. If locations are equal, insert element in the array list of current node.
+ * Writes key of a rank and a number of reviewers to a buffer, as 8 hex digits of each. Keys 
+ * order restaurants by rank and then by number of reviewers, both descending.
  *
- * *parent      pointer to a root of binary tree.
- * *restaurant: pointer to a restaurant to insert.
+ * rank:      rank.
+ * reviewers: number of reviewers.
+ * *key:      buffer with room for 17 bytes.
  */
-void insertNodeCity(BTNode *parent, Restaurant *restaurant) {
-  char *restaurantCity = restaurant->city;
-  char *parentCity     = getRestaurant(parent->restaurants, 0)->city;
-  int  diff            = strcmp(restaurantCity, parentCity);
+void writeRankKey(float rank, int reviewers, char *key) {
+  writeHexKey(rankBits(rank), 8, key);
+  writeHexKey(reviewersBits(reviewers), 8, key + 8);
+}
 
-  if (diff > 0) { // If new restaurant location is greater than that of node.
-    if (parent->right == 0) { // If no right child.
-      parent->right = createBTNode(restaurant);
-    } else { // Pass insertion to right child.
-      insertNodeCity(parent->right, restaurant);
-    }
-  } else if (diff < 0) { // If new restaurant location is less than that of node.
-    if (parent->left == 0) { // If no left child.
-      parent->left = createBTNode(restaurant);
-    } else { // Pass insertion to left child.
-      insertNodeCity(parent->left, restaurant);
-    }
-  } else { // Insert in the array list of node.
-    insert(parent->restaurants, restaurant);
+/*
+ * Turns a rank into bits that compare like it in reverse. Bits of a positive float are 
+ * flipped in the sign, and of a negative one in all places, which gives an unsigned integer 
+ * comparing like the float, and it is then complemented.
+ *
+ * rank:   rank.
+ * return: bits of the rank.
+ */
+uint32_t rankBits(float rank) {
+  uint32_t bits;
+
+  if (rank == 0) { // If rank is zero, drop its sign so both zeros share a key.
+    rank = 0;
   }
+  memcpy(&bits, &rank, sizeof(bits));
+  bits = bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+  return ~bits;
 }
 
 /*
- * Creates a string with information about elements stored. Calls inOrder() to traverse the 
- * tree and gather information.
+ * Turns a number of reviewers into bits that compare like it in reverse.
  *
- * *bt:    pointer to a binary tree.
- * return: string with information about elements stored in the binary tree.
+ * reviewers: number of reviewers.
+ * return:    bits of the number.
  */
-char *toStringBinaryTree(BinaryTree *bt) {
-  if (bt->root != 0) { // If tree is not empty.
-    char *printbuf = (char*)malloc(1024 * bt->size);
-    strcpy(printbuf, "");
-  
-    inOrder(bt->root, printbuf);
+uint32_t reviewersBits(int reviewers) {
+  return ~((uint32_t)reviewers ^ 0x80000000u);
+}
 
-    printbuf[strlen(printbuf) - 1] = 0;
+/*
+ * Turns a cost level into bits that compare like it, with levels past 255 sharing the last 
+ * bits.
+ *
+ * level:  cost level.
+ * return: bits of the level.
+ */
+uint32_t costBits(int level) {
+  return level > 255 ? 255 : level;
+}
 
-    return printbuf;
-  } else { // Return null.
-    return (char*) 0;
+/*
+ * Writes lowest hex digits of bits to a buffer, from the most significant one, so keys of 
+ * the same length compare like the bits.
+ *
+ * bits:   bits to write.
+ * digits: number of digits.
+ * *key:   buffer with room for the digits and a terminator.
+ */
+void writeHexKey(uint64_t bits, int digits, char *key) {
+  for (int i = digits - 1; i >= 0; i--) { // Write digits from the last one.
+    key[i] = "0123456789abcdef"[bits & 15];
+    bits >>= 4;
   }
+  key[digits] = 0;
 }
 
 /*
- * Traverses binary tree and appends node information to a string. First appends data fo the 
- * left child, that that of the node, and then information of the right child.
- * 
- * *node: pointer to a root of binary tree.
- * *p:    string to append information to.
+ * Sorts restaurants by the key of an ordering rule. Ties are broken by id, so restaurants with 
+ * equal keys keep the order in which they were added.
+ *
+ * **restaurants: array of pointers to restaurants.
+ * count:         number of restaurants.
+ * order:         ordering rule giving the key.
+ */
+void sortRestaurants(Restaurant **restaurants, int count, TreeOrder order) {
+  int (*compares[TREE_ORDERS])(const void*, const void*) = {compareByName, compareByCity, 
+      compareByRank, compareByReviewers, compareByCost};
+
+  qsort(restaurants, count, sizeof(Restaurant*), compares[order]);
+}
+
+/*
+ * Compares two restaurants by name, then by id.
+ *
+ * *first:  pointer to a pointer to the first restaurant.
+ * *second: pointer to a pointer to the second restaurant.
+ * return:  negative, zero or positive if first restaurant goes before, with or after.
+ */
+int compareByName(const void *first, const void *second) {
+  Restaurant *a = *(Restaurant**)first;
+  Restaurant *b = *(Restaurant**)second;
+  int diff = strcmp(a->name, b->name);
+
+  return diff != 0 ? diff : a->id - b->id;
+}
+
+/*
+ * Compares two restaurants by city, then by id. Cities are pooled handles, so equal cities 
+ * are recognized without comparing strings.
+ *
+ * *first:  pointer to a pointer to the first restaurant.
+ * *second: pointer to a pointer to the second restaurant.
+ * return:  negative, zero or positive if first restaurant goes before, with or after.
+ */
+int compareByCity(const void *first, const void *second) {
+  Restaurant *a = *(Restaurant**)first;
+  Restaurant *b = *(Restaurant**)second;
+  int diff = a->city == b->city ? 0 : strcmp(a->city, b->city);
+
+  return diff != 0 ? diff : a->id - b->id;
+}
+
+/*
+ * Compares two restaurants by rank and number of reviewers, both descending, then by id. 
+ * Agrees with the order of their rank keys.
+ *
+ * *first:  pointer to a pointer to the first restaurant.
+ * *second: pointer to a pointer to the second restaurant.
+ * return:  negative, zero or positive if first restaurant goes before, with or after.
  */
-void inOrder(BTNode *node, char *p) {
-  if (node->left != 0) { // If left child is not empty.
-    inOrder(node->left, p);
+int compareByRank(const void *first, const void *second) {
+  Restaurant *a = *(Restaurant**)first;
+  Restaurant *b = *(Restaurant**)second;
+
+  if (a->rank != b->rank) { // If ranks differ, greater one goes first.
+    return a->rank > b->rank ? -1 : 1;
+  }
+  if (a->reviewers != b->reviewers) { // If numbers differ, greater one goes first.
+    return a->reviewers > b->reviewers ? -1 : 1;
   }
-  
-  strcat(p, toStringArrayList(node->restaurants));
+  return a->id - b->id;
+}
 
-  if (node->right != 0) { // If right child is not empty.
-    inOrder(node->right, p);
+/*
+ * Compares two restaurants by number of reviewers and rank, both descending, then by id. 
+ * Agrees with the order of their reviewers keys.
+ *
+ * *first:  pointer to a pointer to the first restaurant.
+ * *second: pointer to a pointer to the second restaurant.
+ * return:  negative, zero or positive if first restaurant goes before, with or after.
+ */
+int compareByReviewers(const void *first, const void *second) {
+  Restaurant *a = *(Restaurant**)first;
+  Restaurant *b = *(Restaurant**)second;
+
+  if (a->reviewers != b->reviewers) { // If numbers differ, greater one goes first.
+    return a->reviewers > b->reviewers ? -1 : 1;
+  }
+  if (a->rank != b->rank) { // If ranks differ, greater one goes first.
+    return a->rank > b->rank ? -1 : 1;
   }
+  return a->id - b->id;
 }
 
 /*
- * Searches binary tree for a node that contains elements with mathing name. Calls recursive 
- * searchBTName().
+ * Compares two restaurants by cost level, ascending, then like compareByRank(). Agrees with 
+ * the order of their cost keys. Costs are pooled handles, so equal costs are recognized 
+ * without counting their levels.
  *
- * *bt:    pointer to a binary tree to search.
- * *name:  name to be searched for.
- * return: pointer to a found node, NULL otherwise.
+ * *first:  pointer to a pointer to the first restaurant.
+ * *second: pointer to a pointer to the second restaurant.
+ * return:  negative, zero or positive if first restaurant goes before, with or after.
  */
-BTNode *searchBTName(BinaryTree *bt, char *name) {
-  return searchBTNodeName(bt->root, name);
+int compareByCost(const void *first, const void *second) {
+  char *a = (*(Restaurant**)first)->cost;
+  char *b = (*(Restaurant**)second)->cost;
+  uint32_t levelA;
+  uint32_t levelB;
+
+  if (a == b) { // If costs are the same handle, levels are equal.
+    return compareByRank(first, second);
+  }
+  levelA = costBits(costLevel(a));
+  levelB = costBits(costLevel(b));
+  if (levelA != levelB) { // If cost levels differ, lower one goes first.
+    return levelA < levelB ? -1 : 1;
+  }
+  return compareByRank(first, second);
 }
 
 /*
- * Searches binary tree for a node that contains elements with mathing location. Calls 
- * recursive searchBTLoc().
+ * Builds an empty binary tree from restaurants sorted by its ordering rule. Runs of 
+ * restaurants with equal keys are grouped into nodes, which are then linked into a perfectly 
+ * balanced tree, or packed into B+ tree leaves, without comparing any keys. Written keys are 
+ * only copied once per node.
  *
- * *bt:    pointer to a binary tree to search.
- * *loc:   location to be searched for.
- * return: pointer to a found node, NULL otherwise.
+ * *bt:           pointer to an empty binary tree.
+ * **restaurants: array of pointers to sorted restaurants.
+ * count:         number of restaurants.
+ * **holders:     array indexed by restaurant id, set to the nodes holding the restaurants.
  */
-BTNode *searchBTLoc(BinaryTree *bt, char *loc) {
-  return searchBTNodeLoc(bt->root, loc);
+void buildBinaryTree(BinaryTree *bt, Restaurant **restaurants, int count, BTNode **holders) {
+  BTNode **nodes = (BTNode**)malloc((count + 1) * sizeof(BTNode*));
+  int num = 0;
+
+  char buffer[TREE_KEY_SIZE];
+
+  for (int i = 0; i < count; i++) { // Group restaurants with equal keys into nodes.
+    Restaurant *restaurant = restaurants[i];
+    char *key = writeTreeKey(bt->order, restaurant, buffer);
+
+    if (num > 0 && strcmp(nodes[num - 1]->name, key) == 0) { // If key equals previous one.
+      insert(nodes[num - 1]->restaurants, restaurant);
+    } else { // Key starts a new node.
+      nodes[num] = createBTNode(restaurant);
+      nodes[num]->name = key == buffer ? copyKey(key) : key;
+      num++;
+    }
+    holders[restaurant->id] = nodes[num - 1];
+  }
+
+  if (bt->backend == BPLUS) { // Pack nodes into B+ tree leaves.
+    buildBPlusTree(bt->bplus, nodes, num);
+  } else { // Link nodes into a balanced tree.
+    bt->root = buildBTNodes(nodes, 0, num - 1);
+  }
+  bt->size = count;
+
+  free(nodes);
 }
 
 /*
- * Recursively traverses binary tree searching for node that contains elements with matching
- * name. Chooses next node to examine based on the name.
+ * Builds a perfectly balanced binary tree from a range of sorted nodes. Middle node becomes 
+ * the root, and both halves are built into its subtrees, so heights of subtrees differ by at 
+ * most one.
  *
- * *node:  pointer to the root of binary tree.
- * *name:  name to be searched for.
- * return: pointer to a found node, NULL otherwise.
+ * **nodes: array of pointers to sorted nodes.
+ * first:   index of the first node in the range.
+ * last:    index of the last node in the range.
+ * return:  pointer to a root of the built tree.
  */
-BTNode *searchBTNodeName(BTNode *node, char *name) {
-  if (node != NULL) {
-    char *nodeName = getRestaurant(node->restaurants, 0)->name;
-    nodeName[strcspn(nodeName, "\r")] = 0;
-    int diff = strcmp(name, nodeName);
-  
-    if (diff == 0) { // If names match.
-      return node;
-    } else if (diff < 0) { // If name is less than that of node.
-      return searchBTNodeName(node->left, name);
-    } else { // Examine right node.
-      return searchBTNodeName(node->right, name);
+BTNode *buildBTNodes(BTNode **nodes, int first, int last) {
+  if (first > last) { // If range is empty.
+    return NULL;
+  }
+
+  int middle   = first + (last - first) / 2;
+  BTNode *node = nodes[middle];
+
+  node->left  = buildBTNodes(nodes, first, middle - 1);
+  node->right = buildBTNodes(nodes, middle + 1, last);
+  updateHeight(node);
+
+  return node;
+}
+
+/*
+ * Inserts an element in a node with a given key. Tree is descended once without recursion. If 
+ * node with the key exists, element is inserted in its array list. Otherwise, a new leaf is 
+ * linked where the descent ended, and passed nodes are rebalanced from the bottom up.
+ *
+ * *bt:         pointer to a binary tree to insert in.
+ * *key:        key of the element.
+ * *restaurant: pointer to a restaurant to insert.
+ * return:      pointer to the node holding the restaurant.
+ */
+BTNode *insertBTNode(BinaryTree *bt, char *key, Restaurant *restaurant) {
+  BTPath path;
+  BTNode **link = descendBT(&bt->root, key, &path);
+  BTNode *node;
+
+  if (*link != NULL) { // If node with the key exists.
+    insert((*link)->restaurants, restaurant);
+    return *link;
+  }
+
+  node = createBTNode(restaurant);
+  node->name = key;
+  *link = node;
+  rebalancePath(&path, 1);
+
+  return node;
+}
+
+/*
+ * Descends a binary tree towards a key without recursion. Link of every node passed on the 
+ * way is recorded in the path, so the tree can be changed and rebalanced afterwards without 
+ * descending again.
+ *
+ * **root: pointer to the link holding the root of binary tree.
+ * *key:   key to descend towards.
+ * *path:  path to record the links in.
+ * return: pointer to the link holding the node with the key, or the empty link where it 
+ *         belongs.
+ */
+BTNode **descendBT(BTNode **root, char *key, BTPath *path) {
+  BTNode **link = root;
+  int diff;
+
+  path->depth = 0;
+  while (*link != NULL && (diff = strcmp(key, (*link)->name)) != 0) { // Follow the key.
+    path->links[path->depth] = link;
+    path->depth++;
+    link = diff < 0 ? &(*link)->left : &(*link)->right;
+  }
+  return link;
+}
+
+/*
+ * Rebalances nodes along a recorded path, from the deepest one up to the root. Each link is 
+ * replaced with the root of its rebalanced subtree. After an insertion, nodes above a subtree 
+ * that kept its height are unaffected, so rebalancing may stop there.
+ *
+ * *path:     path recorded by a descent.
+ * stopEarly: 1 to stop once a subtree keeps its height, 0 to go up to the root.
+ */
+void rebalancePath(BTPath *path, int stopEarly) {
+  while (path->depth > 0) { // Go up the path.
+    BTNode **link;
+    int before;
+
+    path->depth--;
+    link   = path->links[path->depth];
+    before = (*link)->height;
+    *link  = rebalance(*link);
+
+    if (stopEarly && (*link)->height == before) { // If nodes above are unaffected.
+      break;
     }
   }
-  return NULL; 
 }
 
 /*
- * Recursively traverses binary tree searching for node that contains elements with matching
- * location. Chooses next node to examine based on the location.
+ * Gets height of a subtree. Empty subtree has height 0, a leaf has height 1.
  *
- * *node:  pointer to the root of binary tree.
- * *city:  city to be searched for.
- * return: pointer to a found node, NULL otherwise.
+ * *node:  pointer to a root of a subtree.
+ * return: height of a subtree, 0 if subtree is empty.
  */
-BTNode *searchBTNodeLoc(BTNode *node, char *city) {
-  if (node != NULL) {
-    char *nodeCity = getRestaurant(node->restaurants, 0)->city;
-    nodeCity[strcspn(nodeCity, "\r")] = 0;
-    int diff = strcmp(city, nodeCity);
-  
-    if (diff == 0) { // If locations match.
-      return node;
-    } else if (diff < 0) { // If location is less than that of node.
-      return searchBTNodeLoc(node->left, city);
-    } else { // Examine right node.
-      return searchBTNodeLoc(node->right, city);
+int getHeight(BTNode *node) {
+  if (node == NULL) { // If subtree is empty.
+    return 0;
+  }
+  return node->height;
+}
+
+/*
+ * Recalculates height of a node as one more than the height of its tallest child.
+ *
+ * *node: pointer to a node to update.
+ */
+void updateHeight(BTNode *node) {
+  int left  = getHeight(node->left);
+  int right = getHeight(node->right);
+
+  node->height = (left > right ? left : right) + 1;
+}
+
+/*
+ * Rotates subtree to the left. Right child becomes the root of a subtree, and its left 
+ * subtree becomes right subtree of the old root.
+ *
+ * *node:  pointer to a root of a subtree.
+ * return: pointer to a new root of a subtree.
+ */
+BTNode *rotateLeft(BTNode *node) {
+  BTNode *pivot = node->right;
+
+  node->right = pivot->left;
+  pivot->left = node;
+  updateHeight(node);
+  updateHeight(pivot);
+
+  return pivot;
+}
+
+/*
+ * Rotates subtree to the right. Left child becomes the root of a subtree, and its right 
+ * subtree becomes left subtree of the old root.
+ *
+ * *node:  pointer to a root of a subtree.
+ * return: pointer to a new root of a subtree.
+ */
+BTNode *rotateRight(BTNode *node) {
+  BTNode *pivot = node->left;
+
+  node->left   = pivot->right;
+  pivot->right = node;
+  updateHeight(node);
+  updateHeight(pivot);
+
+  return pivot;
+}
+
+/*
+ * Restores AVL balance of a subtree which children are balanced. If heights of children 
+ * differ by more than one, performs a single or a double rotation towards the shorter side.
+ *
+ * *node:  pointer to a root of a subtree.
+ * return: pointer to a new root of a subtree.
+ */
+BTNode *rebalance(BTNode *node) {
+  int balance;
+
+  updateHeight(node);
+  balance = getHeight(node->left) - getHeight(node->right);
+
+  if (balance > 1) { // If left subtree is too tall.
+    if (getHeight(node->left->left) < getHeight(node->left->right)) { // Left-right case.
+      node->left = rotateLeft(node->left);
     }
+    return rotateRight(node);
+  } else if (balance < -1) { // If right subtree is too tall.
+    if (getHeight(node->right->right) < getHeight(node->right->left)) { // Right-left case.
+      node->right = rotateRight(node->right);
+    }
+    return rotateLeft(node);
   }
-  return NULL; 
+  return node;
 }
 
 /*
- * Gets parent of a node located in a binaty tree with ordering rule by name. Compares if 
- * given subroot is a parent of the node and examines node deeper in the tree if neede.
+ * Visits nodes of a tree in order of their keys. Nodes are taken from an in-order iterator, 
+ * so traversal does not recurse for either backend.
  *
- * *sub:   pointer to a root of a subtree.
- * *node:  pointer to a node parent of which sould be found.
- * return: pointer to a found node, NULL otherwise.
+ * *bt:      pointer to a binary tree.
+ * visit:    function called with each node and the context.
+ * *context: context passed to the function.
+ */
+void traverseBinaryTree(BinaryTree *bt, BTVisitor visit, void *context) {
+  BTIterator iterator;
+  BTNode *node;
+
+  initBTIterator(&iterator, bt);
+  while ((node = nextBTNode(&iterator)) != NULL) { // Visit nodes until iterator runs out.
+    visit(node, context);
+  }
+}
+
+/*
+ * Positions an iterator before the first node of a tree. For binary tree, the chain of left 
+ * descendants of the root is pushed on the stack. For B+ tree, iterator starts at the first 
+ * leaf.
+ *
+ * *iterator: pointer to an iterator.
+ * *bt:       pointer to a binary tree to iterate over.
+ */
+void initBTIterator(BTIterator *iterator, BinaryTree *bt) {
+  iterator->backend = bt->backend;
+  iterator->depth   = 0;
+  iterator->leaf    = NULL;
+  iterator->index   = 0;
+
+  if (bt->backend == BPLUS) { // If tree is stored in a B+ tree.
+    iterator->leaf = firstLeaf(bt->bplus);
+  } else { // Start with the leftmost node.
+    pushLeftBT(iterator, bt->root);
+  }
+}
+
+/*
+ * Advances an iterator to the next node in order of the keys. Node on top of the stack is 
+ * the next one, and its right subtree is pushed before it is returned. B+ tree iterator takes 
+ * buckets of a leaf one by one and moves on to the next leaf.
+ *
+ * *iterator: pointer to an iterator.
+ * return:    pointer to the next node, NULL after the last one.
  */
-BTNode *getParentBTName(BTNode *sub, BTNode *node) {
-  char *nodeName = getRestaurant(node->restaurants, 0)->name;
-  char *subName  = getRestaurant(sub->restaurants,  0)->name;
-  int  diff      = strcmp(nodeName, subName);
+BTNode *nextBTNode(BTIterator *iterator) {
+  BTNode *node;
+
+  if (iterator->backend == BPLUS) { // If iterating over B+ tree leaves.
+    while (iterator->leaf != NULL && iterator->index == iterator->leaf->count) { // Next leaf.
+      iterator->leaf  = iterator->leaf->next;
+      iterator->index = 0;
+    }
+    if (iterator->leaf == NULL) { // If all leaves were visited.
+      return NULL;
+    }
+    iterator->index++;
+    return iterator->leaf->buckets[iterator->index - 1];
+  }
 
-  if (sub == NULL) { // If subroot is null.
+  if (iterator->depth == 0) { // If all nodes were visited.
     return NULL;
   }
+  iterator->depth--;
+  node = iterator->stack[iterator->depth];
+  pushLeftBT(iterator, node->right);
 
-  if (sub->left == node || sub->right == node) { // If node is either child of the subroot.
-     return sub;
+  return node;
+}
+
+/*
+ * Positions an iterator before the first node which key is not less than a given one. For 
+ * binary tree, nodes with such keys met on the way down are pushed, so the stack holds the 
+ * same nodes as if every lesser node had been visited. For B+ tree, iterator starts at the 
+ * first such slot of the leaf covering the key.
+ *
+ * *iterator: pointer to an iterator.
+ * *bt:       pointer to a binary tree to iterate over.
+ * *key:      lowest key to visit.
+ */
+void seekBTIterator(BTIterator *iterator, BinaryTree *bt, char *key) {
+  iterator->backend = bt->backend;
+  iterator->depth   = 0;
+  iterator->leaf    = NULL;
+  iterator->index   = 0;
+
+  if (bt->backend == BPLUS) { // If tree is stored in a B+ tree.
+    uint64_t prefix = keyPrefix(key);
+    BPNode *node = bt->bplus->root;
+
+    while (!node->leaf) { // Descend to a leaf.
+      node = node->children[findChild(node, prefix, key)];
+    }
+    iterator->leaf  = node;
+    iterator->index = findSlot(node, prefix, key);
+    return;
   }
 
-  if (diff < 0) { // If name is less than that of the subroot.
-    return getParentBTName(sub->left, node);
-  } else { // Examine right node.
-    return getParentBTName(sub->right, node);
+  for (BTNode *node = bt->root; node != NULL;) { // Descend towards the key.
+    if (strcmp(key, node->name) <= 0) { // If node is visited, its left subtree goes first.
+      iterator->stack[iterator->depth] = node;
+      iterator->depth++;
+      node = node->left;
+    } else { // Node and its left subtree are lesser.
+      node = node->right;
+    }
   }
 }
 
 /*
- * Gets parent of a node located in a binaty tree with ordering rule by location. Compares if
- * given subroot is a parent of the node and examines node deeper in the tree if neede.
+ * Collects restaurants of nodes which keys are within a range, in order of the keys. Scan 
+ * starts with a seek and stops at the first key past the range or once the limit is reached, 
+ * so it takes O(log n + k) for k collected restaurants.
  *
- * *sub:   pointer to a root of a subtree.
- * *node:  pointer to a node parent of which sould be found.
- * return: pointer to a found node, NULL otherwise.
+ * *bt:    pointer to a binary tree.
+ * *low:   lowest key, inclusive.
+ * *high:  key past the range, exclusive, NULL if range has no upper bound.
+ * limit:  most restaurants to collect, negative for no limit.
+ * return: pointer to an array list of collected restaurants.
  */
-BTNode *getParentBTLoc(BTNode *sub, BTNode *node) {
-  char *nodeCity = getRestaurant(node->restaurants, 0)->city;
-  char *subCity  = getRestaurant(sub->restaurants,  0)->city;
-  int  diff      = strcmp(nodeCity, subCity);
+ArrayList *rangeBinaryTree(BinaryTree *bt, char *low, char *high, int limit) {
+  ArrayList *result = createArrayList();
+  BTIterator iterator;
+  BTNode *node;
+
+  seekBTIterator(&iterator, bt, low);
+  while (limit != 0 && (node = nextBTNode(&iterator)) != NULL) { // Visit nodes in the range.
+    if (high != NULL && strcmp(node->name, high) >= 0) { // If node is past the range.
+      break;
+    }
+    for (int i = 0; i < getSize(node->restaurants) && limit != 0; i++) { // Collect bucket.
+      insert(result, getRestaurant(node->restaurants, i));
+      limit--;
+    }
+  }
+  return result;
+}
 
-  if (sub == NULL) { // If subroot is null.
-    return NULL;
+/*
+ * Collects restaurants which keys start with a prefix, in order of the keys. Range of such 
+ * keys ends at the prefix with its last byte that can grow increased.
+ *
+ * *bt:     pointer to a binary tree.
+ * *prefix: prefix of keys.
+ * limit:   most restaurants to collect, negative for no limit.
+ * return:  pointer to an array list of collected restaurants.
+ */
+ArrayList *prefixBinaryTree(BinaryTree *bt, char *prefix, int limit) {
+  int length = strlen(prefix);
+  char *high = (char*)malloc(length + 1);
+  ArrayList *result;
+
+  strcpy(high, prefix);
+  while (length > 0 && (unsigned char)high[length - 1] == 255) { // Drop bytes that can't grow.
+    length--;
   }
+  high[length] = 0;
+  if (length > 0) { // If prefix has a byte that can grow.
+    high[length - 1]++;
+  }
+
+  result = rangeBinaryTree(bt, prefix, length > 0 ? high : NULL, limit);
+  free(high);
+  return result;
+}
 
-  if (sub->left == node || sub->right == node) { // If node is either child of the subroot.
-     return sub;
+/*
+ * Pushes a node and its chain of left descendants on the stack of an iterator. Leftmost of 
+ * them ends up on top.
+ *
+ * *iterator: pointer to an iterator.
+ * *node:     pointer to a root of a subtree.
+ */
+void pushLeftBT(BTIterator *iterator, BTNode *node) {
+  while (node != NULL) { // Follow left children.
+    iterator->stack[iterator->depth] = node;
+    iterator->depth++;
+    node = node->left;
   }
+}
+
+/*
+ * Writes information about elements stored in a node to a file. Used as a visitor.
+ *
+ * *node: pointer to a node.
+ * *file: file to write to.
+ */
+void writeBTNode(BTNode *node, void *file) {
+  writeArrayList(node->restaurants, (FILE*)file);
+}
+
+/*
+ * Writes information about elements stored in a binary tree to a file. Records are streamed 
+ * to the file in order as the tree is traversed, so no string of the whole tree is built.
+ *
+ * *bt:   pointer to a binary tree.
+ * *file: file to write to.
+ */
+void writeBinaryTree(BinaryTree *bt, FILE *file) {
+  traverseBinaryTree(bt, writeBTNode, file);
+}
 
-  if (diff < 0) { // If location is less than that of the subroot.
-    return getParentBTLoc(sub->left, node);
-  } else { // Examine right node.
-    return getParentBTLoc(sub->right, node);
+/*
+ * Searches a tree for a node with a given key. Calls searchBTNode(), or searches B+ tree.
+ *
+ * *bt:    pointer to a binary tree to search.
+ * *key:   key to be searched for.
+ * return: pointer to a found node, NULL otherwise.
+ */
+BTNode *searchBinaryTree(BinaryTree *bt, char *key) {
+  if (bt->backend == BPLUS) { // If tree is stored in a B+ tree.
+    return searchBPlus(bt->bplus, key);
   }
+  return searchBTNode(bt->root, key);
 }
 
 /*
- * Removes an element from a binary tree that matches by name and location. Picks appropriate 
- * removal function based on the ordering rule.
+ * Searches binary tree for a node with a given key. Walks down from the root, choosing the 
+ * next node to examine based on the key.
  *
- * *bt:       pointer to a binary tree from which element must be removed.
- * *name:     name that elements must match.
- * *location: location that elemetns must match.
+ * *node:  pointer to the root of binary tree.
+ * *key:   key to be searched for.
+ * return: pointer to a found node, NULL otherwise.
  */
-void removeBT(BinaryTree *bt, char *name, char *location) {
-  if (bt->order == NAME) { // If ordering rule set to name.
-    removeBTName(bt, name, location);
-  } else if (bt->order == LOCATION) { // If ordering fule set to location.
-    removeBTLoc(bt, name, location);
-  } else { // Ordering rule is unknown.
-    printf("Unknown order rule: %d", bt->order);
+BTNode *searchBTNode(BTNode *node, char *key) {
+  while (node != NULL) { // Walk down until the key is found or subtree is empty.
+    int diff = strcmp(key, node->name);
+
+    if (diff == 0) { // If keys match.
+      return node;
+    }
+    node = diff < 0 ? node->left : node->right;
   }
+  return NULL; 
 }
 
 /*
- * Removes element from a binary tree that matches by name and location with an
- * ordering rule by name. Element is first removed from an array list. If node still contains 
- * elements, it is not removed. Otherwise, recursive node removal method is called.
+ * Removes an element from a binary tree that matches by name and location. Node is found by 
+ * the key of the ordering rule, and matching elements are removed from its array list. If 
+ * node still contains elements, it is not removed. Otherwise, binary tree node is unlinked 
+ * using the links recorded while finding it, so the tree is descended only once. B+ tree 
+ * bucket is removed by its key. Name and location are only keys of name and location trees, 
+ * so other trees are left to removeFromBTNode().
  *
- * *bt:       pointer to a binary tree from which elemetn must be removed.
+ * *bt:       pointer to a binary tree from which element must be removed.
  * *name:     name that elements must match.
- * *location: location that elements must match.
+ * *location: location that elemetns must match.
  */
-void removeBTName(BinaryTree *bt, char *name, char *location) {
-  BTNode *node   = searchBTName(bt, name);
-  BTNode *parent;
-  int result = 0;
+void removeBT(BinaryTree *bt, char *name, char *location) {
+  char *key = bt->order == NAME ? name : location;
+  BTNode **link = NULL;
+  BTNode *node;
+  BTPath path;
+  int before;
+
+  if (bt->backend == BPLUS) { // If tree is stored in a B+ tree.
+    node = searchBPlus(bt->bplus, key);
+  } else { // Descend binary tree, recording the path.
+    link = descendBT(&bt->root, key, &path);
+    node = *link;
+  }
 
-  if (node == NULL) { // If node with passed name was not found.
-    printf("no results for this name\n");
+  if (node == NULL) { // If node with passed key was not found.
+    printf(bt->order == NAME ? "no results for this name\n" : "no results for this location\n");
     return;
   }
 
-  parent = getParentBTName(bt->root, node);
-  
-  result = removeAL(node->restaurants, name, location, 1); 
-
-  if (result == -1) { // If element was not found in the array list.
+  before = getSize(node->restaurants);
+  if (removeAL(node->restaurants, name, location, 1) == -1) { // If element was not found.
     printf("restaurant not found\n");
     return;
   }
+  bt->size -= before - getSize(node->restaurants);
 
   if (getSize(node->restaurants) != 0) { // If array list still contains elements.
     return; 
   }
 
-  // free(node->restaurants);
-  removeBTNode(bt, parent, node);
-  // free(node);
+  if (bt->backend == BPLUS) { // Remove bucket from B+ tree.
+    removeBPlus(bt->bplus, node->name);
+  } else { // Unlink node from binary tree.
+    unlinkBTNode(link, &path);
+  }
 }
 
 /*
- * Removes element from a binary tree that matches by name and location with an
- * ordering rule by location. Element is first removed from an array list. If node still 
- * contains elements, it is not removed. Otherwise, recursive node removal method is called.
+ * Removes a restaurant from the node holding it, without searching the tree for the node. 
+ * Remaining elements keep their order. If node holds no elements afterwards, it is removed 
+ * by its key.
  *
- * *bt:       pointer to a binary tree from which elemetn must be removed.
- * *name:     name that elements must match.
- * *location: location that elements must match.
+ * *bt:         pointer to a binary tree from which element must be removed.
+ * *node:       pointer to the node holding the restaurant.
+ * *restaurant: pointer to a restaurant to remove.
  */
-void removeBTLoc(BinaryTree *bt, char *name, char *location) {
-  BTNode *node   = searchBTLoc(bt, location);
-  BTNode *parent;
-  int result = 0;
+void removeFromBTNode(BinaryTree *bt, BTNode *node, Restaurant *restaurant) {
+  ArrayList *list = node->restaurants;
+  int index = 0;
 
-  if (node == NULL) { //If node with passed city was not found.
-    printf("no results for this location\n");
+  while (index < list->size && list->restaurants[index] != restaurant) { // Find restaurant.
+    index++;
+  }
+  if (index == list->size) { // If node does not hold the restaurant.
     return;
   }
 
-  parent = getParentBTLoc(bt->root, node);
-  
-  result = removeAL(node->restaurants, name, location, 1); 
+  memmove(list->restaurants + index, list->restaurants + index + 1, 
+      (list->size - index - 1) * sizeof(Restaurant*));
+  list->size--;
+  list->restaurants[list->size] = NULL;
+  bt->size--;
 
-  if (result == -1) { // If element was not found in the array list.
-    printf("restaurant not found\n");
+  if (list->size != 0) { // If node still contains elements.
     return;
   }
 
-  if (getSize(node->restaurants) != 0) { // If array list still contains elements.
-    return; 
+  if (bt->backend == BPLUS) { // Remove bucket from B+ tree.
+    removeBPlus(bt->bplus, node->name);
+  } else { // Remove node from binary tree.
+    removeBTNode(bt, node->name);
   }
-
-  // free(node->restaurants);
-  removeBTNode(bt, parent, node);
-  // free(node);
 }
 
 /*
- * Recirsively removes node from a binary tree. Covers four cases, where node has 2 children, 
- * is a root wiht a single child, is a node with a single left child, or a node with a sigle 
- * right child or a leaf.
+ * Removes node with a given key from a binary tree. Tree is descended once without 
+ * recursion, and the node is unlinked using the recorded path.
  *
- * *bt:     pointer to a binary tree from which node must be removed.
- * *parent: pointer to a parent of node to be removed.
- * *node:   pointer to the node to be removed.
- * return:  -1 if node was equal to NULL, 0 upon successful execution.
+ * *bt:  pointer to a binary tree.
+ * *key: key of the node to be removed.
  */
-int removeBTNode(BinaryTree *bt, BTNode *parent, BTNode *node) {
-  if (node == NULL) { // If node to be removed is null.
-    return -1;
-  }
+void removeBTNode(BinaryTree *bt, char *key) {
+  BTPath path;
+  BTNode **link = descendBT(&bt->root, key, &path);
 
-  if (node->left != NULL && node->right != NULL) { // Case 1: If node has two children.
-    BTNode *succNode = node->right;
-    BTNode *succParent = node;
+  if (*link != NULL) { // If node with the key was found.
+    unlinkBTNode(link, &path);
+  }
+}
 
-    while (succNode->left != NULL) { // Iterate through successor's children to pick a node.
-      succParent = succNode;
-      succNode = succNode->left;
+/*
+ * Removes node held by a link reached by a descent. If node has two children, it is replaced 
+ * by its in-order successor, which is detached from the right subtree, and links followed to 
+ * the successor are added to the path. Otherwise, node is replaced by its only child or 
+ * removed as a leaf. Nodes that stay in the tree are never moved or copied, so pointers to 
+ * them remain valid. Every node on the path is rebalanced from the bottom up.
+ *
+ * **link: pointer to the link holding the node.
+ * *path:  path recorded by the descent.
+ */
+void unlinkBTNode(BTNode **link, BTPath *path) {
+  BTNode *node = *link;
+
+  if (node->left != NULL && node->right != NULL) { // If node has two children.
+    int slot = path->depth;
+    BTNode **succLink = &node->right;
+    BTNode *succNode;
+
+    path->links[path->depth] = link;
+    path->depth++;
+    while ((*succLink)->left != NULL) { // Find the leftmost node of the right subtree.
+      path->links[path->depth] = succLink;
+      path->depth++;
+      succLink = &(*succLink)->left;
     }
 
-    node->restaurants = duplicateAL(succNode->restaurants);
-    removeBTNode(bt, succParent, succNode);
-  } else if (node == bt->root) { // Case 2: If node is a root with a single child.
-    if (node->left != NULL) { // If root has only left child.
-      bt->root = node->left;
-    } else { // Root only has right child.
-      bt->root = node->right;
-    }
-  } else if (node->left != NULL) { // Case 3: Node has a single left child.
-    if (parent->left == node) { // If node is its parents left child.
-      parent->left = node->left;
-    } else { // Node is its parents right child.
-      parent->right = node->left;
-    }
-  } else { // Case 4: Node has a single right child or is a leaf.
-    if (parent->left == node) { // Node is its parent's left child.
-      parent->left = node->right;
-    } else { // Node is its parent's right child.
-      parent->right = node->right;
+    succNode  = *succLink;
+    *succLink = succNode->right;
+    succNode->left  = node->left;
+    succNode->right = node->right;
+    *link = succNode;
+
+    if (path->depth > slot + 1) { // If path went through the right child of removed node.
+      path->links[slot + 1] = &succNode->right;
     }
+  } else { // Node has a single child or is a leaf.
+    *link = node->left != NULL ? node->left : node->right;
   }
-  return 0;
-}
 
+  deallocate(node->restaurants->restaurants);
+  deallocate(node->restaurants);
+  deallocate(node);
+
+  rebalancePath(path, 0);
+}
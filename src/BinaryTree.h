@@ -6,39 +6,71 @@
  * ------------------
  * Implements binary tree data structure to store array lists of restaurants grouped into
  * nodes depending on the ordering rule. Functionality includes creating, insertind in, 
- * removing from, and creting string of information stored in a binary tree.
+ * removing from, and writing information stored in a binary tree. Tree is kept 
+ * AVL-balanced on insertion and removal, so its height stays logarithmic for any order of 
+ * insertion. Alternatively, the same buckets can be stored in a B+ tree.
  * 
  * author: Max Turkot
  * version: 12/11/21
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "ArrayList.h"
+#include "BPlusTree.h"
+
+#define TREE_KEY_SIZE 19 // Bytes of a written numeric key with its terminator.
+#define TREE_ORDERS   5  // Number of tree ordering rules.
 
 typedef enum { // Define categories of tree ordering rule.
-  NAME, LOCATION
+  NAME, LOCATION, RANK, REVIEWERS, COST
 } TreeOrder;
 
+typedef enum { // Define data structures that can store the tree.
+  AVL, BPLUS
+} TreeBackend;
+
 typedef struct BTNode{ // Define binary tree node to hold pointer to array list of elements.
   struct BTNode *left;
   struct BTNode *right;
   char *name;
+  int height;
   ArrayList *restaurants;
 } BTNode;
 
+typedef void (*BTVisitor)(BTNode*, void*); // Define function called for nodes in traversal.
+
+#define BT_MAX_HEIGHT 64 // Bound on height of an AVL tree, reached only past 2^44 nodes.
+
+typedef struct { // Define links followed from the root while descending a binary tree.
+  BTNode **links[BT_MAX_HEIGHT];
+  int depth;
+} BTPath;
+
+typedef struct { // Define in-order iterator over nodes of a tree.
+  TreeBackend backend;
+  BTNode *stack[BT_MAX_HEIGHT]; // Nodes whose left subtrees are being visited.
+  int depth;
+  BPNode *leaf;                 // Current leaf of B+ tree.
+  int index;
+} BTIterator;
+
 typedef struct { // Define binary tree element.
   BTNode *root;
+  BPlusTree *bplus;
   TreeOrder order;
+  TreeBackend backend;
   int size;
 } BinaryTree;
 
 /*
  * Initialyzes binary tree.
  *
- * TreeOrder: tree ordering rule (NAME or LOCATION).
- * return:    pointer to a created binary tree.
+ * TreeOrder:   tree ordering rule.
+ * TreeBackend: data structure storing the tree (AVL or BPLUS).
+ * return:      pointer to a created binary tree.
  */
-extern BinaryTree *createBinaryTree(TreeOrder);
+extern BinaryTree *createBinaryTree(TreeOrder, TreeBackend);
 
 /*
  * Creates a bt node to hold pointer to an array list of restaurants.
@@ -53,96 +85,309 @@ extern BTNode *createBTNode(Restaurant*);
  *
  * BinaryTree*: pointer to a binery tree to insert in.
  * Resturant*:  pointer to a restaurant to insert.
+ * return:      pointer to the node holding the restaurant.
  */
-extern void insertInBinaryTree(BinaryTree*, Restaurant*);
+extern BTNode *insertInBinaryTree(BinaryTree*, Restaurant*);
 
 /*
- * Inserts an element in a binary tree ordered by name.
+ * Copies a written key.
  *
- * BTNode*      pointer to a root of binary tree.
- * Restaurant*: pointer to a restaurant to insert.
+ * char*:  key to copy.
+ * return: copy of the key.
  */
-extern void insertNodeName(BTNode*, Restaurant*);
+extern char *copyKey(char*);
 
 /*
- * Inserts an element in a binary tree ordered by location.
+ * Gets key of a restaurant under an ordering rule.
  *
- * BTNode*      pointer to a root of binary tree.
- * Restaurant*: pointer to a restaurant to insert.
+ * TreeOrder:   ordering rule.
+ * Restaurant*: pointer to a restaurant.
+ * char*:       buffer with room for TREE_KEY_SIZE bytes.
+ * return:      key of the restaurant, the buffer if key was written to it.
  */
-extern void insertNodeCity(BTNode*, Restaurant*);
+extern char *writeTreeKey(TreeOrder, Restaurant*, char*);
 
 /*
- * Creates a string with information about elements stored.
+ * Writes key of a rank and a number of reviewers, which orders best restaurants first.
  *
- * BinaryTree*: pointer to a binary tree.
- * return:      string with information about elements stored in the binary tree.
+ * float: rank.
+ * int:   number of reviewers.
+ * char*: buffer with room for 17 bytes.
  */
-extern char *toStringBinaryTree(BinaryTree*);
+extern void writeRankKey(float, int, char*);
 
 /*
- * Traverses binary tree and appends node information to a string.
- * 
- * BTNode*: pointer to a root of binary tree.
- * char*:   string to append information to.
+ * Turns a rank into bits that compare like it in reverse.
+ *
+ * float:  rank.
+ * return: bits of the rank.
  */
-extern void inOrder(BTNode*, char*);
+extern uint32_t rankBits(float);
 
 /*
- * Recursively searches binary tree for a node that contains elements with mathing name.
+ * Turns a number of reviewers into bits that compare like it in reverse.
  *
- * BinaryTree*: pointer to a binary tree to search.
- * char*:       name to be searched for.
- * return:      pointer to a found node, NULL otherwise.
+ * int:    number of reviewers.
+ * return: bits of the number.
  */
-extern BTNode *searchBTName(BinaryTree*, char*);
+extern uint32_t reviewersBits(int);
 
 /*
- * Recursively searches binary tree for a node that contains elements with mathing location.
+ * Turns a cost level into bits that compare like it.
  *
- * BinaryTree*: pointer to a binary tree to search.
- * char*:       location to be searched for.
- * return:      pointer to a found node, NULL otherwise.
+ * int:    cost level.
+ * return: bits of the level.
  */
-extern BTNode *searchBTLoc(BinaryTree*, char*);
+extern uint32_t costBits(int);
 
 /*
- * Recursively traverses binary tree searching for node that contains elements with matching 
- * name.
+ * Writes lowest hex digits of bits.
  *
- * BTNode*: pointer to the root of binary tree.
- * char*:   name to be searched for.
- * return:  pointer to a found node, NULL otherwise.
+ * uint64_t: bits to write.
+ * int:      number of digits.
+ * char*:    buffer with room for the digits and a terminator.
  */
-extern BTNode *searchBTNodeName(BTNode*, char*);
+extern void writeHexKey(uint64_t, int, char*);
 
 /*
- * Recursively traverses binary tree searching for node that contains elements with matching 
- * location.
+ * Sorts restaurants by the key of an ordering rule, keeping restaurants with equal keys in 
+ * order of their ids.
  *
- * BTNode*: pointer to the root of binary tree.
- * char*:   location to be searched for.
- * return:  pointer to a found node, NULL otherwise.
+ * Restaurant**: array of pointers to restaurants.
+ * int:          number of restaurants.
+ * TreeOrder:    ordering rule giving the key.
  */
-extern BTNode *searchBTNodeLoc(BTNode*, char*);
+extern void sortRestaurants(Restaurant**, int, TreeOrder);
 
 /*
- * Gets parent of a node located in a binaty tree with ordering rule by name.
- * 
+ * Compares two restaurants by name, then by id.
+ *
+ * const void*: pointer to a pointer to the first restaurant.
+ * const void*: pointer to a pointer to the second restaurant.
+ * return:      negative, zero or positive if first restaurant goes before, with or after.
+ */
+extern int compareByName(const void*, const void*);
+
+/*
+ * Compares two restaurants by city, then by id.
+ *
+ * const void*: pointer to a pointer to the first restaurant.
+ * const void*: pointer to a pointer to the second restaurant.
+ * return:      negative, zero or positive if first restaurant goes before, with or after.
+ */
+extern int compareByCity(const void*, const void*);
+
+/*
+ * Compares two restaurants by rank and number of reviewers, both descending, then by id.
+ *
+ * const void*: pointer to a pointer to the first restaurant.
+ * const void*: pointer to a pointer to the second restaurant.
+ * return:      negative, zero or positive if first restaurant goes before, with or after.
+ */
+extern int compareByRank(const void*, const void*);
+
+/*
+ * Compares two restaurants by number of reviewers and rank, both descending, then by id.
+ *
+ * const void*: pointer to a pointer to the first restaurant.
+ * const void*: pointer to a pointer to the second restaurant.
+ * return:      negative, zero or positive if first restaurant goes before, with or after.
+ */
+extern int compareByReviewers(const void*, const void*);
+
+/*
+ * Compares two restaurants by cost level, ascending, then by rank and number of reviewers.
+ *
+ * const void*: pointer to a pointer to the first restaurant.
+ * const void*: pointer to a pointer to the second restaurant.
+ * return:      negative, zero or positive if first restaurant goes before, with or after.
+ */
+extern int compareByCost(const void*, const void*);
+
+/*
+ * Builds an empty binary tree from restaurants sorted by its ordering rule.
+ *
+ * BinaryTree*:  pointer to an empty binary tree.
+ * Restaurant**: array of pointers to sorted restaurants.
+ * int:          number of restaurants.
+ * BTNode**:     array indexed by restaurant id, set to the nodes holding the restaurants.
+ */
+extern void buildBinaryTree(BinaryTree*, Restaurant**, int, BTNode**);
+
+/*
+ * Builds a perfectly balanced binary tree from a range of sorted nodes.
+ *
+ * BTNode**: array of pointers to sorted nodes.
+ * int:      index of the first node in the range.
+ * int:      index of the last node in the range.
+ * return:   pointer to a root of the built tree.
+ */
+extern BTNode *buildBTNodes(BTNode**, int, int);
+
+/*
+ * Inserts an element in a node with a given key and rebalances the tree.
+ *
+ * BinaryTree*: pointer to a binary tree to insert in.
+ * char*:       key of the element.
+ * Restaurant*: pointer to a restaurant to insert.
+ * return:      pointer to the node holding the restaurant.
+ */
+extern BTNode *insertBTNode(BinaryTree*, char*, Restaurant*);
+
+/*
+ * Descends a binary tree towards a key, recording links of passed nodes.
+ *
+ * BTNode**: pointer to the link holding the root of binary tree.
+ * char*:    key to descend towards.
+ * BTPath*:  path to record the links in.
+ * return:   pointer to the link holding the node with the key, or the empty link where it 
+ *           belongs.
+ */
+extern BTNode **descendBT(BTNode**, char*, BTPath*);
+
+/*
+ * Rebalances nodes along a recorded path from the bottom up.
+ *
+ * BTPath*: path recorded by a descent.
+ * int:     1 to stop once a subtree keeps its height, 0 to go up to the root.
+ */
+extern void rebalancePath(BTPath*, int);
+
+/*
+ * Gets height of a subtree.
+ *
  * BTNode*: pointer to a root of a subtree.
- * BTNode*: pointer to a node parent of which sould be found.
- * return:  pointer to a found node, NULL otherwise.
+ * return:  height of a subtree, 0 if subtree is empty.
  */
-extern BTNode *getParentBTName(BTNode*, BTNode*);
+extern int getHeight(BTNode*);
 
 /*
- * Gets parent of a node located in a binaty tree with ordering rule by location.
- * 
+ * Recalculates height of a node from heights of its children.
+ *
+ * BTNode*: pointer to a node to update.
+ */
+extern void updateHeight(BTNode*);
+
+/*
+ * Rotates subtree to the left.
+ *
  * BTNode*: pointer to a root of a subtree.
- * BTNode*: pointer to a node parent of which sould be found.
+ * return:  pointer to a new root of a subtree.
+ */
+extern BTNode *rotateLeft(BTNode*);
+
+/*
+ * Rotates subtree to the right.
+ *
+ * BTNode*: pointer to a root of a subtree.
+ * return:  pointer to a new root of a subtree.
+ */
+extern BTNode *rotateRight(BTNode*);
+
+/*
+ * Restores AVL balance of a subtree which children are balanced.
+ *
+ * BTNode*: pointer to a root of a subtree.
+ * return:  pointer to a new root of a subtree.
+ */
+extern BTNode *rebalance(BTNode*);
+
+/*
+ * Visits nodes of a tree in order of their keys.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * BTVisitor:   function called with each node and the context.
+ * void*:       context passed to the function.
+ */
+extern void traverseBinaryTree(BinaryTree*, BTVisitor, void*);
+
+/*
+ * Positions an iterator before the first node of a tree.
+ *
+ * BTIterator*: pointer to an iterator.
+ * BinaryTree*: pointer to a binary tree to iterate over.
+ */
+extern void initBTIterator(BTIterator*, BinaryTree*);
+
+/*
+ * Advances an iterator to the next node in order of the keys.
+ *
+ * BTIterator*: pointer to an iterator.
+ * return:      pointer to the next node, NULL after the last one.
+ */
+extern BTNode *nextBTNode(BTIterator*);
+
+/*
+ * Pushes a node and its chain of left descendants on the stack of an iterator.
+ *
+ * BTIterator*: pointer to an iterator.
+ * BTNode*:     pointer to a root of a subtree.
+ */
+extern void pushLeftBT(BTIterator*, BTNode*);
+
+/*
+ * Positions an iterator before the first node which key is not less than a given one.
+ *
+ * BTIterator*: pointer to an iterator.
+ * BinaryTree*: pointer to a binary tree to iterate over.
+ * char*:       lowest key to visit.
+ */
+extern void seekBTIterator(BTIterator*, BinaryTree*, char*);
+
+/*
+ * Collects restaurants of nodes which keys are within a range, in order of the keys.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * char*:       lowest key, inclusive.
+ * char*:       key past the range, exclusive, NULL if range has no upper bound.
+ * int:         most restaurants to collect, negative for no limit.
+ * return:      pointer to an array list of collected restaurants.
+ */
+extern ArrayList *rangeBinaryTree(BinaryTree*, char*, char*, int);
+
+/*
+ * Collects restaurants which keys start with a prefix, in order of the keys.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * char*:       prefix of keys.
+ * int:         most restaurants to collect, negative for no limit.
+ * return:      pointer to an array list of collected restaurants.
+ */
+extern ArrayList *prefixBinaryTree(BinaryTree*, char*, int);
+
+/*
+ * Writes information about elements stored in a node to a file.
+ *
+ * BTNode*: pointer to a node.
+ * void*:   file to write to.
+ */
+extern void writeBTNode(BTNode*, void*);
+
+/*
+ * Writes information about elements stored in a binary tree to a file.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * FILE*:       file to write to.
+ */
+extern void writeBinaryTree(BinaryTree*, FILE*);
+
+/*
+ * Searches binary tree for a node with a given key.
+ *
+ * BTNode*: pointer to the root of binary tree.
+ * char*:   key to be searched for.
  * return:  pointer to a found node, NULL otherwise.
  */
-extern BTNode *getParentBTLoc(BTNode*, BTNode*);
+extern BTNode *searchBTNode(BTNode*, char*);
+
+/*
+ * Searches a tree for a node with a given key.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * char*:       key to search for.
+ * return:      pointer to a node with the key, NULL if there is none.
+ */
+extern BTNode *searchBinaryTree(BinaryTree*, char*);
 
 /*
  * Removes an element from a binary tree that matches by name and location.
@@ -154,33 +399,28 @@ extern BTNode *getParentBTLoc(BTNode*, BTNode*);
 extern void removeBT(BinaryTree*, char*, char*);
 
 /*
- * Removes element from a binary tree that matches by name and location with an 
- * ordering rule by name. If node still contains elements, it is not removed.
+ * Removes a restaurant from the node holding it. Node is removed once it holds no elements.
  *
- * BinaryTree*: pointer to a binary tree from which elemetn must be removed.
- * char*:       name that elements must match.
- * char*:       location that elements must match.
+ * BinaryTree*: pointer to a binary tree from which element must be removed.
+ * BTNode*:     pointer to the node holding the restaurant.
+ * Restaurant*: pointer to a restaurant to remove.
  */
-extern void removeBTName(BinaryTree*, char*, char*);
+extern void removeFromBTNode(BinaryTree*, BTNode*, Restaurant*);
 
 /*
- * Removes element from a binary tree that matches by name and location with an 
- * ordering rule by location. If node still contains elements, it is not removed.
- *
- * BinaryTree*: pointer to a binary tree from which elemetn must be removed.
- * char*:       name that elements must match.
- * char*:       location that elements must match.
+ * Removes node with a given key from a binary tree and rebalances the tree.
+ * 
+ * BinaryTree*: pointer to a binary tree.
+ * char*:       key of the node to be removed.
  */
-extern void removeBTLoc(BinaryTree*, char*, char*);
+extern void removeBTNode(BinaryTree*, char*);
 
 /*
- * Recirsively removes node from a binary tree.
- * 
- * BinaryTree*: pointer to a binary tree from which node must be removed.
- * BTNode*:     pointer to a parent of node to be removed.
- * BTNode*:     pointer to the node to be removed.
- * return:      -1 if node was equal to NULL, 0 upon successful execution.
+ * Removes node held by a link reached by a descent and rebalances the tree.
+ *
+ * BTNode**: pointer to the link holding the node.
+ * BTPath*:  path recorded by the descent.
  */
-extern int removeBTNode(BinaryTree*, BTNode*, BTNode*);
+extern void unlinkBTNode(BTNode**, BTPath*);
 
 #endif
@@ -0,0 +1,651 @@
+/*
+ * file: Bitmap.c
+ * --------------
+ * Implements compressed bitmap of restaurant ids. Ids are split by their upper 16 bits into
+ * containers. A container holds its lower 16 bits in a sorted array while it is sparse, and
+ * in a bitset once it is dense. Functionality includes creating, adding to, testing, listing,
+ * and combining bitmaps with AND, OR and ANDNOT.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Bitmap.h"
+
+/*
+ * Initialyzes an empty bitmap with room for 4 containers.
+ *
+ * return: pointer to a created bitmap.
+ */
+Bitmap *createBitmap() {
+  Bitmap *bitmap = (Bitmap*)malloc(sizeof(Bitmap));
+  bitmap->space      = 4;
+  bitmap->size       = 0;
+  bitmap->containers = (BitmapContainer*)malloc(bitmap->space * sizeof(BitmapContainer));
+
+  return bitmap;
+}
+
+/*
+ * Frees a bitmap and its containers.
+ *
+ * *bitmap: pointer to a bitmap.
+ */
+void freeBitmap(Bitmap *bitmap) {
+  for (int i = 0; i < bitmap->size; i++) { // Free values of every container.
+    free(bitmap->containers[i].values);
+    free(bitmap->containers[i].words);
+  }
+  free(bitmap->containers);
+  free(bitmap);
+}
+
+/*
+ * Adds an id to a bitmap. Container of the id is created if the bitmap has none. Ids added in
+ * increasing order are appended to the last container without a search.
+ *
+ * *bitmap: pointer to a bitmap.
+ * id:      id to add.
+ */
+void addToBitmap(Bitmap *bitmap, int id) {
+  uint16_t key = (uint16_t)(id >> 16);
+  int i = bitmap->size - 1;
+
+  if (i < 0 || bitmap->containers[i].key != key) { // If id is not in the last container.
+    i = findContainer(bitmap, key);
+    if (i == bitmap->size || bitmap->containers[i].key != key) { // If container is missing.
+      BitmapContainer empty = {key, 0, NULL, NULL, 0};
+
+      appendContainer(bitmap, &empty);
+      memmove(&bitmap->containers[i + 1], &bitmap->containers[i],
+          (bitmap->size - 1 - i) * sizeof(BitmapContainer));
+      bitmap->containers[i] = empty;
+    }
+  }
+  addToContainer(&bitmap->containers[i], (uint16_t)id);
+}
+
+/*
+ * Removes an id from a bitmap. Container left empty is dropped.
+ *
+ * *bitmap: pointer to a bitmap.
+ * id:      id to remove.
+ */
+void removeFromBitmap(Bitmap *bitmap, int id) {
+  uint16_t key = (uint16_t)(id >> 16);
+  int i = findContainer(bitmap, key);
+  BitmapContainer *c = &bitmap->containers[i];
+
+  if (i == bitmap->size || c->key != key) { // If container is missing.
+    return;
+  }
+  removeFromContainer(c, (uint16_t)id);
+  if (c->cardinality == 0) { // If container is empty, drop it.
+    free(c->values);
+    free(c->words);
+    memmove(c, c + 1, (bitmap->size - 1 - i) * sizeof(BitmapContainer));
+    bitmap->size--;
+  }
+}
+
+/*
+ * Checks whether a bitmap holds an id.
+ *
+ * *bitmap: pointer to a bitmap.
+ * id:      id to check.
+ * return:  1 if bitmap holds the id, 0 otherwise.
+ */
+int containsBitmap(Bitmap *bitmap, int id) {
+  uint16_t key = (uint16_t)(id >> 16);
+  int i = findContainer(bitmap, key);
+
+  if (i == bitmap->size || bitmap->containers[i].key != key) { // If container is missing.
+    return 0;
+  }
+  return containerHolds(&bitmap->containers[i], (uint16_t)id);
+}
+
+/*
+ * Counts ids in a bitmap by adding up cardinalities of its containers.
+ *
+ * *bitmap: pointer to a bitmap.
+ * return:  number of ids.
+ */
+int bitmapCardinality(Bitmap *bitmap) {
+  int count = 0;
+
+  for (int i = 0; i < bitmap->size; i++) { // Add up every container.
+    count += bitmap->containers[i].cardinality;
+  }
+  return count;
+}
+
+/*
+ * Writes ids of a bitmap to an array in increasing order. Bitset containers are read a word
+ * at a time, skipping to the next set bit.
+ *
+ * *bitmap: pointer to a bitmap.
+ * *ids:    array with room for all ids.
+ * return:  number of written ids.
+ */
+int extractBitmap(Bitmap *bitmap, int *ids) {
+  int count = 0;
+
+  for (int i = 0; i < bitmap->size; i++) { // Iterate containers in order of keys.
+    BitmapContainer *c = &bitmap->containers[i];
+    int high = (int)c->key << 16;
+
+    if (c->words == NULL) { // If container is an array.
+      for (int j = 0; j < c->cardinality; j++) { // Write every value.
+        ids[count++] = high | c->values[j];
+      }
+      continue;
+    }
+    for (int w = 0; w < BITMAP_WORDS; w++) { // Write set bits of every word.
+      uint64_t word = c->words[w];
+
+      while (word != 0) { // Take lowest set bit until none is left.
+        ids[count++] = high | (w << 6) | __builtin_ctzll(word);
+        word &= word - 1;
+      }
+    }
+  }
+  return count;
+}
+
+/*
+ * Appends a container of selection words to a bitmap, taking over the words. Words without
+ * any set bit are freed, and words with few set bits are turned into an array container.
+ *
+ * *bitmap: pointer to a bitmap.
+ * key:     key greater than keys of all containers.
+ * *words:  BITMAP_WORDS words, bit i of word w standing for lower bits 64 * w + i.
+ */
+void appendWords(Bitmap *bitmap, uint16_t key, uint64_t *words) {
+  BitmapContainer c = {key, 0, NULL, words, 0};
+
+  for (int w = 0; w < BITMAP_WORDS; w++) { // Count set bits of every word.
+    c.cardinality += __builtin_popcountll(words[w]);
+  }
+  if (c.cardinality == 0) { // If no id is selected.
+    free(words);
+    return;
+  }
+  shrinkContainer(&c);
+  appendContainer(bitmap, &c);
+}
+
+/*
+ * Intersects two containers with the same key. Arrays are walked side by side, an array and
+ * a bitset test the array against the bits, and two bitsets are combined word by word.
+ *
+ * *a:     pointer to the first container.
+ * *b:     pointer to the second container.
+ * return: container with values held by both, possibly empty.
+ */
+BitmapContainer andContainers(BitmapContainer *a, BitmapContainer *b) {
+  BitmapContainer result = {a->key, 0, NULL, NULL, 0};
+
+  if (a->words != NULL && b->words != NULL) { // If both containers are bitsets.
+    result.words = (uint64_t*)malloc(BITMAP_WORDS * sizeof(uint64_t));
+    for (int w = 0; w < BITMAP_WORDS; w++) { // Combine every word.
+      result.words[w] = a->words[w] & b->words[w];
+      result.cardinality += __builtin_popcountll(result.words[w]);
+    }
+    shrinkContainer(&result);
+    return result;
+  }
+
+  if (a->words != NULL) { // If only the first container is a bitset, test the second one.
+    BitmapContainer *swap = a;
+    a = b;
+    b = swap;
+  }
+  result.space  = a->cardinality > 0 ? a->cardinality : 1;
+  result.values = (uint16_t*)malloc(result.space * sizeof(uint16_t));
+  if (b->words != NULL) { // If array is tested against a bitset.
+    for (int i = 0; i < a->cardinality; i++) { // Keep values with their bit set.
+      if (containerHolds(b, a->values[i])) { // If bitset holds the value.
+        result.values[result.cardinality++] = a->values[i];
+      }
+    }
+    return result;
+  }
+  for (int i = 0, j = 0; i < a->cardinality && j < b->cardinality;) { // Walk both arrays.
+    if (a->values[i] == b->values[j]) { // If both hold the value.
+      result.values[result.cardinality++] = a->values[i];
+      i++;
+      j++;
+    } else if (a->values[i] < b->values[j]) { // If first array is behind.
+      i++;
+    } else { // Second array is behind.
+      j++;
+    }
+  }
+  return result;
+}
+
+/*
+ * Unites two containers with the same key. Arrays are merged while the result is sparse,
+ * otherwise values are set in a copy of a bitset.
+ *
+ * *a:     pointer to the first container.
+ * *b:     pointer to the second container.
+ * return: container with values held by either.
+ */
+BitmapContainer orContainers(BitmapContainer *a, BitmapContainer *b) {
+  BitmapContainer result;
+
+  if (a->words == NULL && b->words == NULL
+      && a->cardinality + b->cardinality <= BITMAP_ARRAY_MAX) { // If result is sparse.
+    int i = 0;
+    int j = 0;
+
+    result.key         = a->key;
+    result.cardinality = 0;
+    result.words       = NULL;
+    result.space       = a->cardinality + b->cardinality;
+    result.values      = (uint16_t*)malloc((result.space > 0 ? result.space : 1)
+        * sizeof(uint16_t));
+    while (i < a->cardinality || j < b->cardinality) { // Walk both arrays.
+      if (j == b->cardinality || (i < a->cardinality && a->values[i] < b->values[j])) {
+        result.values[result.cardinality++] = a->values[i++];
+      } else if (i == a->cardinality || b->values[j] < a->values[i]) { // If second is behind.
+        result.values[result.cardinality++] = b->values[j++];
+      } else { // Both hold the value.
+        result.values[result.cardinality++] = a->values[i++];
+        j++;
+      }
+    }
+    return result;
+  }
+
+  if (a->words == NULL) { // If first container is an array, copy the second one.
+    BitmapContainer *swap = a;
+    a = b;
+    b = swap;
+  }
+  result = copyContainer(a);
+  toBitset(&result);
+  if (b->words != NULL) { // If both containers are bitsets.
+    result.cardinality = 0;
+    for (int w = 0; w < BITMAP_WORDS; w++) { // Combine every word.
+      result.words[w] |= b->words[w];
+      result.cardinality += __builtin_popcountll(result.words[w]);
+    }
+    return result;
+  }
+  for (int i = 0; i < b->cardinality; i++) { // Set bit of every array value.
+    addToContainer(&result, b->values[i]);
+  }
+  return result;
+}
+
+/*
+ * Subtracts a container from another one with the same key. Array values are kept if the
+ * other container does not hold them, and bitsets clear bits of the other container.
+ *
+ * *a:     pointer to the container to subtract from.
+ * *b:     pointer to the container to subtract.
+ * return: container with values held by the first container only, possibly empty.
+ */
+BitmapContainer andNotContainers(BitmapContainer *a, BitmapContainer *b) {
+  BitmapContainer result;
+
+  if (a->words == NULL) { // If first container is an array.
+    result.key         = a->key;
+    result.cardinality = 0;
+    result.words       = NULL;
+    result.space       = a->cardinality > 0 ? a->cardinality : 1;
+    result.values      = (uint16_t*)malloc(result.space * sizeof(uint16_t));
+    for (int i = 0; i < a->cardinality; i++) { // Keep values missing from the second one.
+      if (!containerHolds(b, a->values[i])) { // If value is not subtracted.
+        result.values[result.cardinality++] = a->values[i];
+      }
+    }
+    return result;
+  }
+
+  result = copyContainer(a);
+  if (b->words != NULL) { // If both containers are bitsets.
+    result.cardinality = 0;
+    for (int w = 0; w < BITMAP_WORDS; w++) { // Combine every word.
+      result.words[w] &= ~b->words[w];
+      result.cardinality += __builtin_popcountll(result.words[w]);
+    }
+  } else { // Clear bit of every array value.
+    for (int i = 0; i < b->cardinality; i++) { // Iterate array values.
+      uint64_t bit = (uint64_t)1 << (b->values[i] & 63);
+
+      if (result.words[b->values[i] >> 6] & bit) { // If bit is set.
+        result.words[b->values[i] >> 6] &= ~bit;
+        result.cardinality--;
+      }
+    }
+  }
+  shrinkContainer(&result);
+  return result;
+}
+
+/*
+ * Creates a bitmap of ids held by both bitmaps. Only containers with keys in both bitmaps are
+ * intersected, and empty results are dropped.
+ *
+ * *a:     pointer to the first bitmap.
+ * *b:     pointer to the second bitmap.
+ * return: pointer to a created bitmap.
+ */
+Bitmap *andBitmaps(Bitmap *a, Bitmap *b) {
+  Bitmap *result = createBitmap();
+  int i = 0;
+  int j = 0;
+
+  while (i < a->size && j < b->size) { // Walk containers of both bitmaps.
+    BitmapContainer *ca = &a->containers[i];
+    BitmapContainer *cb = &b->containers[j];
+
+    if (ca->key == cb->key) { // If both bitmaps have the container.
+      BitmapContainer c = andContainers(ca, cb);
+
+      if (c.cardinality > 0) { // If any value is left.
+        appendContainer(result, &c);
+      } else { // Drop an empty container.
+        free(c.values);
+        free(c.words);
+      }
+      i++;
+      j++;
+    } else if (ca->key < cb->key) { // If first bitmap is behind.
+      i++;
+    } else { // Second bitmap is behind.
+      j++;
+    }
+  }
+  return result;
+}
+
+/*
+ * Creates a bitmap of ids held by at least one of bitmaps. Containers with keys in one bitmap
+ * only are copied.
+ *
+ * *a:     pointer to the first bitmap.
+ * *b:     pointer to the second bitmap.
+ * return: pointer to a created bitmap.
+ */
+Bitmap *orBitmaps(Bitmap *a, Bitmap *b) {
+  Bitmap *result = createBitmap();
+  int i = 0;
+  int j = 0;
+
+  while (i < a->size || j < b->size) { // Walk containers of both bitmaps.
+    BitmapContainer c;
+
+    if (j == b->size || (i < a->size && a->containers[i].key < b->containers[j].key)) {
+      c = copyContainer(&a->containers[i++]);
+    } else if (i == a->size || b->containers[j].key < a->containers[i].key) { // If b only.
+      c = copyContainer(&b->containers[j++]);
+    } else { // Both bitmaps have the container.
+      c = orContainers(&a->containers[i++], &b->containers[j++]);
+    }
+    appendContainer(result, &c);
+  }
+  return result;
+}
+
+/*
+ * Creates a bitmap of ids held by the first bitmap but not by the second one. Containers of
+ * the first bitmap with keys missing from the second one are copied.
+ *
+ * *a:     pointer to the bitmap to subtract from.
+ * *b:     pointer to the bitmap to subtract.
+ * return: pointer to a created bitmap.
+ */
+Bitmap *andNotBitmaps(Bitmap *a, Bitmap *b) {
+  Bitmap *result = createBitmap();
+  int j = 0;
+
+  for (int i = 0; i < a->size; i++) { // Iterate containers of the first bitmap.
+    BitmapContainer *ca = &a->containers[i];
+    BitmapContainer c;
+
+    while (j < b->size && b->containers[j].key < ca->key) { // Skip lower keys.
+      j++;
+    }
+    if (j < b->size && b->containers[j].key == ca->key) { // If both have the container.
+      c = andNotContainers(ca, &b->containers[j]);
+    } else { // Keep the whole container.
+      c = copyContainer(ca);
+    }
+    if (c.cardinality > 0) { // If any value is left.
+      appendContainer(result, &c);
+    } else { // Drop an empty container.
+      free(c.values);
+      free(c.words);
+    }
+  }
+  return result;
+}
+
+/*
+ * Finds position of a container with a given key by binary search.
+ *
+ * *bitmap: pointer to a bitmap.
+ * key:     key of a container.
+ * return:  index of the first container which key is not less than the given one.
+ */
+int findContainer(Bitmap *bitmap, uint16_t key) {
+  int low  = 0;
+  int high = bitmap->size;
+
+  while (low < high) { // Narrow range down to one position.
+    int mid = (low + high) / 2;
+
+    if (bitmap->containers[mid].key < key) { // If position is after mid.
+      low = mid + 1;
+    } else { // Position is mid or before it.
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/*
+ * Appends a container to a bitmap, taking over its values. Containers double when full.
+ *
+ * *bitmap:    pointer to a bitmap.
+ * *container: pointer to a container with a key greater than all others.
+ */
+void appendContainer(Bitmap *bitmap, BitmapContainer *container) {
+  if (bitmap->size == bitmap->space) { // If there is no room for the container.
+    bitmap->space *= 2;
+    bitmap->containers = (BitmapContainer*)realloc(bitmap->containers,
+        bitmap->space * sizeof(BitmapContainer));
+  }
+  bitmap->containers[bitmap->size++] = *container;
+}
+
+/*
+ * Adds lower bits of an id to a container. Array container turns into a bitset once it would
+ * hold more than BITMAP_ARRAY_MAX values.
+ *
+ * *c:    pointer to a container.
+ * value: lower bits of the id.
+ */
+void addToContainer(BitmapContainer *c, uint16_t value) {
+  int low  = 0;
+  int high = c->cardinality;
+
+  if (c->words != NULL) { // If container is a bitset.
+    uint64_t bit = (uint64_t)1 << (value & 63);
+
+    if ((c->words[value >> 6] & bit) == 0) { // If bit is not set yet.
+      c->words[value >> 6] |= bit;
+      c->cardinality++;
+    }
+    return;
+  }
+
+  if (high > 0 && c->values[high - 1] < value) { // If value goes last.
+    low = high;
+  }
+  while (low < high) { // Find position of the value.
+    int mid = (low + high) / 2;
+
+    if (c->values[mid] < value) { // If position is after mid.
+      low = mid + 1;
+    } else { // Position is mid or before it.
+      high = mid;
+    }
+  }
+  if (low < c->cardinality && c->values[low] == value) { // If value is already held.
+    return;
+  }
+
+  if (c->cardinality == BITMAP_ARRAY_MAX) { // If array is full.
+    toBitset(c);
+    addToContainer(c, value);
+    return;
+  }
+  if (c->cardinality == c->space) { // If there is no room for the value.
+    c->space  = c->space > 0 ? c->space * 2 : 4;
+    c->values = (uint16_t*)realloc(c->values, c->space * sizeof(uint16_t));
+  }
+  memmove(&c->values[low + 1], &c->values[low], (c->cardinality - low) * sizeof(uint16_t));
+  c->values[low] = value;
+  c->cardinality++;
+}
+
+/*
+ * Removes lower bits of an id from a container. Bitset container turns back into an array 
+ * once it holds half of BITMAP_ARRAY_MAX values, so containers near the limit do not flip 
+ * on every change.
+ *
+ * *c:    pointer to a container.
+ * value: lower bits of the id.
+ */
+void removeFromContainer(BitmapContainer *c, uint16_t value) {
+  int low  = 0;
+  int high = c->cardinality;
+
+  if (c->words != NULL) { // If container is a bitset.
+    uint64_t bit = (uint64_t)1 << (value & 63);
+
+    if ((c->words[value >> 6] & bit) != 0) { // If bit is set.
+      c->words[value >> 6] &= ~bit;
+      c->cardinality--;
+    }
+    if (c->cardinality == BITMAP_ARRAY_MAX / 2) { // If container became sparse.
+      shrinkContainer(c);
+    }
+    return;
+  }
+
+  while (low < high) { // Find position of the value.
+    int mid = (low + high) / 2;
+
+    if (c->values[mid] < value) { // If position is after mid.
+      low = mid + 1;
+    } else { // Position is mid or before it.
+      high = mid;
+    }
+  }
+  if (low == c->cardinality || c->values[low] != value) { // If value is not held.
+    return;
+  }
+  memmove(&c->values[low], &c->values[low + 1], (c->cardinality - low - 1) * sizeof(uint16_t));
+  c->cardinality--;
+}
+
+/*
+ * Checks whether a container holds lower bits of an id. Arrays are searched by binary search.
+ *
+ * *c:     pointer to a container.
+ * value:  lower bits of the id.
+ * return: 1 if container holds them, 0 otherwise.
+ */
+int containerHolds(BitmapContainer *c, uint16_t value) {
+  int low  = 0;
+  int high = c->cardinality;
+
+  if (c->words != NULL) { // If container is a bitset.
+    return (c->words[value >> 6] >> (value & 63)) & 1;
+  }
+  while (low < high) { // Narrow range down to one position.
+    int mid = (low + high) / 2;
+
+    if (c->values[mid] < value) { // If value is after mid.
+      low = mid + 1;
+    } else { // Value is mid or before it.
+      high = mid;
+    }
+  }
+  return low < c->cardinality && c->values[low] == value;
+}
+
+/*
+ * Turns an array container into a bitset container. Bitsets are left as they are.
+ *
+ * *c: pointer to a container.
+ */
+void toBitset(BitmapContainer *c) {
+  if (c->words != NULL) { // If container is a bitset already.
+    return;
+  }
+
+  c->words = (uint64_t*)calloc(BITMAP_WORDS, sizeof(uint64_t));
+  for (int i = 0; i < c->cardinality; i++) { // Set bit of every value.
+    c->words[c->values[i] >> 6] |= (uint64_t)1 << (c->values[i] & 63);
+  }
+  free(c->values);
+  c->values = NULL;
+  c->space  = 0;
+}
+
+/*
+ * Turns a bitset container holding at most BITMAP_ARRAY_MAX values into an array container,
+ * which takes less memory. Other containers are left as they are.
+ *
+ * *c: pointer to a container.
+ */
+void shrinkContainer(BitmapContainer *c) {
+  int count = 0;
+
+  if (c->words == NULL || c->cardinality > BITMAP_ARRAY_MAX) { // If container stays as is.
+    return;
+  }
+
+  c->space  = c->cardinality > 0 ? c->cardinality : 1;
+  c->values = (uint16_t*)malloc(c->space * sizeof(uint16_t));
+  for (int w = 0; w < BITMAP_WORDS; w++) { // Read set bits of every word.
+    uint64_t word = c->words[w];
+
+    while (word != 0) { // Take lowest set bit until none is left.
+      c->values[count++] = (uint16_t)((w << 6) | __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+  free(c->words);
+  c->words = NULL;
+}
+
+/*
+ * Creates a copy of a container with its own values.
+ *
+ * *c:     pointer to a container.
+ * return: copy of the container.
+ */
+BitmapContainer copyContainer(BitmapContainer *c) {
+  BitmapContainer copy = *c;
+
+  if (c->words != NULL) { // If container is a bitset.
+    copy.words = (uint64_t*)malloc(BITMAP_WORDS * sizeof(uint64_t));
+    memcpy(copy.words, c->words, BITMAP_WORDS * sizeof(uint64_t));
+  } else { // Container is an array.
+    copy.space  = c->cardinality > 0 ? c->cardinality : 1;
+    copy.values = (uint16_t*)malloc(copy.space * sizeof(uint16_t));
+    memcpy(copy.values, c->values, c->cardinality * sizeof(uint16_t));
+  }
+  return copy;
+}
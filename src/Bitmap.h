@@ -0,0 +1,218 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+/*
+ * file: Bitmap.h
+ * --------------
+ * Implements compressed bitmap of restaurant ids. Ids are split by their upper 16 bits into
+ * containers. A container holds its lower 16 bits in a sorted array while it is sparse, and
+ * in a bitset once it is dense. Functionality includes creating, adding to, removing from,
+ * testing, listing, and combining bitmaps with AND, OR and ANDNOT.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+
+#define BITMAP_ARRAY_MAX 4096 // Most values held by an array container.
+#define BITMAP_WORDS     1024 // Number of 64-bit words in a bitset container.
+
+typedef struct { // Define container of ids sharing upper 16 bits.
+  uint16_t key;
+  int cardinality;
+  uint16_t *values; // Sorted lower bits, NULL for a bitset container.
+  uint64_t *words;  // Bits of lower bits, NULL for an array container.
+  int space;
+} BitmapContainer;
+
+typedef struct { // Define bitmap as containers sorted by their keys.
+  BitmapContainer *containers;
+  int size;
+  int space;
+} Bitmap;
+
+/*
+ * Initialyzes an empty bitmap.
+ *
+ * return: pointer to a created bitmap.
+ */
+extern Bitmap *createBitmap();
+
+/*
+ * Frees a bitmap and its containers.
+ *
+ * Bitmap*: pointer to a bitmap.
+ */
+extern void freeBitmap(Bitmap*);
+
+/*
+ * Adds an id to a bitmap.
+ *
+ * Bitmap*: pointer to a bitmap.
+ * int:     id to add.
+ */
+extern void addToBitmap(Bitmap*, int);
+
+/*
+ * Removes an id from a bitmap.
+ *
+ * Bitmap*: pointer to a bitmap.
+ * int:     id to remove.
+ */
+extern void removeFromBitmap(Bitmap*, int);
+
+/*
+ * Checks whether a bitmap holds an id.
+ *
+ * Bitmap*: pointer to a bitmap.
+ * int:     id to check.
+ * return:  1 if bitmap holds the id, 0 otherwise.
+ */
+extern int containsBitmap(Bitmap*, int);
+
+/*
+ * Counts ids in a bitmap.
+ *
+ * Bitmap*: pointer to a bitmap.
+ * return:  number of ids.
+ */
+extern int bitmapCardinality(Bitmap*);
+
+/*
+ * Writes ids of a bitmap to an array in increasing order.
+ *
+ * Bitmap*: pointer to a bitmap.
+ * int*:    array with room for all ids.
+ * return:  number of written ids.
+ */
+extern int extractBitmap(Bitmap*, int*);
+
+/*
+ * Appends a container of selection words to a bitmap, taking over the words.
+ *
+ * Bitmap*:   pointer to a bitmap.
+ * uint16_t:  key greater than keys of all containers.
+ * uint64_t*: BITMAP_WORDS words, bit i of word w standing for lower bits 64 * w + i.
+ */
+extern void appendWords(Bitmap*, uint16_t, uint64_t*);
+
+/*
+ * Creates a bitmap of ids held by both bitmaps.
+ *
+ * Bitmap*: pointer to the first bitmap.
+ * Bitmap*: pointer to the second bitmap.
+ * return:  pointer to a created bitmap.
+ */
+extern Bitmap *andBitmaps(Bitmap*, Bitmap*);
+
+/*
+ * Creates a bitmap of ids held by at least one of bitmaps.
+ *
+ * Bitmap*: pointer to the first bitmap.
+ * Bitmap*: pointer to the second bitmap.
+ * return:  pointer to a created bitmap.
+ */
+extern Bitmap *orBitmaps(Bitmap*, Bitmap*);
+
+/*
+ * Creates a bitmap of ids held by the first bitmap but not by the second one.
+ *
+ * Bitmap*: pointer to the first bitmap.
+ * Bitmap*: pointer to the second bitmap.
+ * return:  pointer to a created bitmap.
+ */
+extern Bitmap *andNotBitmaps(Bitmap*, Bitmap*);
+
+/*
+ * Intersects two containers with the same key.
+ *
+ * BitmapContainer*: pointer to the first container.
+ * BitmapContainer*: pointer to the second container.
+ * return:           container with values held by both, possibly empty.
+ */
+extern BitmapContainer andContainers(BitmapContainer*, BitmapContainer*);
+
+/*
+ * Unites two containers with the same key.
+ *
+ * BitmapContainer*: pointer to the first container.
+ * BitmapContainer*: pointer to the second container.
+ * return:           container with values held by either.
+ */
+extern BitmapContainer orContainers(BitmapContainer*, BitmapContainer*);
+
+/*
+ * Subtracts a container from another one with the same key.
+ *
+ * BitmapContainer*: pointer to the container to subtract from.
+ * BitmapContainer*: pointer to the container to subtract.
+ * return:           container with values held by the first container only, possibly empty.
+ */
+extern BitmapContainer andNotContainers(BitmapContainer*, BitmapContainer*);
+
+/*
+ * Finds position of a container with a given key.
+ *
+ * Bitmap*:  pointer to a bitmap.
+ * uint16_t: key of a container.
+ * return:   index of the first container which key is not less than the given one.
+ */
+extern int findContainer(Bitmap*, uint16_t);
+
+/*
+ * Appends a container to a bitmap, taking over its values.
+ *
+ * Bitmap*:          pointer to a bitmap.
+ * BitmapContainer*: pointer to a container with a key greater than all others.
+ */
+extern void appendContainer(Bitmap*, BitmapContainer*);
+
+/*
+ * Adds lower bits of an id to a container.
+ *
+ * BitmapContainer*: pointer to a container.
+ * uint16_t:         lower bits of the id.
+ */
+extern void addToContainer(BitmapContainer*, uint16_t);
+
+/*
+ * Removes lower bits of an id from a container.
+ *
+ * BitmapContainer*: pointer to a container.
+ * uint16_t:         lower bits of the id.
+ */
+extern void removeFromContainer(BitmapContainer*, uint16_t);
+
+/*
+ * Checks whether a container holds lower bits of an id.
+ *
+ * BitmapContainer*: pointer to a container.
+ * uint16_t:         lower bits of the id.
+ * return:           1 if container holds them, 0 otherwise.
+ */
+extern int containerHolds(BitmapContainer*, uint16_t);
+
+/*
+ * Turns an array container into a bitset container.
+ *
+ * BitmapContainer*: pointer to an array container.
+ */
+extern void toBitset(BitmapContainer*);
+
+/*
+ * Turns a bitset container holding few values into an array container.
+ *
+ * BitmapContainer*: pointer to a container.
+ */
+extern void shrinkContainer(BitmapContainer*);
+
+/*
+ * Creates a copy of a container.
+ *
+ * BitmapContainer*: pointer to a container.
+ * return:           copy of the container.
+ */
+extern BitmapContainer copyContainer(BitmapContainer*);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * file: CategoryIndex.c
+ * ---------------------
+ * Implements inverted index of restaurant categories. Each category maps to a posting list of
+ * ids of restaurants that have it. Categories are identified by their pooled handles.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "CategoryIndex.h"
+#include "StringPool.h"
+
+/*
+ * Initialyzes an empty category index. Posting lists are created on first use.
+ *
+ * return: pointer to a created category index.
+ */
+CategoryIndex *createCategoryIndex() {
+  CategoryIndex *index = (CategoryIndex*)malloc(sizeof(CategoryIndex));
+  index->lists = NULL;
+  index->space = 0;
+
+  return index;
+}
+
+/*
+ * Gets posting list of a category by the id of its handle.
+ *
+ * *index:    pointer to a category index.
+ * *category: pooled handle of a category.
+ * return:    pointer to a posting list, NULL if no restaurant has the category.
+ */
+PostingList *getPostings(CategoryIndex *index, char *category) {
+  int id = stringId(category);
+
+  if (id >= index->space) { // If category was never indexed.
+    return NULL;
+  }
+  return index->lists[id];
+}
+
+/*
+ * Adds id of a restaurant to posting lists of all its categories. Grows the index to cover
+ * every pooled string and creates missing posting lists.
+ *
+ * *index:      pointer to a category index.
+ * *restaurant: pointer to a restaurant to index.
+ */
+void indexCategories(CategoryIndex *index, Restaurant *restaurant) {
+  for (Node *curr = restaurant->categories->head; curr != 0; curr = curr->next) { // Categories.
+    int id = stringId(curr->data);
+
+    if (id >= index->space) { // If index does not cover the category yet.
+      int space = poolSize() * 2;
+
+      index->lists = (PostingList**)realloc(index->lists, space * sizeof(PostingList*));
+      memset(index->lists + index->space, 0, (space - index->space) * sizeof(PostingList*));
+      index->space = space;
+    }
+    if (index->lists[id] == NULL) { // If category has no posting list yet.
+      index->lists[id] = createPostingList();
+    }
+    insertPosting(index->lists[id], restaurant->id);
+  }
+}
+
+/*
+ * Removes id of a restaurant from posting lists of all its categories.
+ *
+ * *index:      pointer to a category index.
+ * *restaurant: pointer to a restaurant to unindex.
+ */
+void unindexCategories(CategoryIndex *index, Restaurant *restaurant) {
+  for (Node *curr = restaurant->categories->head; curr != 0; curr = curr->next) { // Categories.
+    PostingList *list = getPostings(index, curr->data);
+
+    if (list != NULL) { // If category is indexed.
+      removePosting(list, restaurant->id);
+    }
+  }
+}
+
+/*
+ * Finds restaurants that have at least one of the given categories by uniting bitmaps of
+ * their posting lists.
+ *
+ * *index:      pointer to a category index.
+ * *categories: list of pooled handles of categories.
+ * return:      pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchCategoryIndex(CategoryIndex *index, LinkedList *categories) {
+  Bitmap *result = createBitmap();
+
+  for (Node *curr = categories->head; curr != 0; curr = curr->next) { // Unite lists.
+    PostingList *list = getPostings(index, curr->data);
+
+    if (list != NULL) { // If some restaurant has the category.
+      Bitmap *ids    = postingBitmap(list);
+      Bitmap *united = orBitmaps(result, ids);
+
+      freeBitmap(result);
+      freeBitmap(ids);
+      result = united;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,63 @@
+#ifndef CATEGORYINDEX_H
+#define CATEGORYINDEX_H
+
+/*
+ * file: CategoryIndex.h
+ * ---------------------
+ * Implements inverted index of restaurant categories. Each category maps to a posting list of
+ * ids of restaurants that have it. Categories are identified by their pooled handles.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "Restaurant.h"
+#include "PostingList.h"
+
+typedef struct { // Define category index as posting lists indexed by category handle id.
+  PostingList **lists;
+  int space;
+} CategoryIndex;
+
+/*
+ * Initialyzes an empty category index.
+ *
+ * return: pointer to a created category index.
+ */
+extern CategoryIndex *createCategoryIndex();
+
+/*
+ * Gets posting list of a category.
+ *
+ * CategoryIndex*: pointer to a category index.
+ * char*:          pooled handle of a category.
+ * return:         pointer to a posting list, NULL if no restaurant has the category.
+ */
+extern PostingList *getPostings(CategoryIndex*, char*);
+
+/*
+ * Adds id of a restaurant to posting lists of all its categories.
+ *
+ * CategoryIndex*: pointer to a category index.
+ * Restaurant*:    pointer to a restaurant to index.
+ */
+extern void indexCategories(CategoryIndex*, Restaurant*);
+
+/*
+ * Removes id of a restaurant from posting lists of all its categories.
+ *
+ * CategoryIndex*: pointer to a category index.
+ * Restaurant*:    pointer to a restaurant to unindex.
+ */
+extern void unindexCategories(CategoryIndex*, Restaurant*);
+
+/*
+ * Finds restaurants that have at least one of the given categories.
+ *
+ * CategoryIndex*: pointer to a category index.
+ * LinkedList*:    list of pooled handles of categories.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchCategoryIndex(CategoryIndex*, LinkedList*);
+
+#endif
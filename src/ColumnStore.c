@@ -0,0 +1,315 @@
+/*
+ * file: ColumnStore.c
+ * -------------------
+ * Implements column store of restaurant fields. Each field is kept in a dense array indexed
+ * by restaurant id, so scans read only the fields they filter on, sequentially. Scans run
+ * predicate kernels over 65536 rows at a time, filling one bitmap container each.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "ColumnStore.h"
+#include "BinaryTree.h"
+#include "Predicate.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
+
+/*
+ * Initialyzes an empty column store with room for 64 rows and empty histograms.
+ *
+ * return: pointer to a created column store.
+ */
+ColumnStore *createColumnStore() {
+  ColumnStore *store = (ColumnStore*)calloc(1, sizeof(ColumnStore));
+  store->space      = 64;
+  store->size       = 0;
+  store->cities     = (int*)malloc(store->space * sizeof(int));
+  store->costs      = (unsigned char*)malloc(store->space * sizeof(unsigned char));
+  store->ranks      = (float*)malloc(store->space * sizeof(float));
+  store->reviewers  = (int*)malloc(store->space * sizeof(int));
+  store->categories = (uint64_t*)malloc(store->space * sizeof(uint64_t));
+
+  return store;
+}
+
+/*
+ * Stores fields of a restaurant in the row of its id and counts them in histograms. Columns 
+ * double when the id does not fit. Rows between the last stored one and the id are marked as 
+ * removed.
+ *
+ * *store:      pointer to a column store.
+ * *restaurant: pointer to a restaurant with an id.
+ */
+void storeColumns(ColumnStore *store, Restaurant *restaurant) {
+  int id = restaurant->id;
+
+  if (id >= store->space) { // If columns have no row for the id.
+    while (id >= store->space) { // Double until the id fits.
+      store->space *= 2;
+    }
+    store->cities     = (int*)realloc(store->cities, store->space * sizeof(int));
+    store->costs      = (unsigned char*)realloc(store->costs, store->space);
+    store->ranks      = (float*)realloc(store->ranks, store->space * sizeof(float));
+    store->reviewers  = (int*)realloc(store->reviewers, store->space * sizeof(int));
+    store->categories = (uint64_t*)realloc(store->categories,
+        store->space * sizeof(uint64_t));
+  }
+  while (store->size < id) { // Mark skipped rows as removed.
+    store->cities[store->size] = -1;
+    clearColumns(store, store->size);
+    store->size++;
+  }
+  if (id < store->size) { // If row was stored before, drop its old fields.
+    clearColumns(store, id);
+  }
+
+  store->cities[id]     = stringId(restaurant->city);
+  store->costs[id]      = costBits(costLevel(restaurant->cost));
+  store->ranks[id]      = restaurant->rank;
+  store->reviewers[id]  = restaurant->reviewers;
+  store->categories[id] = categoryMask(restaurant->categories);
+  if (id >= store->size) { // If row extends the columns.
+    store->size = id + 1;
+  }
+  countColumns(store, id, 1);
+}
+
+/*
+ * Marks row of a removed restaurant. Its city id becomes -1, which matches no city, its cost
+ * level becomes 0 and its reviewers -1, which are within no range, and its rank becomes NaN,
+ * which compares false with any bound. Fields of a stored row are uncounted in histograms.
+ *
+ * *store: pointer to a column store.
+ * id:     id of a removed restaurant.
+ */
+void clearColumns(ColumnStore *store, int id) {
+  if (store->cities[id] >= 0) { // If row holds a restaurant.
+    countColumns(store, id, -1);
+  }
+  store->cities[id]     = -1;
+  store->costs[id]      = 0;
+  store->ranks[id]      = NAN;
+  store->reviewers[id]  = -1;
+  store->categories[id] = 0;
+}
+
+/*
+ * Counts or uncounts fields of a row in histograms. Ranks are rounded to a tenth within 0.0
+ * and 5.0, and numbers of reviewers are bucketed by their bit length.
+ *
+ * *store: pointer to a column store.
+ * id:     id of a stored restaurant.
+ * delta:  1 to count the row, -1 to uncount it.
+ */
+void countColumns(ColumnStore *store, int id, int delta) {
+  float scaled = store->ranks[id] * 10 + 0.5f;
+  unsigned int reviewers = store->reviewers[id] > 0 ? store->reviewers[id] : 0;
+  int length = 0;
+  int rank;
+
+  while (reviewers >> length != 0) { // Count bits of the number of reviewers.
+    length++;
+  }
+  // Clamped as a float, as casting a rank out of int range is undefined; NaN counts as 0.0.
+  rank = !(scaled >= 0) ? 0 : scaled >= RANK_BUCKETS - 1 ? RANK_BUCKETS - 1 : (int)scaled;
+
+  store->costCounts[store->costs[id]]   += delta;
+  store->rankCounts[rank]               += delta;
+  store->reviewerCounts[length]         += delta;
+}
+
+/*
+ * Estimates number of restaurants which value is within a range from histograms. Cost levels
+ * and ranks rounded to a tenth are counted exactly. Numbers of reviewers are assumed to be 
+ * spread evenly within buckets, so a bucket partly in the range counts for its overlap.
+ *
+ * *store: pointer to a column store.
+ * *range: pointer to a range of a column.
+ * return: estimated number of restaurants.
+ */
+int estimateRange(ColumnStore *store, ColumnRange *range) {
+  double estimate = 0;
+
+  if (range->column == COST_COLUMN) { // If range is of cost levels.
+    for (int level = 1; level < 256; level++) { // Add levels within the range.
+      if (level >= range->low && level <= range->high) { // If level is within the range.
+        estimate += store->costCounts[level];
+      }
+    }
+  } else if (range->column == RANK_COLUMN) { // If range is of ranks.
+    for (int b = 0; b < RANK_BUCKETS; b++) { // Add ranks within the range.
+      float rank = b / 10.0f;
+
+      if (rank >= range->lowRank && rank <= range->highRank) { // If rank is within the range.
+        estimate += store->rankCounts[b];
+      }
+    }
+  } else { // Range is of reviewers.
+    for (int b = 0; b < REVIEWER_BUCKETS; b++) { // Add overlap of every bucket.
+      double first = b == 0 ? 0 : (double)(1u << (b - 1));
+      double last  = b == 0 ? 0 : 2 * first - 1;
+      double low   = range->low > first ? range->low : first;
+      double high  = range->high < last ? range->high : last;
+
+      if (low <= high) { // If bucket overlaps the range.
+        estimate += store->reviewerCounts[b] * (high - low + 1) / (last - first + 1);
+      }
+    }
+  }
+  return (int)(estimate + 0.5);
+}
+
+/*
+ * Gets cost level of a cost string by counting its dollar signs.
+ *
+ * *cost:  cost string.
+ * return: number of dollar signs, 0 if string is empty or has other characters.
+ */
+int costLevel(char *cost) {
+  int level = 0;
+
+  while (cost[level] == '$') { // Count leading dollar signs.
+    level++;
+  }
+  return cost[level] == 0 ? level : 0;
+}
+
+/*
+ * Gets bit of a category in category masks. Categories share 64 bits by the ids of their
+ * handles, so a mask tells for sure only which categories a restaurant does not have.
+ *
+ * *category: pooled handle of a category.
+ * return:    mask with the bit of the category set.
+ */
+uint64_t categoryBit(char *category) {
+  return (uint64_t)1 << (stringId(category) & 63);
+}
+
+/*
+ * Gets mask with bits of all categories in a list.
+ *
+ * *categories: list of pooled handles of categories.
+ * return:      mask with bits of the categories set.
+ */
+uint64_t categoryMask(LinkedList *categories) {
+  uint64_t mask = 0;
+
+  for (Node *curr = categories->head; curr != 0; curr = curr->next) { // Set category bits.
+    mask |= categoryBit(curr->data);
+  }
+  return mask;
+}
+
+/*
+ * Scans city column for restaurants in a city. Only the city column is read.
+ *
+ * *store: pointer to a column store.
+ * city:   id of pooled city handle.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *scanCity(ColumnStore *store, int city) {
+  ScanJob job = {store, NULL, city, NULL};
+
+  return runScan(&job);
+}
+
+/*
+ * Scans a column for restaurants which value is within a range. Only the column of the range
+ * is read. Removed restaurants are never within a range.
+ *
+ * *store: pointer to a column store.
+ * *range: pointer to a range of a column.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *scanRange(ColumnStore *store, ColumnRange *range) {
+  ScanJob job = {store, range, 0, NULL};
+
+  return runScan(&job);
+}
+
+/*
+ * Runs a scan split into morsels of MORSEL_ROWS rows on the current thread pool. Selection 
+ * words of every container are allocated up front, and a morsel fills only the words of its 
+ * rows, so threads never write the same word. Words then go to the bitmap in order of the 
+ * containers, so found ids do not depend on the number of threads.
+ *
+ * *job:   pointer to a scan job with the column store and what to select.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *runScan(ScanJob *job) {
+  Bitmap *found = createBitmap();
+  int containers = (job->store->size + 65535) >> 16;
+
+  job->words = (uint64_t**)malloc((containers + 1) * sizeof(uint64_t*));
+  for (int c = 0; c < containers; c++) { // Allocate words of every container.
+    job->words[c] = (uint64_t*)calloc(BITMAP_WORDS, sizeof(uint64_t));
+  }
+  simdPredicates(); // Ask processor for kernels before threads do.
+  runMorsels(scanMorsel, job, (job->store->size + MORSEL_ROWS - 1) / MORSEL_ROWS);
+
+  for (int c = 0; c < containers; c++) { // Add words of every container.
+    appendWords(found, (uint16_t)c, job->words[c]);
+  }
+  free(job->words);
+  return found;
+}
+
+/*
+ * Selects rows of one morsel of a scan into the words of its container. Morsels start at a 
+ * multiple of 64 rows, so their words do not overlap.
+ *
+ * *job:   pointer to a scan job.
+ * morsel: number of the morsel.
+ */
+void scanMorsel(void *job, int morsel) {
+  ScanJob *scan = (ScanJob*)job;
+  int first = morsel * MORSEL_ROWS;
+  int count = scan->store->size - first < MORSEL_ROWS ? scan->store->size - first : MORSEL_ROWS;
+  uint64_t *words = scan->words[first >> 16] + ((first & 65535) >> 6);
+
+  if (scan->range != NULL) { // If scan selects a range.
+    selectRange(scan->store, scan->range, first, count, words);
+  } else { // Scan selects a city.
+    selectInts(scan->store->cities + first, count, scan->city, scan->city, words);
+  }
+}
+
+/*
+ * Selects rows of a column within a range with the kernel for the type of the column.
+ *
+ * *store: pointer to a column store.
+ * *range: pointer to a range of a column.
+ * first:  first row.
+ * count:  number of rows.
+ * *words: selection words with room for all rows.
+ */
+void selectRange(ColumnStore *store, ColumnRange *range, int first, int count,
+    uint64_t *words) {
+  if (range->column == COST_COLUMN) { // If range is of cost levels.
+    selectBytes(store->costs + first, count, range->low, range->high, words);
+  } else if (range->column == RANK_COLUMN) { // If range is of ranks.
+    selectFloats(store->ranks + first, count, range->lowRank, range->highRank, words);
+  } else { // Range is of reviewers.
+    selectInts(store->reviewers + first, count, range->low, range->high, words);
+  }
+}
+
+/*
+ * Checks whether value of a restaurant is within a range.
+ *
+ * *store: pointer to a column store.
+ * *range: pointer to a range of a column.
+ * id:     id of a restaurant.
+ * return: 1 if value is within the range, 0 otherwise.
+ */
+int inRange(ColumnStore *store, ColumnRange *range, int id) {
+  if (range->column == COST_COLUMN) { // If range is of cost levels.
+    return store->costs[id] >= range->low && store->costs[id] <= range->high;
+  } else if (range->column == RANK_COLUMN) { // If range is of ranks.
+    return store->ranks[id] >= range->lowRank && store->ranks[id] <= range->highRank;
+  }
+  return store->reviewers[id] >= range->low && store->reviewers[id] <= range->high;
+}
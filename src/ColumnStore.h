@@ -0,0 +1,173 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+/*
+ * file: ColumnStore.h
+ * -------------------
+ * Implements column store of restaurant fields. Each field is kept in a dense array indexed
+ * by restaurant id, so scans read only the fields they filter on, sequentially.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+#include "Restaurant.h"
+#include "Bitmap.h"
+
+#define RANK_BUCKETS     51 // Ranks from 0.0 to 5.0 by tenths.
+#define REVIEWER_BUCKETS 33 // Bit lengths of numbers of reviewers.
+
+typedef struct { // Define column store holding restaurant fields in arrays indexed by id.
+  int *cities;          // Id of pooled city handle, -1 for removed restaurants.
+  unsigned char *costs; // Dollar signs up to 255, 0 if cost is not made of them.
+  float *ranks;
+  int *reviewers;
+  uint64_t *categories; // Bit of every category, see categoryBit().
+  int size;
+  int space;
+  int costCounts[256];                   // Restaurants of every cost level.
+  int rankCounts[RANK_BUCKETS];          // Restaurants of every rank rounded to a tenth.
+  int reviewerCounts[REVIEWER_BUCKETS];  // Restaurants by bit length of their reviewers.
+} ColumnStore;
+
+typedef enum { // Define columns that ranges can filter on.
+  COST_COLUMN, RANK_COLUMN, REVIEWERS_COLUMN
+} Column;
+
+typedef struct { // Define inclusive range of values in a column.
+  Column column;
+  int low;        // Bounds of cost levels or reviewers.
+  int high;
+  float lowRank;  // Bounds of ranks.
+  float highRank;
+} ColumnRange;
+
+typedef struct { // Define scan of a column split into morsels.
+  ColumnStore *store;
+  ColumnRange *range; // Range to select, NULL to select a city.
+  int city;           // Id of pooled city handle to select.
+  uint64_t **words;   // Selection words of every container.
+} ScanJob;
+
+/*
+ * Initialyzes an empty column store.
+ *
+ * return: pointer to a created column store.
+ */
+extern ColumnStore *createColumnStore();
+
+/*
+ * Stores fields of a restaurant in the row of its id.
+ *
+ * ColumnStore*: pointer to a column store.
+ * Restaurant*:  pointer to a restaurant with an id.
+ */
+extern void storeColumns(ColumnStore*, Restaurant*);
+
+/*
+ * Marks row of a removed restaurant, so scans skip it.
+ *
+ * ColumnStore*: pointer to a column store.
+ * int:          id of a removed restaurant.
+ */
+extern void clearColumns(ColumnStore*, int);
+
+/*
+ * Counts or uncounts fields of a row in histograms.
+ *
+ * ColumnStore*: pointer to a column store.
+ * int:          id of a stored restaurant.
+ * int:          1 to count the row, -1 to uncount it.
+ */
+extern void countColumns(ColumnStore*, int, int);
+
+/*
+ * Estimates number of restaurants which value is within a range.
+ *
+ * ColumnStore*: pointer to a column store.
+ * ColumnRange*: pointer to a range of a column.
+ * return:       estimated number of restaurants.
+ */
+extern int estimateRange(ColumnStore*, ColumnRange*);
+
+/*
+ * Gets cost level of a cost string.
+ *
+ * char*:  cost string.
+ * return: number of dollar signs, 0 if string is not made of them.
+ */
+extern int costLevel(char*);
+
+/*
+ * Gets bit of a category in category masks.
+ *
+ * char*:  pooled handle of a category.
+ * return: mask with the bit of the category set.
+ */
+extern uint64_t categoryBit(char*);
+
+/*
+ * Gets mask with bits of all categories in a list.
+ *
+ * LinkedList*: list of pooled handles of categories.
+ * return:      mask with bits of the categories set.
+ */
+extern uint64_t categoryMask(LinkedList*);
+
+/*
+ * Scans city column for restaurants in a city.
+ *
+ * ColumnStore*: pointer to a column store.
+ * int:          id of pooled city handle.
+ * return:       pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *scanCity(ColumnStore*, int);
+
+/*
+ * Scans a column for restaurants which value is within a range.
+ *
+ * ColumnStore*: pointer to a column store.
+ * ColumnRange*: pointer to a range of a column.
+ * return:       pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *scanRange(ColumnStore*, ColumnRange*);
+
+/*
+ * Runs a scan split into morsels on the current thread pool.
+ *
+ * ScanJob*: pointer to a scan job with the column store and what to select.
+ * return:   pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *runScan(ScanJob*);
+
+/*
+ * Selects rows of one morsel of a scan.
+ *
+ * void*: pointer to a scan job.
+ * int:   number of the morsel.
+ */
+extern void scanMorsel(void*, int);
+
+/*
+ * Selects rows of a column within a range.
+ *
+ * ColumnStore*: pointer to a column store.
+ * ColumnRange*: pointer to a range of a column.
+ * int:          first row.
+ * int:          number of rows.
+ * uint64_t*:    selection words with room for all rows.
+ */
+extern void selectRange(ColumnStore*, ColumnRange*, int, int, uint64_t*);
+
+/*
+ * Checks whether value of a restaurant is within a range.
+ *
+ * ColumnStore*: pointer to a column store.
+ * ColumnRange*: pointer to a range of a column.
+ * int:          id of a restaurant.
+ * return:       1 if value is within the range, 0 otherwise.
+ */
+extern int inRange(ColumnStore*, ColumnRange*, int);
+
+#endif
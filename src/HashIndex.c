@@ -0,0 +1,202 @@
+/*
+ * file: HashIndex.c
+ * -----------------
+ * Implements hash index of restaurants keyed by name and city. Each entry points to a
+ * restaurant and to the nodes holding it in the name and city trees. Uses open addressing
+ * with linear probing, and grows by moving a few slots to a bigger table on every change.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "HashIndex.h"
+#include "StringPool.h"
+
+Restaurant hashDeleted; // Marks slots of removed entries, so probing continues past them.
+
+/*
+ * Initialyzes an empty hash index with HASH_FIRST_CAPACITY slots.
+ *
+ * return: pointer to a created hash index.
+ */
+HashIndex *createHashIndex() {
+  HashIndex *index = (HashIndex*)malloc(sizeof(HashIndex));
+  index->slots       = (HashSlot*)calloc(HASH_FIRST_CAPACITY, sizeof(HashSlot));
+  index->capacity    = HASH_FIRST_CAPACITY;
+  index->used        = 0;
+  index->size        = 0;
+  index->old         = NULL;
+  index->oldCapacity = 0;
+  index->moved       = 0;
+
+  return index;
+}
+
+/*
+ * Computes hash of a name and a pooled city handle. Name is hashed by its characters and the
+ * city by the id of its handle, then high bits are folded into the low bits used for probing.
+ *
+ * *name:  name of a restaurant.
+ * *city:  pooled handle of a city.
+ * return: hash of the pair.
+ */
+unsigned int hashPair(char *name, char *city) {
+  unsigned int hash = hashString(name);
+
+  hash = (hash ^ (unsigned int)stringId(city)) * 16777619u;
+  return hash ^ (hash >> 16);
+}
+
+/*
+ * Inserts an entry for a restaurant in the new table. Starts growing the index when three
+ * quarters of its slots are used, and moves HASH_STEP old slots while growing.
+ *
+ * *index:      pointer to a hash index.
+ * *restaurant: pointer to a restaurant to insert.
+ * *nameNode:   pointer to the node holding the restaurant in the name tree.
+ * *cityNode:   pointer to the node holding the restaurant in the city tree.
+ */
+void insertInHashIndex(HashIndex *index, Restaurant *restaurant, BTNode *nameNode,
+    BTNode *cityNode) {
+  unsigned int hash = hashPair(restaurant->name, restaurant->city);
+  HashSlot *slot;
+
+  if ((index->used + 1) * 4 > index->capacity * 3) { // If table is too full.
+    growHashIndex(index);
+  }
+
+  slot = probeHashIndex(index->slots, index->capacity, hash);
+  if (slot->restaurant == NULL) { // If slot was never used.
+    index->used++;
+  }
+  slot->hash       = hash;
+  slot->restaurant = restaurant;
+  slot->nameNode   = nameNode;
+  slot->cityNode   = cityNode;
+  index->size++;
+
+  stepHashIndex(index, HASH_STEP);
+}
+
+/*
+ * Searches for an entry of a restaurant with given name and city. Probes the new table and
+ * then the table being moved out of, until an empty slot is reached. Stored hashes are
+ * compared before names, and cities are compared by their handles.
+ *
+ * *index: pointer to a hash index.
+ * *name:  name of a restaurant.
+ * *city:  pooled handle of a city.
+ * return: pointer to a slot of a matching entry, NULL if there is none.
+ */
+HashSlot *searchHashIndex(HashIndex *index, char *name, char *city) {
+  unsigned int hash = hashPair(name, city);
+  HashSlot *tables[2]   = {index->slots, index->old};
+  int capacities[2]     = {index->capacity, index->oldCapacity};
+
+  for (int t = 0; t < 2 && tables[t] != NULL; t++) { // Probe both tables.
+    unsigned int mask = capacities[t] - 1;
+
+    for (unsigned int i = hash & mask; tables[t][i].restaurant != NULL; i = (i + 1) & mask) {
+      HashSlot *slot = &tables[t][i];
+
+      if (slot->hash == hash && slot->restaurant != HASH_DELETED
+          && slot->restaurant->city == city && strcmp(slot->restaurant->name, name) == 0) {
+        return slot;
+      }
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Removes an entry found by a search. Slot is marked as removed instead of emptied, so entries
+ * further along the probe path can still be found.
+ *
+ * *index: pointer to a hash index.
+ * *slot:  pointer to a slot of the entry.
+ */
+void removeHashSlot(HashIndex *index, HashSlot *slot) {
+  slot->restaurant = HASH_DELETED;
+  index->size--;
+
+  stepHashIndex(index, HASH_STEP);
+}
+
+/*
+ * Finds a slot for an entry with a given hash in a table. Slots of removed entries are reused.
+ *
+ * *slots:   pointer to a table of slots.
+ * capacity: capacity of the table.
+ * hash:     hash of the entry.
+ * return:   pointer to the first empty or removed slot on the probe path.
+ */
+HashSlot *probeHashIndex(HashSlot *slots, int capacity, unsigned int hash) {
+  unsigned int mask = capacity - 1;
+  unsigned int i    = hash & mask;
+
+  while (slots[i].restaurant != NULL && slots[i].restaurant != HASH_DELETED) { // Probe.
+    i = (i + 1) & mask;
+  }
+  return &slots[i];
+}
+
+/*
+ * Starts moving entries to a new table. Table doubles if more than half of its slots hold
+ * entries, otherwise it keeps its capacity and only drops removed entries. Any previous move
+ * is finished first.
+ *
+ * *index: pointer to a hash index.
+ */
+void growHashIndex(HashIndex *index) {
+  int capacity = index->capacity;
+
+  if (index->old != NULL) { // If previous move is not finished.
+    stepHashIndex(index, index->oldCapacity);
+  }
+  if (index->size * 2 > capacity) { // If table is mostly entries.
+    capacity *= 2;
+  }
+
+  index->old         = index->slots;
+  index->oldCapacity = index->capacity;
+  index->moved       = 0;
+  index->slots       = (HashSlot*)calloc(capacity, sizeof(HashSlot));
+  index->capacity    = capacity;
+  index->used        = 0;
+}
+
+/*
+ * Moves a given number of old slots to the new table. Moved slots are marked as removed, so
+ * searches do not find an entry twice. Old table is freed once all of its slots are moved.
+ *
+ * *index: pointer to a hash index.
+ * count:  number of old slots to move.
+ */
+void stepHashIndex(HashIndex *index, int count) {
+  if (index->old == NULL) { // If index is not growing.
+    return;
+  }
+
+  for (; count > 0 && index->moved < index->oldCapacity; count--) { // Move slots.
+    HashSlot *from = &index->old[index->moved];
+
+    if (from->restaurant != NULL && from->restaurant != HASH_DELETED) { // If slot has entry.
+      HashSlot *to = probeHashIndex(index->slots, index->capacity, from->hash);
+
+      if (to->restaurant == NULL) { // If slot was never used.
+        index->used++;
+      }
+      *to = *from;
+      from->restaurant = HASH_DELETED;
+    }
+    index->moved++;
+  }
+
+  if (index->moved == index->oldCapacity) { // If all slots were moved.
+    free(index->old);
+    index->old         = NULL;
+    index->oldCapacity = 0;
+  }
+}
@@ -0,0 +1,111 @@
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+/*
+ * file: HashIndex.h
+ * -----------------
+ * Implements hash index of restaurants keyed by name and city. Each entry points to a
+ * restaurant and to the nodes holding it in the name and city trees. Uses open addressing
+ * with linear probing, and grows by moving a few slots to a bigger table on every change.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "BinaryTree.h"
+
+#define HASH_FIRST_CAPACITY 64 // Number of slots in a new table, must be a power of two.
+#define HASH_STEP 16           // Number of old slots moved on every change while growing.
+
+typedef struct { // Define slot of a hash index.
+  unsigned int hash;
+  Restaurant *restaurant; // NULL for an empty slot, HASH_DELETED for a removed entry.
+  BTNode *nameNode;
+  BTNode *cityNode;
+} HashSlot;
+
+typedef struct { // Define hash index as a table of slots and a table being moved out of.
+  HashSlot *slots;
+  int capacity;
+  int used;     // Slots that are not empty, including removed entries.
+  int size;     // Entries in both tables.
+  HashSlot *old;
+  int oldCapacity;
+  int moved;    // Old slots moved so far.
+} HashIndex;
+
+extern Restaurant hashDeleted;
+
+#define HASH_DELETED (&hashDeleted)
+
+/*
+ * Initialyzes an empty hash index.
+ *
+ * return: pointer to a created hash index.
+ */
+extern HashIndex *createHashIndex();
+
+/*
+ * Computes hash of a name and a pooled city handle.
+ *
+ * char*:  name of a restaurant.
+ * char*:  pooled handle of a city.
+ * return: hash of the pair.
+ */
+extern unsigned int hashPair(char*, char*);
+
+/*
+ * Inserts an entry for a restaurant. Restaurants with the same name and city get separate
+ * entries.
+ *
+ * HashIndex*:  pointer to a hash index.
+ * Restaurant*: pointer to a restaurant to insert.
+ * BTNode*:     pointer to the node holding the restaurant in the name tree.
+ * BTNode*:     pointer to the node holding the restaurant in the city tree.
+ */
+extern void insertInHashIndex(HashIndex*, Restaurant*, BTNode*, BTNode*);
+
+/*
+ * Searches for an entry of a restaurant with given name and city.
+ *
+ * HashIndex*: pointer to a hash index.
+ * char*:      name of a restaurant.
+ * char*:      pooled handle of a city.
+ * return:     pointer to a slot of a matching entry, NULL if there is none.
+ */
+extern HashSlot *searchHashIndex(HashIndex*, char*, char*);
+
+/*
+ * Removes an entry found by a search.
+ *
+ * HashIndex*: pointer to a hash index.
+ * HashSlot*:  pointer to a slot of the entry.
+ */
+extern void removeHashSlot(HashIndex*, HashSlot*);
+
+/*
+ * Finds a slot for an entry with a given hash in a table.
+ *
+ * HashSlot*:    pointer to a table of slots.
+ * int:          capacity of the table.
+ * unsigned int: hash of the entry.
+ * return:       pointer to the first empty or removed slot on the probe path.
+ */
+extern HashSlot *probeHashIndex(HashSlot*, int, unsigned int);
+
+/*
+ * Starts moving entries to a new table.
+ *
+ * HashIndex*: pointer to a hash index.
+ */
+extern void growHashIndex(HashIndex*);
+
+/*
+ * Moves a given number of old slots to the new table.
+ *
+ * HashIndex*: pointer to a hash index.
+ * int:        number of old slots to move.
+ */
+extern void stepHashIndex(HashIndex*, int);
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * file: HoursIndex.c
+ * ------------------
+ * Implements index of opening hours. Every slot of the week maps to a bitmap of restaurants 
+ * open through all of it, and a bitmap of restaurants open in a part of it only, which are 
+ * checked against their hours. Functionality includes indexing, unindexing and finding 
+ * restaurants open at a moment of the week.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "HoursIndex.h"
+
+/*
+ * Initialyzes an empty hours index with an empty pair of bitmaps for every slot.
+ *
+ * return: pointer to a created hours index.
+ */
+HoursIndex *createHoursIndex() {
+  HoursIndex *index = (HoursIndex*)malloc(sizeof(HoursIndex));
+
+  for (int s = 0; s < WEEK_SLOTS; s++) { // Create bitmaps of every slot.
+    index->whole[s] = createBitmap();
+    index->part[s]  = createBitmap();
+  }
+  return index;
+}
+
+/*
+ * Adds id of a restaurant to bitmaps of slots it is open in, see markSlots().
+ *
+ * *index:      pointer to an hours index.
+ * *restaurant: pointer to a restaurant to index.
+ */
+void indexHours(HoursIndex *index, Restaurant *restaurant) {
+  uint64_t whole[SLOT_WORDS];
+  uint64_t part[SLOT_WORDS];
+
+  markSlots(&restaurant->hours, whole, part);
+  for (int s = 0; s < WEEK_SLOTS; s++) { // Add restaurant to bitmaps of every marked slot.
+    if ((whole[s >> 6] >> (s & 63)) & 1) { // If restaurant is open through the slot.
+      addToBitmap(index->whole[s], restaurant->id);
+    } else if ((part[s >> 6] >> (s & 63)) & 1) { // If it is open in a part of the slot.
+      addToBitmap(index->part[s], restaurant->id);
+    }
+  }
+}
+
+/*
+ * Removes id of a restaurant from bitmaps of slots it is open in, see markSlots().
+ *
+ * *index:      pointer to an hours index.
+ * *restaurant: pointer to a restaurant to unindex.
+ */
+void unindexHours(HoursIndex *index, Restaurant *restaurant) {
+  uint64_t whole[SLOT_WORDS];
+  uint64_t part[SLOT_WORDS];
+
+  markSlots(&restaurant->hours, whole, part);
+  for (int s = 0; s < WEEK_SLOTS; s++) { // Remove restaurant from bitmaps of marked slots.
+    if ((whole[s >> 6] >> (s & 63)) & 1) { // If restaurant is open through the slot.
+      removeFromBitmap(index->whole[s], restaurant->id);
+    } else if ((part[s >> 6] >> (s & 63)) & 1) { // If it is open in a part of the slot.
+      removeFromBitmap(index->part[s], restaurant->id);
+    }
+  }
+}
+
+/*
+ * Fills an empty hours index with restaurants which ids are their positions in an array. 
+ * Ids sharing upper 16 bits are marked in bitset words of every slot, which are appended to 
+ * the bitmaps as containers, so no id is searched for in a container. Slots of 64 ids are 
+ * marked in one word per slot first, which stays in cache, and the words are then stored.
+ *
+ * *index:        pointer to an empty hours index.
+ * **restaurants: array of restaurants in order of their ids, starting from 0.
+ * count:         number of restaurants.
+ */
+void buildHoursIndex(HoursIndex *index, Restaurant **restaurants, int count) {
+  uint64_t **words = (uint64_t**)malloc(2 * WEEK_SLOTS * sizeof(uint64_t*));
+  uint64_t *block = (uint64_t*)malloc(2 * WEEK_SLOTS * sizeof(uint64_t));
+  uint64_t slots[2][SLOT_WORDS];
+
+  for (int first = 0; first < count; first += 1 << 16) { // Build containers of every key.
+    for (int s = 0; s < 2 * WEEK_SLOTS; s++) { // Create words of every bitmap.
+      words[s] = (uint64_t*)calloc(BITMAP_WORDS, sizeof(uint64_t));
+    }
+    for (int base = first; base < count && base < first + (1 << 16); base += 64) { // Block.
+      memset(block, 0, 2 * WEEK_SLOTS * sizeof(uint64_t));
+      for (int id = base; id < count && id < base + 64; id++) { // Mark every id of the block.
+        uint64_t bit = (uint64_t)1 << (id & 63);
+
+        markSlots(&restaurants[id]->hours, slots[0], slots[1]);
+        for (int w = 0; w < 2 * SLOT_WORDS; w++) { // Visit set bits of whole, then part words.
+          uint64_t word = slots[w / SLOT_WORDS][w % SLOT_WORDS];
+          uint64_t *row = block + w / SLOT_WORDS * WEEK_SLOTS + (w % SLOT_WORDS << 6);
+
+          while (word != 0) { // Take lowest set bit until none is left.
+            row[__builtin_ctzll(word)] |= bit;
+            word &= word - 1;
+          }
+        }
+      }
+      for (int s = 0; s < 2 * WEEK_SLOTS; s++) { // Store word of the block in every bitmap.
+        words[s][(base & 0xffff) >> 6] = block[s];
+      }
+    }
+    for (int s = 0; s < WEEK_SLOTS; s++) { // Append words to bitmaps, which take them over.
+      appendWords(index->whole[s], (uint16_t)(first >> 16), words[s]);
+      appendWords(index->part[s], (uint16_t)(first >> 16), words[WEEK_SLOTS + s]);
+    }
+  }
+  free(block);
+  free(words);
+}
+
+/*
+ * Finds restaurants open at a moment of the week. Restaurants open through the slot of the 
+ * moment are open at it, and those open in a part of the slot only are checked by their 
+ * hours, see isOpenAt().
+ *
+ * *index:        pointer to an hours index.
+ * **restaurants: array of restaurants indexed by id.
+ * moment:        minutes after Monday midnight.
+ * return:        pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchHoursIndex(HoursIndex *index, Restaurant **restaurants, int moment) {
+  int slot = moment / SLOT_MINUTES;
+  Bitmap *open = createBitmap();
+  Bitmap *found;
+  int *ids = (int*)malloc((bitmapCardinality(index->part[slot]) + 1) * sizeof(int));
+  int count = extractBitmap(index->part[slot], ids);
+
+  for (int i = 0; i < count; i++) { // Check every restaurant open in a part of the slot.
+    if (isOpenAt(&restaurants[ids[i]]->hours, moment)) { // If it is open at the moment.
+      addToBitmap(open, ids[i]);
+    }
+  }
+  found = orBitmaps(index->whole[slot], open);
+  freeBitmap(open);
+  free(ids);
+  return found;
+}
+
+/*
+ * Estimates number of restaurants open at a moment of the week as the number of restaurants 
+ * open in some part of the slot of the moment.
+ *
+ * *index: pointer to an hours index.
+ * moment: minutes after Monday midnight.
+ * return: number of restaurants open in some part of the slot of the moment.
+ */
+int estimateHours(HoursIndex *index, int moment) {
+  int slot = moment / SLOT_MINUTES;
+
+  return bitmapCardinality(index->whole[slot]) + bitmapCardinality(index->part[slot]);
+}
@@ -0,0 +1,75 @@
+#ifndef HOURSINDEX_H
+#define HOURSINDEX_H
+
+/*
+ * file: HoursIndex.h
+ * ------------------
+ * Implements index of opening hours. Every slot of the week maps to a bitmap of restaurants 
+ * open through all of it, and a bitmap of restaurants open in a part of it only, which are 
+ * checked against their hours. Functionality includes indexing, unindexing and finding 
+ * restaurants open at a moment of the week.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "Bitmap.h"
+#include "Restaurant.h"
+
+typedef struct { // Define hours index as bitmaps of restaurants open in every slot of a week.
+  Bitmap *whole[WEEK_SLOTS]; // Restaurants open through the whole slot.
+  Bitmap *part[WEEK_SLOTS];  // Restaurants open in a part of the slot only.
+} HoursIndex;
+
+/*
+ * Initialyzes an empty hours index.
+ *
+ * return: pointer to a created hours index.
+ */
+extern HoursIndex *createHoursIndex();
+
+/*
+ * Adds id of a restaurant to bitmaps of slots it is open in.
+ *
+ * HoursIndex*: pointer to an hours index.
+ * Restaurant*: pointer to a restaurant to index.
+ */
+extern void indexHours(HoursIndex*, Restaurant*);
+
+/*
+ * Removes id of a restaurant from bitmaps of slots it is open in.
+ *
+ * HoursIndex*: pointer to an hours index.
+ * Restaurant*: pointer to a restaurant to unindex.
+ */
+extern void unindexHours(HoursIndex*, Restaurant*);
+
+/*
+ * Fills an empty hours index with restaurants which ids are their positions in an array.
+ *
+ * HoursIndex*:  pointer to an empty hours index.
+ * Restaurant**: array of restaurants in order of their ids, starting from 0.
+ * int:          number of restaurants.
+ */
+extern void buildHoursIndex(HoursIndex*, Restaurant**, int);
+
+/*
+ * Finds restaurants open at a moment of the week.
+ *
+ * HoursIndex*:  pointer to an hours index.
+ * Restaurant**: array of restaurants indexed by id.
+ * int:          minutes after Monday midnight.
+ * return:       pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchHoursIndex(HoursIndex*, Restaurant**, int);
+
+/*
+ * Estimates number of restaurants open at a moment of the week.
+ *
+ * HoursIndex*: pointer to an hours index.
+ * int:         minutes after Monday midnight.
+ * return:      number of restaurants open in some part of the slot of the moment.
+ */
+extern int estimateHours(HoursIndex*, int);
+
+#endif
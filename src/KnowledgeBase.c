@@ -0,0 +1,314 @@
+/*
+ * file: KnowledgeBase.c
+ * ---------------------
+ * Implements knowledge base of restaurants. Holds every indexing structure and keeps them in
+ * sync as restaurants are added and removed. Each restaurant gets an id that stays the same
+ * for as long as it is in the knowledge base.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "KnowledgeBase.h"
+#include "StringPool.h"
+
+/*
+ * Initialyzes an empty knowledge base. Creates the binary trees, the category index, the
+ * trigram index of names, the hours index, the hash index of names and cities, and the 
+ * column store.
+ *
+ * backend: data structure storing the trees (AVL or BPLUS).
+ * return:  pointer to a created knowledge base.
+ */
+KnowledgeBase *createKnowledgeBase(TreeBackend backend) {
+  KnowledgeBase *kb = (KnowledgeBase*)malloc(sizeof(KnowledgeBase));
+  kb->btName      = createBinaryTree(NAME, backend);
+  kb->btCity      = createBinaryTree(LOCATION, backend);
+  kb->btRank      = createBinaryTree(RANK, backend);
+  kb->btReviewers = createBinaryTree(REVIEWERS, backend);
+  kb->btCost      = createBinaryTree(COST, backend);
+  kb->categories  = createCategoryIndex();
+  kb->names       = createTrigramIndex();
+  kb->hours       = createHoursIndex();
+  kb->pairs       = createHashIndex();
+  kb->columns     = createColumnStore();
+  kb->restaurants = (Restaurant**)malloc(64 * sizeof(Restaurant*));
+  kb->count       = 0;
+  kb->space       = 64;
+  kb->live        = 0;
+
+  return kb;
+}
+
+/*
+ * Gives a restaurant the next free id and adds it to all indexing structures. Ids are never
+ * reused, so they grow in order of adding.
+ *
+ * *kb:         pointer to a knowledge base.
+ * *restaurant: pointer to a restaurant to add.
+ */
+void addToKnowledgeBase(KnowledgeBase *kb, Restaurant *restaurant) {
+  BTNode *nameNode;
+  BTNode *cityNode;
+
+  if (kb->count == kb->space) { // If there is no room for another id.
+    kb->space *= 2;
+    kb->restaurants = (Restaurant**)realloc(kb->restaurants, kb->space * sizeof(Restaurant*));
+  }
+
+  restaurant->id = kb->count;
+  kb->restaurants[kb->count] = restaurant;
+  kb->count++;
+  kb->live++;
+
+  nameNode = insertInBinaryTree(kb->btName, restaurant);
+  cityNode = insertInBinaryTree(kb->btCity, restaurant);
+  insertInBinaryTree(kb->btRank, restaurant);
+  insertInBinaryTree(kb->btReviewers, restaurant);
+  insertInBinaryTree(kb->btCost, restaurant);
+  indexCategories(kb->categories, restaurant);
+  indexName(kb->names, restaurant);
+  indexHours(kb->hours, restaurant);
+  insertInHashIndex(kb->pairs, restaurant, nameNode, cityNode);
+  storeColumns(kb->columns, restaurant);
+}
+
+/*
+ * Adds many restaurants at once. If knowledge base is empty, restaurants get ids in order of 
+ * the list, and copies of the list are sorted by the rule of every tree at the same time, 
+ * all but the name one in separate threads. Hours index is built a container at a time. 
+ * Trees are then built bottom-up from the sorted copies, and nodes the name and city trees 
+ * put each restaurant in go to the hash index. Otherwise restaurants are added one by one.
+ *
+ * *kb:   pointer to a knowledge base.
+ * *list: pointer to an array list of restaurants to add.
+ */
+void loadKnowledgeBase(KnowledgeBase *kb, ArrayList *list) {
+  loadSortedKnowledgeBase(kb, list, NULL);
+}
+
+/*
+ * Adds many restaurants at once, as loadKnowledgeBase() does, from restaurants that may come
+ * sorted by the rule of every tree already, as a snapshot keeps them. Sorted lists are only
+ * read, and are used if knowledge base is empty.
+ *
+ * *kb:       pointer to a knowledge base.
+ * *list:     pointer to an array list of restaurants to add.
+ * ***sorted: TREE_ORDERS lists of the restaurants in order of every tree, NULL to sort them.
+ */
+void loadSortedKnowledgeBase(KnowledgeBase *kb, ArrayList *list, Restaurant ***sorted) {
+  int count = getSize(list);
+  BinaryTree *trees[TREE_ORDERS] = {kb->btName, kb->btCity, kb->btRank, kb->btReviewers, 
+      kb->btCost};
+  SortJob jobs[TREE_ORDERS];
+  pthread_t threads[TREE_ORDERS];
+  int started[TREE_ORDERS];
+  BTNode **holders[TREE_ORDERS];
+
+  if (kb->count != 0 || count == 0) { // If trees cannot be built from scratch.
+    for (int i = 0; i < count; i++) { // Add restaurants one by one.
+      addToKnowledgeBase(kb, getRestaurant(list, i));
+    }
+    return;
+  }
+
+  if (count > kb->space) { // If there is no room for all ids.
+    kb->space = count;
+    kb->restaurants = (Restaurant**)realloc(kb->restaurants, kb->space * sizeof(Restaurant*));
+  }
+  for (int id = 0; id < count; id++) { // Give out ids, index restaurants and fill columns.
+    Restaurant *restaurant = getRestaurant(list, id);
+
+    restaurant->id = id;
+    kb->restaurants[id] = restaurant;
+    indexCategories(kb->categories, restaurant);
+    indexName(kb->names, restaurant);
+    storeColumns(kb->columns, restaurant);
+  }
+  kb->count = count;
+  kb->live  = count;
+  buildHoursIndex(kb->hours, kb->restaurants, count);
+
+  for (int t = 0; t < TREE_ORDERS && sorted == NULL; t++) { // Copy and sort for every tree.
+    jobs[t].restaurants = (Restaurant**)malloc(count * sizeof(Restaurant*));
+    jobs[t].count = count;
+    jobs[t].order = trees[t]->order;
+    memcpy(jobs[t].restaurants, kb->restaurants, count * sizeof(Restaurant*));
+    started[t] = t > 0 && pthread_create(&threads[t], NULL, runSortJob, &jobs[t]) == 0;
+  }
+  for (int t = 0; t < TREE_ORDERS; t++) { // Wait for sorts and build trees.
+    if (sorted != NULL) { // If restaurants come sorted, build from them.
+      jobs[t].restaurants = sorted[t];
+    } else if (started[t]) { // If thread started, wait for it.
+      pthread_join(threads[t], NULL);
+    } else { // Sort here.
+      runSortJob(&jobs[t]);
+    }
+    holders[t] = (BTNode**)malloc(count * sizeof(BTNode*));
+    buildBinaryTree(trees[t], jobs[t].restaurants, count, holders[t]);
+    if (sorted == NULL) { // If restaurants were copied, free the copy.
+      free(jobs[t].restaurants);
+    }
+  }
+
+  for (int id = 0; id < count; id++) { // Point hash index to nodes holding the restaurants.
+    insertInHashIndex(kb->pairs, kb->restaurants[id], holders[0][id], holders[1][id]);
+  }
+  for (int t = 0; t < TREE_ORDERS; t++) { // Free nodes of every tree.
+    free(holders[t]);
+  }
+}
+
+/*
+ * Sorts restaurants described by a sort job by the key of its ordering rule.
+ *
+ * *job:   pointer to a sort job.
+ * return: NULL.
+ */
+void *runSortJob(void *job) {
+  SortJob *sortJob = (SortJob*)job;
+
+  sortRestaurants(sortJob->restaurants, sortJob->count, sortJob->order);
+  return NULL;
+}
+
+/*
+ * Removes restaurants that match by name and location from all indexing structures. Matching 
+ * restaurants are found in the hash index, which points to the nodes holding them, so trees 
+ * are only searched when a node must be removed. Nodes of the rank, reviewers and cost trees 
+ * are found by the keys of the restaurant. If nothing matches, name and city trees are asked 
+ * to remove the restaurant, so they report why it was not found.
+ *
+ * *kb:       pointer to a knowledge base.
+ * *name:     name that restaurants must match.
+ * *location: location that restaurants must match.
+ * return:    number of removed restaurants.
+ */
+int removeFromKnowledgeBase(KnowledgeBase *kb, char *name, char *location) {
+  char *city = lookupString(location);
+  HashSlot *slot = city != NULL ? searchHashIndex(kb->pairs, name, city) : NULL;
+  int removed = 0;
+
+  if (slot == NULL) { // If no restaurant matches.
+    removeBT(kb->btName, name, location);
+    removeBT(kb->btCity, name, location);
+    return 0;
+  }
+
+  while (slot != NULL) { // Remove every matching restaurant.
+    Restaurant *restaurant = slot->restaurant;
+    BTNode *nameNode = slot->nameNode;
+    BTNode *cityNode = slot->cityNode;
+
+    removeHashSlot(kb->pairs, slot);
+    unindexCategories(kb->categories, restaurant);
+    unindexHours(kb->hours, restaurant);
+    clearColumns(kb->columns, restaurant->id);
+    kb->restaurants[restaurant->id] = NULL;
+    kb->live--;
+    removed++;
+
+    removeFromBTNode(kb->btName, nameNode, restaurant);
+    removeFromBTNode(kb->btCity, cityNode, restaurant);
+    removeFromBTNode(kb->btRank, findHolder(kb->btRank, restaurant), restaurant);
+    removeFromBTNode(kb->btReviewers, findHolder(kb->btReviewers, restaurant), restaurant);
+    removeFromBTNode(kb->btCost, findHolder(kb->btCost, restaurant), restaurant);
+
+    slot = searchHashIndex(kb->pairs, name, city);
+  }
+  return removed;
+}
+
+/*
+ * Finds node of a tree holding a restaurant by the key of the restaurant.
+ *
+ * *bt:         pointer to a binary tree.
+ * *restaurant: pointer to a restaurant.
+ * return:      pointer to the node holding the restaurant, NULL if there is none.
+ */
+BTNode *findHolder(BinaryTree *bt, Restaurant *restaurant) {
+  char buffer[TREE_KEY_SIZE];
+
+  return searchBinaryTree(bt, writeTreeKey(bt->order, restaurant, buffer));
+}
+
+/*
+ * Gets tree ordered by a column: the rank, reviewers or cost tree.
+ *
+ * *kb:    pointer to a knowledge base.
+ * column: column ordering the tree.
+ * return: pointer to the tree.
+ */
+BinaryTree *columnTree(KnowledgeBase *kb, Column column) {
+  if (column == COST_COLUMN) { // If column is cost.
+    return kb->btCost;
+  } else if (column == RANK_COLUMN) { // If column is rank.
+    return kb->btRank;
+  }
+  return kb->btReviewers;
+}
+
+/*
+ * Searches for a restaurant that matches by name and location in the hash index.
+ *
+ * *kb:       pointer to a knowledge base.
+ * *name:     name that restaurant must match.
+ * *location: location that restaurant must match.
+ * return:    pointer to a matching restaurant, NULL if there is none.
+ */
+Restaurant *searchKnowledgeBase(KnowledgeBase *kb, char *name, char *location) {
+  char *city = lookupString(location);
+  HashSlot *slot = city != NULL ? searchHashIndex(kb->pairs, name, city) : NULL;
+
+  return slot != NULL ? slot->restaurant : NULL;
+}
+
+/*
+ * Gets restaurant with a given id.
+ *
+ * *kb:    pointer to a knowledge base.
+ * id:     id of a restaurant.
+ * return: pointer to a restaurant, NULL if it was removed.
+ */
+Restaurant *getById(KnowledgeBase *kb, int id) {
+  return kb->restaurants[id];
+}
+
+/*
+ * Creates an array list of all restaurants in order of their ids, skipping removed ones.
+ *
+ * *kb:    pointer to a knowledge base.
+ * return: pointer to a created array list.
+ */
+ArrayList *listRestaurants(KnowledgeBase *kb) {
+  ArrayList *list = createArrayList();
+
+  for (int id = 0; id < kb->count; id++) { // Insert every restaurant still present.
+    if (kb->restaurants[id] != NULL) { // If restaurant was not removed.
+      insert(list, kb->restaurants[id]);
+    }
+  }
+  return list;
+}
+
+/*
+ * Creates an array list of restaurants with ids from a bitmap, in order of the ids.
+ *
+ * *kb:     pointer to a knowledge base.
+ * *bitmap: pointer to a bitmap of restaurant ids.
+ * return:  pointer to a created array list.
+ */
+ArrayList *listBitmap(KnowledgeBase *kb, Bitmap *bitmap) {
+  ArrayList *result = createArrayList();
+  int *ids = (int*)malloc((bitmapCardinality(bitmap) + 1) * sizeof(int));
+  int count = extractBitmap(bitmap, ids);
+
+  for (int i = 0; i < count; i++) { // Insert restaurant of every id.
+    insert(result, kb->restaurants[ids[i]]);
+  }
+  free(ids);
+  return result;
+}
@@ -0,0 +1,151 @@
+#ifndef KNOWLEDGEBASE_H
+#define KNOWLEDGEBASE_H
+
+/*
+ * file: KnowledgeBase.h
+ * ---------------------
+ * Implements knowledge base of restaurants. Holds every indexing structure and keeps them in
+ * sync as restaurants are added and removed. Each restaurant gets an id that stays the same
+ * for as long as it is in the knowledge base.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "ArrayList.h"
+#include "BinaryTree.h"
+#include "CategoryIndex.h"
+#include "ColumnStore.h"
+#include "HashIndex.h"
+#include "HoursIndex.h"
+#include "TrigramIndex.h"
+
+typedef struct { // Define knowledge base holding restaurants and indexing structures.
+  BinaryTree *btName;
+  BinaryTree *btCity;
+  BinaryTree *btRank;      // Restaurants by rank and number of reviewers, best first.
+  BinaryTree *btReviewers; // Restaurants by number of reviewers, greatest first.
+  BinaryTree *btCost;      // Restaurants by cost, cheapest first.
+  CategoryIndex *categories;
+  TrigramIndex *names;
+  HoursIndex *hours;
+  HashIndex *pairs;
+  ColumnStore *columns;
+  Restaurant **restaurants; // Restaurants indexed by id, NULL for removed ones.
+  int count;
+  int space;
+  int live;
+} KnowledgeBase;
+
+typedef struct { // Define restaurants to be sorted by a thread.
+  Restaurant **restaurants;
+  int count;
+  TreeOrder order;
+} SortJob;
+
+/*
+ * Initialyzes an empty knowledge base.
+ *
+ * TreeBackend: data structure storing the trees (AVL or BPLUS).
+ * return:      pointer to a created knowledge base.
+ */
+extern KnowledgeBase *createKnowledgeBase(TreeBackend);
+
+/*
+ * Gives a restaurant an id and adds it to all indexing structures.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * Restaurant*:    pointer to a restaurant to add.
+ */
+extern void addToKnowledgeBase(KnowledgeBase*, Restaurant*);
+
+/*
+ * Adds many restaurants at once, building the trees bottom-up if knowledge base is empty.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * ArrayList*:     pointer to an array list of restaurants to add.
+ */
+extern void loadKnowledgeBase(KnowledgeBase*, ArrayList*);
+
+/*
+ * Adds many restaurants at once, from lists of them sorted by the rule of every tree.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * ArrayList*:     pointer to an array list of restaurants to add.
+ * Restaurant***:  TREE_ORDERS lists of the restaurants in order of every tree, NULL to sort.
+ */
+extern void loadSortedKnowledgeBase(KnowledgeBase*, ArrayList*, Restaurant***);
+
+/*
+ * Sorts restaurants described by a sort job. Runs in a separate thread.
+ *
+ * void*:  pointer to a sort job.
+ * return: NULL.
+ */
+extern void *runSortJob(void*);
+
+/*
+ * Finds node of a tree holding a restaurant.
+ *
+ * BinaryTree*: pointer to a binary tree.
+ * Restaurant*: pointer to a restaurant.
+ * return:      pointer to the node holding the restaurant, NULL if there is none.
+ */
+extern BTNode *findHolder(BinaryTree*, Restaurant*);
+
+/*
+ * Gets tree ordered by a column.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * Column:         column ordering the tree.
+ * return:         pointer to the tree.
+ */
+extern BinaryTree *columnTree(KnowledgeBase*, Column);
+
+/*
+ * Removes restaurants that match by name and location from all indexing structures.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * char*:          name that restaurants must match.
+ * char*:          location that restaurants must match.
+ * return:         number of removed restaurants.
+ */
+extern int removeFromKnowledgeBase(KnowledgeBase*, char*, char*);
+
+/*
+ * Searches for a restaurant that matches by name and location.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * char*:          name that restaurant must match.
+ * char*:          location that restaurant must match.
+ * return:         pointer to a matching restaurant, NULL if there is none.
+ */
+extern Restaurant *searchKnowledgeBase(KnowledgeBase*, char*, char*);
+
+/*
+ * Gets restaurant with a given id.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * int:            id of a restaurant.
+ * return:         pointer to a restaurant, NULL if it was removed.
+ */
+extern Restaurant *getById(KnowledgeBase*, int);
+
+/*
+ * Creates an array list of all restaurants in order of their ids.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * return:         pointer to a created array list.
+ */
+extern ArrayList *listRestaurants(KnowledgeBase*);
+
+/*
+ * Creates an array list of restaurants with ids from a bitmap, in order of the ids.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * Bitmap*:        pointer to a bitmap of restaurant ids.
+ * return:         pointer to a created array list.
+ */
+extern ArrayList *listBitmap(KnowledgeBase*, Bitmap*);
+
+#endif
@@ -12,15 +12,16 @@
 #include <stdio.h>
 #include <string.h>
 #include "LinkedList.h"
+#include "Arena.h"
 
 /*
- * Initialyzes array list. Allocates memory for the structure. Sets head and tail node 
- * pointers equal to zero.
+ * Initialyzes array list. Allocates memory for the structure from the current arena, if one is 
+ * in use. Sets head and tail node pointers equal to zero.
  * 
  * return: pointer to created linked list.
  */
 LinkedList *createLinkedList() {
-  LinkedList *linkedList = (LinkedList*)malloc(sizeof(LinkedList));
+  LinkedList *linkedList = (LinkedList*)allocate(sizeof(LinkedList));
   linkedList->head = 0;
   linkedList->tail = 0;
   linkedList->size = 0;
@@ -48,13 +49,13 @@ Node *getTail(LinkedList *linkedList) {
 }
 
 /*
- * Creates a node to store data.
+ * Creates a node to store data. Memory comes from the current arena, if one is in use.
  * 
  * *data:  data to be stored.
  * return: pointer to a node storing passed data.
  */
 Node *createNode(char *data) {
-  Node *node = (Node*)malloc(sizeof(Node));
+  Node *node = (Node*)allocate(sizeof(Node));
   
   node->next = 0;
   node->prev = 0;
@@ -165,3 +166,19 @@ char *toStringNodeData(Node *node, bool last) {
   }
   return printbuf;
 }
+
+/*
+ * Writes elements of the list to a file, separated by a comma and a space. Produces the same 
+ * text as toStringLinkedList() without building a string.
+ *
+ * *linkedList: pointer to a linked list.
+ * *file:       file to write to.
+ */
+void writeLinkedList(LinkedList *linkedList, FILE *file) {
+  for (Node *curr = linkedList->head; curr != 0; curr = curr->next) { // Iterate through nodes.
+    fputs(curr->data, file);
+    if (curr->next != 0) { // Delimit all but the last element.
+      fputs(", ", file);
+    }
+  }
+}
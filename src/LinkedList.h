@@ -12,6 +12,7 @@
  */
 
 #include <stdbool.h>
+#include <stdio.h>
 
 typedef struct Node{ // Define node structore to hold data.
   struct Node* next;
@@ -97,4 +98,12 @@ extern char *toStringLinkedList(LinkedList*);
  */
 extern char *toStringNodeData(Node*, bool);
 
+/*
+ * Writes elements of the list to a file, separated by a comma and a space.
+ *
+ * LinkedList*: pointer to a linked list.
+ * FILE*:       file to write to.
+ */
+extern void writeLinkedList(LinkedList*, FILE*);
+
 #endif
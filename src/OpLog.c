@@ -0,0 +1,482 @@
+/*
+ * file: OpLog.c
+ * -------------
+ * Implements append-only log of operations that changed the knowledge base since its base
+ * file, the text or a snapshot, was written. Every add and remove appends a small record, and
+ * on start the log is replayed on top of the base. Log names the base it applies to by size
+ * and modification time, so a log is never replayed over a base written after it.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "OpLog.h"
+#include "readFile.h"
+#include "Snapshot.h"
+#include "StringPool.h"
+
+static OpLog *currentLog = NULL; // Log that operations are appended to.
+
+/*
+ * Opens a log and replays its records on top of the base they apply to. Log of another base,
+ * one written over since, is left unread, as the base holds its operations or was replaced,
+ * and it is replaced by a new log once a record is written. Record cut short or damaged, by a
+ * crash in the middle of a write, ends the log, and it is cut off so new records follow whole
+ * ones. Log file is only created once a record is written.
+ *
+ * *fileName: name of the log file.
+ * *baseName: name of the base file the knowledge base was loaded from.
+ * *kb:       pointer to a knowledge base loaded from the base.
+ * syncEvery: written records per sync, 0 to leave syncing to the system.
+ * return:    pointer to an opened log.
+ */
+OpLog *openOpLog(char *fileName, char *baseName, KnowledgeBase *kb, int syncEvery) {
+  OpLog *log = (OpLog*)malloc(sizeof(OpLog));
+  int descriptor = open(fileName, O_RDWR | O_APPEND);
+  size_t size;
+  size_t valid;
+  char *text;
+
+  log->fileName   = (char*)malloc(strlen(fileName) + 1);
+  log->descriptor = -1;
+  log->pending    = (char*)malloc(OPLOG_BUFFER);
+  log->used       = 0;
+  log->space      = OPLOG_BUFFER;
+  log->records    = 0;
+  log->syncEvery  = syncEvery;
+  log->unsynced   = 0;
+  strcpy(log->fileName, fileName);
+  describeBase(baseName, &log->header);
+
+  if (descriptor == -1) { // If there is no log yet.
+    return log;
+  }
+  text = readWhole(descriptor, &size);
+  if (size < sizeof(LogHeader)
+      || memcmp(text, &log->header, sizeof(LogHeader)) != 0) { // If log is of another base.
+    fprintf(stderr, "Log %s is not of base %s, starting a new one.\n", fileName, baseName);
+    close(descriptor);
+    free(text);
+    return log;
+  }
+
+  valid = sizeof(LogHeader) + replayOpLog(text + sizeof(LogHeader), size - sizeof(LogHeader),
+      kb);
+  if (valid < size) { // If log ends with a partial record, cut it off.
+    fprintf(stderr, "Log %s ends with %zu bytes of a partial record, dropped.\n", fileName,
+        size - valid);
+    if (ftruncate(descriptor, valid) == -1) { // If log cannot be cut, start a new one on write.
+      close(descriptor);
+      descriptor = -1;
+    }
+  }
+  log->descriptor = descriptor;
+  free(text);
+
+  return log;
+}
+
+/*
+ * Commits pending records, syncs the log if records were written since the last sync, and
+ * frees the log.
+ *
+ * *log: pointer to a log.
+ */
+void closeOpLog(OpLog *log) {
+  commitOpLog(log);
+  if (currentLog == log) { // If log is in use, stop appending to it.
+    currentLog = NULL;
+  }
+  if (log->descriptor != -1) { // If log file is open, sync and close it.
+    if (log->unsynced > 0) { // If written records are not synced.
+      fdatasync(log->descriptor);
+    }
+    close(log->descriptor);
+  }
+  free(log->fileName);
+  free(log->pending);
+  free(log);
+}
+
+/*
+ * Sets log that operations are appended to.
+ *
+ * *log: pointer to a log, NULL to log nothing.
+ */
+void useOpLog(OpLog *log) {
+  currentLog = log;
+}
+
+/*
+ * Appends a record of an added restaurant to the current log: its rank, number of reviewers
+ * and number of categories, followed by its name, city, opening hours, cost and categories,
+ * each one ending with a zero byte. Opening hours are written as they are read, so replay
+ * reads the same intervals.
+ *
+ * *restaurant: pointer to the added restaurant.
+ */
+void logAdd(Restaurant *restaurant) {
+  size_t start = currentLog != NULL ? currentLog->used : 0;
+  OpHeader header = {0, 0};
+  unsigned char kind = OP_ADD;
+  int32_t reviewers = restaurant->reviewers;
+  uint32_t categories = restaurant->categories->size;
+  char *hours;
+
+  if (currentLog == NULL) { // If no log is in use.
+    return;
+  }
+  hours = toStringHours(&restaurant->hours);
+  appendBytes(currentLog, &header, sizeof(OpHeader));
+  appendBytes(currentLog, &kind, 1);
+  appendBytes(currentLog, &restaurant->rank, sizeof(float));
+  appendBytes(currentLog, &reviewers, sizeof(int32_t));
+  appendBytes(currentLog, &categories, sizeof(uint32_t));
+  appendBytes(currentLog, restaurant->name, strlen(restaurant->name) + 1);
+  appendBytes(currentLog, restaurant->city, strlen(restaurant->city) + 1);
+  appendBytes(currentLog, hours, strlen(hours) + 1);
+  appendBytes(currentLog, restaurant->cost, strlen(restaurant->cost) + 1);
+  for (Node *node = restaurant->categories->head; node != NULL; node = node->next) { // Add.
+    appendBytes(currentLog, node->data, strlen(node->data) + 1);
+  }
+  endRecord(currentLog, start);
+  free(hours);
+}
+
+/*
+ * Appends a record of a remove to the current log: name and location, each one ending with a
+ * zero byte. Only removes that found restaurants are logged, so replay finds them as well.
+ *
+ * *name:     name of removed restaurants.
+ * *location: location of removed restaurants.
+ */
+void logRemove(char *name, char *location) {
+  size_t start = currentLog != NULL ? currentLog->used : 0;
+  OpHeader header = {0, 0};
+  unsigned char kind = OP_REMOVE;
+
+  if (currentLog == NULL) { // If no log is in use.
+    return;
+  }
+  appendBytes(currentLog, &header, sizeof(OpHeader));
+  appendBytes(currentLog, &kind, 1);
+  appendBytes(currentLog, name, strlen(name) + 1);
+  appendBytes(currentLog, location, strlen(location) + 1);
+  endRecord(currentLog, start);
+}
+
+/*
+ * Writes records pending in the current log, see commitOpLog().
+ *
+ * return: 0 upon successful execution, -1 if records could not be written.
+ */
+int commitLog() {
+  return currentLog != NULL ? commitOpLog(currentLog) : 0;
+}
+
+/*
+ * Writes records pending in a log with one write, a group commit of everything appended 
+ * since the last one. Written records are synced once syncEvery of them are, so a sync is 
+ * shared by a batch of edits; records written but not synced survive the program failing, 
+ * though not the system. Log file is replaced by a new log of the current base when the first
+ * record is written. Failed write is cut off back to the end of the last commit, as records
+ * after a torn one are not replayed; if it cannot be cut, the log is started again.
+ *
+ * *log:   pointer to a log.
+ * return: 0 upon successful execution, -1 if records could not be written.
+ */
+int commitOpLog(OpLog *log) {
+  size_t written = 0;
+  off_t end;
+
+  if (log->records == 0) { // If there is nothing to write.
+    return 0;
+  }
+  if (log->descriptor == -1 && startOpLog(log) != 0) { // If log file cannot be started.
+    log->used    = 0;
+    log->records = 0;
+    return -1;
+  }
+
+  end = lseek(log->descriptor, 0, SEEK_END);
+  while (written < log->used) { // Write pending records, as many times as write takes.
+    ssize_t bytes = write(log->descriptor, log->pending + written, log->used - written);
+
+    if (bytes <= 0) { // If write failed.
+      printf("Could not write log %s.\n", log->fileName);
+      break;
+    }
+    written += bytes;
+  }
+  if (written < log->used) { // If records were not written, drop them.
+    if (end == -1 || ftruncate(log->descriptor, end) != 0) { // If torn bytes stay, start again.
+      close(log->descriptor);
+      log->descriptor = -1;
+    }
+    log->used    = 0;
+    log->records = 0;
+    return -1;
+  }
+  log->unsynced += log->records;
+  log->used      = 0;
+  log->records   = 0;
+  if (log->syncEvery > 0 && log->unsynced >= log->syncEvery) { // If batch is full, sync it.
+    fdatasync(log->descriptor);
+    log->unsynced = 0;
+  }
+  return 0;
+}
+
+/*
+ * Folds the current log into a new base: saves a snapshot, which holds every logged
+ * operation, and starts an empty log naming the snapshot as its base. Snapshot replaces the
+ * old base before the log is replaced, so if the program stops in between, the old log no
+ * longer names a base and is not replayed. With no log in use, only the snapshot is saved.
+ *
+ * *kb:    pointer to a knowledge base.
+ * return: 0 upon successful execution, -1 if snapshot or log could not be written.
+ */
+int compactLog(KnowledgeBase *kb) {
+  OpLog *log = currentLog;
+
+  commitLog();
+  if (saveSnapshot(SNAPSHOT_FILE, kb) != 0) { // If snapshot could not be written.
+    return -1;
+  }
+  if (log == NULL) { // If no log is in use.
+    return 0;
+  }
+  return rebaseOpLog(log, SNAPSHOT_FILE);
+}
+
+/*
+ * Starts an empty log on a file written with every restaurant of the knowledge base, if it
+ * is the base that is loaded on the next start: the snapshot while it is newer than the text,
+ * the text otherwise. Without it, records appended after the file was written would name the
+ * old base and be dropped on the next start. File is compared by identity, not by name, so
+ * any path to the base is recognized.
+ *
+ * *fileName: name of the written file.
+ * return:    0 upon successful execution, -1 if log could not be written.
+ */
+int rebaseLog(char *fileName) {
+  char *nextBase = isSnapshotNewer(SNAPSHOT_FILE, TEXT_FILE) ? SNAPSHOT_FILE : TEXT_FILE;
+  struct stat written;
+  struct stat base;
+
+  if (currentLog == NULL) { // If no log is in use.
+    return 0;
+  }
+  if (stat(fileName, &written) != 0 || stat(nextBase, &base) != 0
+      || written.st_dev != base.st_dev || written.st_ino != base.st_ino) { // If not the base.
+    return 0;
+  }
+  commitLog();
+  return rebaseOpLog(currentLog, nextBase);
+}
+
+/*
+ * Replaces a log with an empty one naming a new base that holds all of its operations.
+ *
+ * *log:      pointer to a log.
+ * *baseName: name of the new base file.
+ * return:    0 upon successful execution, -1 if log could not be written.
+ */
+int rebaseOpLog(OpLog *log, char *baseName) {
+  describeBase(baseName, &log->header);
+  if (log->descriptor != -1) { // If old log is open, close it.
+    close(log->descriptor);
+    log->descriptor = -1;
+  }
+  log->unsynced = 0;
+  return startOpLog(log);
+}
+
+/*
+ * Replaces a log file with an empty log naming its current base. New log is written to a
+ * temporary file, synced and renamed over the old one, so the log file is always whole.
+ *
+ * *log:   pointer to a log.
+ * return: 0 upon successful execution, -1 if log could not be written.
+ */
+int startOpLog(OpLog *log) {
+  char *temporary = (char*)malloc(strlen(log->fileName) + 5);
+  int descriptor;
+  int failed;
+
+  sprintf(temporary, "%s.tmp", log->fileName);
+  descriptor = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  failed = descriptor == -1 || write(descriptor, &log->header, sizeof(LogHeader))
+      != sizeof(LogHeader) || fsync(descriptor) != 0;
+  if (descriptor != -1) { // If temporary file was created, close it.
+    close(descriptor);
+  }
+  failed = failed || rename(temporary, log->fileName) != 0;
+  log->descriptor = failed ? -1 : open(log->fileName, O_WRONLY | O_APPEND);
+  if (failed || log->descriptor == -1) { // If log could not be started.
+    printf("Could not write log %s.\n", log->fileName);
+    unlink(temporary);
+    failed = 1;
+  }
+  free(temporary);
+
+  return failed ? -1 : 0;
+}
+
+/*
+ * Fills header of a log with the magic, version and identity of a base file, its size and
+ * modification time. Base file is replaced as a whole or written again when it changes, so
+ * its identity changes as well.
+ *
+ * *baseName: name of the base file.
+ * *header:   pointer to a header to fill.
+ */
+void describeBase(char *baseName, LogHeader *header) {
+  struct stat status;
+
+  memset(header, 0, sizeof(LogHeader));
+  memcpy(header->magic, OPLOG_MAGIC, sizeof(header->magic));
+  header->version  = OPLOG_VERSION;
+  header->baseSize = -1;
+  if (stat(baseName, &status) == 0) { // If base exists, name it by size and time.
+    header->baseSize        = status.st_size;
+    header->baseSeconds     = status.st_mtim.tv_sec;
+    header->baseNanoseconds = status.st_mtim.tv_nsec;
+  }
+  header->checksum = hashBytes((char*)&header->baseSize, 3 * sizeof(int64_t));
+}
+
+/*
+ * Replays records of a log on a knowledge base in order, up to the first one cut short,
+ * damaged or not reading as an operation.
+ *
+ * *text:  first byte after the header of the log.
+ * size:   number of bytes.
+ * *kb:    pointer to a knowledge base.
+ * return: number of bytes of whole records that were replayed.
+ */
+size_t replayOpLog(char *text, size_t size, KnowledgeBase *kb) {
+  size_t done = 0;
+
+  while (size - done >= sizeof(OpHeader)) { // Replay records while a header is left.
+    OpHeader header;
+
+    memcpy(&header, text + done, sizeof(OpHeader));
+    if (header.size > size - done - sizeof(OpHeader)
+        || hashBytes(text + done + sizeof(OpHeader), header.size) != header.checksum
+        || replayRecord(text + done + sizeof(OpHeader), header.size, kb) != 0) { // If bad.
+      break;
+    }
+    done += sizeof(OpHeader) + header.size;
+  }
+  return done;
+}
+
+/*
+ * Applies one record to a knowledge base: adds a restaurant or removes matching ones.
+ *
+ * *record: first byte of the record after its header.
+ * size:    number of bytes.
+ * *kb:     pointer to a knowledge base.
+ * return:  0 if record was applied, -1 if it does not read as an operation.
+ */
+int replayRecord(char *record, size_t size, KnowledgeBase *kb) {
+  char *end = record + size;
+  char *cursor = record + 1;
+  float rank;
+  int32_t reviewers;
+  uint32_t count;
+  char *fields[4];
+  LinkedList *categories;
+
+  if (size >= 3 && record[0] == OP_REMOVE) { // If record is a remove.
+    fields[0] = readField(&cursor, end);
+    fields[1] = fields[0] != NULL ? readField(&cursor, end) : NULL;
+    if (fields[1] == NULL) { // If a field is cut short.
+      return -1;
+    }
+    removeFromKnowledgeBase(kb, fields[0], fields[1]);
+    return 0;
+  }
+  if (size < 13 || record[0] != OP_ADD) { // If record is neither an add nor a remove.
+    return -1;
+  }
+
+  memcpy(&rank, cursor, sizeof(float));
+  memcpy(&reviewers, cursor + 4, sizeof(int32_t));
+  memcpy(&count, cursor + 8, sizeof(uint32_t));
+  cursor += 12;
+  for (int f = 0; f < 4; f++) { // Read name, city, hours and cost.
+    fields[f] = readField(&cursor, end);
+    if (fields[f] == NULL) { // If a field is cut short.
+      return -1;
+    }
+  }
+  categories = createLinkedList();
+  for (uint32_t c = 0; c < count; c++) { // Read every category.
+    char *category = readField(&cursor, end);
+
+    if (category == NULL) { // If a category is cut short.
+      return -1;
+    }
+    insertInLinkedList(categories, internString(category));
+  }
+  addToKnowledgeBase(kb, initRestaurant(fields[0], fields[1], categories, fields[2],
+      fields[3], rank, reviewers));
+  return 0;
+}
+
+/*
+ * Reads a string ending with a zero byte from a record.
+ *
+ * **cursor: pointer to the next byte of the record, moved past the string.
+ * *end:     byte past the record.
+ * return:   the string, NULL if record ends before its zero byte.
+ */
+char *readField(char **cursor, char *end) {
+  char *field = *cursor;
+  char *zero = (char*)memchr(field, 0, end - field);
+
+  if (zero == NULL) { // If string does not end inside the record.
+    return NULL;
+  }
+  *cursor = zero + 1;
+  return field;
+}
+
+/*
+ * Appends bytes to the pending records of a log, doubling the buffer when they do not fit.
+ *
+ * *log:   pointer to a log.
+ * *bytes: bytes to append.
+ * size:   number of bytes.
+ */
+void appendBytes(OpLog *log, void *bytes, size_t size) {
+  while (log->used + size > log->space) { // If bytes do not fit, grow the buffer.
+    log->space  *= 2;
+    log->pending = (char*)realloc(log->pending, log->space);
+  }
+  memcpy(log->pending + log->used, bytes, size);
+  log->used += size;
+}
+
+/*
+ * Fills the header of the last pending record with its size and checksum.
+ *
+ * *log:  pointer to a log.
+ * start: offset of the header of the record in the pending bytes.
+ */
+void endRecord(OpLog *log, size_t start) {
+  OpHeader header;
+
+  header.size     = log->used - start - sizeof(OpHeader);
+  header.checksum = hashBytes(log->pending + start + sizeof(OpHeader), header.size);
+  memcpy(log->pending + start, &header, sizeof(OpHeader));
+  log->records++;
+}
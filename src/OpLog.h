@@ -0,0 +1,197 @@
+#ifndef OPLOG_H
+#define OPLOG_H
+
+/*
+ * file: OpLog.h
+ * -------------
+ * Implements append-only log of operations that changed the knowledge base since its base
+ * file, the text or a snapshot, was written. Every add and remove appends a small record, and
+ * on start the log is replayed on top of the base. Log names the base it applies to by size
+ * and modification time, so a log is never replayed over a base written after it.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "KnowledgeBase.h"
+
+#define OPLOG_FILE    "restaurants.log" // Log replayed on top of the base on start.
+#define OPLOG_MAGIC   "YELPOLOG"        // First bytes of every log.
+#define OPLOG_VERSION 1                 // Version of the layout, raised on changes.
+#define OPLOG_BUFFER  4096              // Bytes of records buffered at first.
+
+typedef enum { // Define kinds of logged operations.
+  OP_ADD = 1, OP_REMOVE = 2
+} OpKind;
+
+typedef struct { // Define header at the start of a log, naming the base it applies to.
+  char magic[8];
+  uint32_t version;
+  uint32_t checksum;       // Checksum of the base fields.
+  int64_t baseSize;        // Size of the base file in bytes, -1 if there is none.
+  int64_t baseSeconds;     // Modification time of the base file.
+  int64_t baseNanoseconds;
+} LogHeader;
+
+typedef struct { // Define header in front of every record.
+  uint32_t size;     // Bytes of the record after the header.
+  uint32_t checksum; // Checksum of the bytes after the header.
+} OpHeader;
+
+typedef struct { // Define log of operations and records not written to it yet.
+  char *fileName;
+  int descriptor;   // Log open for appending, -1 until a record is written.
+  LogHeader header; // Header naming the current base.
+  char *pending;    // Records appended since the last commit.
+  size_t used;
+  size_t space;
+  int records;      // Number of pending records.
+  int syncEvery;    // Written records per sync, 0 to leave syncing to the system.
+  int unsynced;     // Written records not synced yet.
+} OpLog;
+
+/*
+ * Opens a log and replays its records on top of the base they apply to.
+ *
+ * char*:          name of the log file.
+ * char*:          name of the base file the knowledge base was loaded from.
+ * KnowledgeBase*: pointer to a knowledge base loaded from the base.
+ * int:            written records per sync, 0 to leave syncing to the system.
+ * return:         pointer to an opened log.
+ */
+extern OpLog *openOpLog(char*, char*, KnowledgeBase*, int);
+
+/*
+ * Commits pending records, syncs the log and frees it.
+ *
+ * OpLog*: pointer to a log.
+ */
+extern void closeOpLog(OpLog*);
+
+/*
+ * Sets log that operations are appended to.
+ *
+ * OpLog*: pointer to a log, NULL to log nothing.
+ */
+extern void useOpLog(OpLog*);
+
+/*
+ * Appends a record of an added restaurant to the current log.
+ *
+ * Restaurant*: pointer to the added restaurant.
+ */
+extern void logAdd(Restaurant*);
+
+/*
+ * Appends a record of a remove to the current log.
+ *
+ * char*: name of removed restaurants.
+ * char*: location of removed restaurants.
+ */
+extern void logRemove(char*, char*);
+
+/*
+ * Writes records pending in the current log.
+ *
+ * return: 0 upon successful execution, -1 if records could not be written.
+ */
+extern int commitLog();
+
+/*
+ * Writes records pending in a log with one write, syncing it once enough are written.
+ *
+ * OpLog*: pointer to a log.
+ * return: 0 upon successful execution, -1 if records could not be written.
+ */
+extern int commitOpLog(OpLog*);
+
+/*
+ * Folds the current log into a new base: saves a snapshot and starts an empty log on it.
+ *
+ * KnowledgeBase*: pointer to a knowledge base.
+ * return:         0 upon successful execution, -1 if snapshot or log could not be written.
+ */
+extern int compactLog(KnowledgeBase*);
+
+/*
+ * Starts an empty log on a file written with every restaurant, if it is the next base.
+ *
+ * char*:  name of the written file.
+ * return: 0 upon successful execution, -1 if log could not be written.
+ */
+extern int rebaseLog(char*);
+
+/*
+ * Replaces a log with an empty one naming a new base that holds all of its operations.
+ *
+ * OpLog*: pointer to a log.
+ * char*:  name of the new base file.
+ * return: 0 upon successful execution, -1 if log could not be written.
+ */
+extern int rebaseOpLog(OpLog*, char*);
+
+/*
+ * Replaces a log file with an empty log naming its current base.
+ *
+ * OpLog*: pointer to a log.
+ * return: 0 upon successful execution, -1 if log could not be written.
+ */
+extern int startOpLog(OpLog*);
+
+/*
+ * Fills header of a log with the magic, version and identity of a base file.
+ *
+ * char*:      name of the base file.
+ * LogHeader*: pointer to a header to fill.
+ */
+extern void describeBase(char*, LogHeader*);
+
+/*
+ * Replays records of a log on a knowledge base, up to the first one cut short or damaged.
+ *
+ * char*:          first byte after the header of the log.
+ * size_t:         number of bytes.
+ * KnowledgeBase*: pointer to a knowledge base.
+ * return:         number of bytes of whole records that were replayed.
+ */
+extern size_t replayOpLog(char*, size_t, KnowledgeBase*);
+
+/*
+ * Applies one record to a knowledge base.
+ *
+ * char*:          first byte of the record after its header.
+ * size_t:         number of bytes.
+ * KnowledgeBase*: pointer to a knowledge base.
+ * return:         0 if record was applied, -1 if it does not read as an operation.
+ */
+extern int replayRecord(char*, size_t, KnowledgeBase*);
+
+/*
+ * Reads a string ending with a zero byte from a record.
+ *
+ * char**: pointer to the next byte of the record, moved past the string.
+ * char*:  byte past the record.
+ * return: the string, NULL if record ends before its zero byte.
+ */
+extern char *readField(char**, char*);
+
+/*
+ * Appends bytes to the pending records of a log.
+ *
+ * OpLog*: pointer to a log.
+ * void*:  bytes to append.
+ * size_t: number of bytes.
+ */
+extern void appendBytes(OpLog*, void*, size_t);
+
+/*
+ * Fills the header of the last pending record, started at an offset.
+ *
+ * OpLog*: pointer to a log.
+ * size_t: offset of the header of the record in the pending bytes.
+ */
+extern void endRecord(OpLog*, size_t);
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * file: OpeningHours.c
+ * --------------------
+ * Implements opening hours of a restaurant as a list of intervals, each one opening on a day
+ * of the week and closing on the same or the next day. Times are minutes, and a moment of the
+ * week is minutes after Monday midnight. Week is also split into slots of SLOT_MINUTES, which
+ * the hours index uses. Functionality includes reading, writing and testing opening hours.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "OpeningHours.h"
+#include "Arena.h"
+
+static char *days[7] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+    "Sunday"};
+
+/*
+ * Reads opening hours from a string like "Monday 11:00 22:00, Friday 17:00 2:00". Intervals
+ * that do not read as a day and two times are skipped, so written hours hold only the valid
+ * ones, and reading them again gives the same hours. Closing time not later than opening
+ * time is on the next day, so "0:00 0:00" is open all day. Intervals come from the current
+ * arena, if one is in use.
+ *
+ * *text:  comma-separated intervals, each one a day, an opening and a closing time.
+ * *hours: pointer to opening hours to fill.
+ */
+void parseHours(char *text, OpeningHours *hours) {
+  int space = 1;
+
+  for (char *c = text; *c != 0; c++) { // Count intervals by commas.
+    space += *c == ',';
+  }
+  hours->intervals = (OpenInterval*)allocate(space * sizeof(OpenInterval));
+  hours->count     = 0;
+
+  while (*text != 0) { // Read every interval.
+    int day;
+    int open;
+    int close;
+    char *end = parseDay(text, &day);
+
+    end = end == NULL ? NULL : parseTime(end, &open);
+    end = end == NULL ? NULL : parseTime(end, &close);
+    if (end != NULL) { // If interval was read, skip trailing spaces.
+      end = skipBlanks(end);
+    }
+    if (end != NULL && (*end == ',' || *end == 0) && open < DAY_MINUTES) { // If valid.
+      OpenInterval *interval = &hours->intervals[hours->count++];
+
+      interval->day   = (unsigned char)day;
+      interval->open  = (unsigned short)open;
+      interval->close = (unsigned short)close;
+    }
+    text += strcspn(text, ",");
+    text += *text == ',';
+  }
+}
+
+/*
+ * Creates a string of opening hours in the form they are read in, intervals separated by 
+ * commas and times written as hours and two-digit minutes.
+ *
+ * *hours: pointer to opening hours.
+ * return: string of the opening hours.
+ */
+char *toStringHours(OpeningHours *hours) {
+  char *printbuf = (char*)malloc(INTERVAL_TEXT * hours->count + 1);
+  int length = 0;
+
+  printbuf[0] = 0;
+  for (int i = 0; i < hours->count; i++) { // Add every interval.
+    length += sprintf(printbuf + length, "%s", i > 0 ? ", " : "");
+    length += formatInterval(&hours->intervals[i], printbuf + length);
+  }
+  return printbuf;
+}
+
+/*
+ * Writes opening hours to a file. Produces the same text as toStringHours() without building 
+ * a string.
+ *
+ * *hours: pointer to opening hours.
+ * *file:  file to write to.
+ */
+void writeHours(OpeningHours *hours, FILE *file) {
+  char text[INTERVAL_TEXT];
+
+  for (int i = 0; i < hours->count; i++) { // Write every interval.
+    formatInterval(&hours->intervals[i], text);
+    fputs(i > 0 ? ", " : "", file);
+    fputs(text, file);
+  }
+}
+
+/*
+ * Writes one interval to a string as it is read in, a day followed by the opening and the
+ * closing time. Writer puts intervals of every restaurant, so digits are written by hand 
+ * rather than by sprintf(), which parses its format on every call.
+ *
+ * *interval: pointer to an interval.
+ * *text:     INTERVAL_TEXT bytes to write to.
+ * return:    number of written bytes, not counting the zero byte.
+ */
+int formatInterval(OpenInterval *interval, char *text) {
+  int length = strlen(days[interval->day]);
+
+  memcpy(text, days[interval->day], length);
+  text[length++] = ' ';
+  length += formatTime(interval->open, text + length);
+  text[length++] = ' ';
+  length += formatTime(interval->close, text + length);
+  text[length] = 0;
+
+  return length;
+}
+
+/*
+ * Writes a time of the day as hours and two-digit minutes, like "9:30" or "24:00".
+ *
+ * time:   minutes after midnight, at most DAY_MINUTES.
+ * *text:  bytes to write to, at least 5.
+ * return: number of written bytes.
+ */
+int formatTime(int time, char *text) {
+  int hour   = time / 60;
+  int length = 0;
+
+  if (hour >= 10) { // If hour takes two digits.
+    text[length++] = '0' + hour / 10;
+  }
+  text[length++] = '0' + hour % 10;
+  text[length++] = ':';
+  text[length++] = '0' + time % 60 / 10;
+  text[length++] = '0' + time % 10;
+
+  return length;
+}
+
+/*
+ * Reads a moment of the week from a string like "Friday 22:00". Spaces and tabs around the
+ * day and the time are skipped, and time must be before midnight.
+ *
+ * *text:  string to read from.
+ * return: minutes after Monday midnight, -1 if string is invalid.
+ */
+int parseMoment(char *text) {
+  int day;
+  int time;
+
+  text = parseDay(text, &day);
+  text = text == NULL ? NULL : parseTime(text, &time);
+  if (text == NULL || *skipBlanks(text) != 0 || time >= DAY_MINUTES) { // If invalid.
+    return -1;
+  }
+  return day * DAY_MINUTES + time;
+}
+
+/*
+ * Reads a day of the week from the front of a string. Spaces and tabs in front of the day
+ * are skipped. Day is told by its first three letters, ignoring case, and the rest of the word
+ * is skipped, so "fri" and "Friday" are the same day. Setting the case bit turns a letter 
+ * lowercase and no other byte into one, so letters are compared without strncasecmp().
+ *
+ * *text:  string to read from.
+ * *day:   pointer to the read day, 0 for Monday.
+ * return: pointer past the day, NULL if string does not start with one.
+ */
+char *parseDay(char *text, int *day) {
+  text = skipBlanks(text);
+  for (int d = 0; d < 7; d++) { // Compare first letters of every day.
+    if ((text[0] | 32) == (days[d][0] | 32) && (text[1] | 32) == days[d][1]
+        && (text[2] | 32) == days[d][2]) { // If day matches, ignoring case of letters.
+      *day = d;
+      text += 3;
+      while (isalpha((unsigned char)*text)) { // Skip rest of the word.
+        text++;
+      }
+      return text;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Reads a time of the day like "9:30" or "09:30" from the front of a string. Spaces and tabs
+ * in front of the time are skipped. Time may be "24:00", the end of the day, but not later.
+ *
+ * *text:  string to read from.
+ * *time:  pointer to the read time in minutes after midnight.
+ * return: pointer past the time, NULL if string does not start with one.
+ */
+char *parseTime(char *text, int *time) {
+  int digits;
+  int hour;
+  int minute;
+
+  text   = skipBlanks(text);
+  digits = isDigit(text[0]) + (isDigit(text[0]) && isDigit(text[1]));
+  if (digits < 1 || text[digits] != ':' || !isDigit(text[digits + 1])
+      || !isDigit(text[digits + 2]) || isDigit(text[digits + 3])) { // If not "h:mm" or "hh:mm".
+    return NULL;
+  }
+  hour   = digits == 1 ? text[0] - '0' : (text[0] - '0') * 10 + text[1] - '0';
+  minute = (text[digits + 1] - '0') * 10 + text[digits + 2] - '0';
+  if (minute >= 60 || hour * 60 + minute > DAY_MINUTES) { // If time is out of the day.
+    return NULL;
+  }
+  *time = hour * 60 + minute;
+  return text + digits + 3;
+}
+
+/*
+ * Skips spaces and tabs. Loader reads hours of every restaurant, so blanks are skipped by a 
+ * loop rather than by strspn(), which builds a table of the skipped bytes on every call.
+ *
+ * *text:  string to skip blanks of.
+ * return: pointer to the first byte that is not a blank.
+ */
+char *skipBlanks(char *text) {
+  while (*text == ' ' || *text == '\t') { // Skip every blank.
+    text++;
+  }
+  return text;
+}
+
+/*
+ * Checks whether a byte is a decimal digit, regardless of locale.
+ *
+ * c:      byte to check.
+ * return: 1 if byte is a digit, 0 otherwise.
+ */
+int isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+/*
+ * Checks whether a restaurant is open at a moment of the week. Interval holds the moment if
+ * the moment is less than its length after its opening, counting around the end of the week.
+ *
+ * *hours: pointer to opening hours.
+ * moment: minutes after Monday midnight.
+ * return: 1 if restaurant is open, 0 otherwise.
+ */
+int isOpenAt(OpeningHours *hours, int moment) {
+  for (int i = 0; i < hours->count; i++) { // Check every interval.
+    OpenInterval *interval = &hours->intervals[i];
+    int start  = interval->day * DAY_MINUTES + interval->open;
+    int length = interval->close > interval->open ? interval->close - interval->open
+        : interval->close + DAY_MINUTES - interval->open;
+
+    if ((moment - start + WEEK_MINUTES) % WEEK_MINUTES < length) { // If interval holds it.
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Marks slots of the week in which a restaurant is open. Slot is whole if an interval holds 
+ * all of it, and part if intervals hold only some of it, which only happens to slots where 
+ * an interval opens or closes between slot bounds. Whole slots of an interval are a run, 
+ * marked a word at a time.
+ *
+ * *hours: pointer to opening hours.
+ * *whole: SLOT_WORDS words marking slots the restaurant is open through.
+ * *part:  SLOT_WORDS words marking slots the restaurant is open in a part of only.
+ */
+void markSlots(OpeningHours *hours, uint64_t *whole, uint64_t *part) {
+  memset(whole, 0, SLOT_WORDS * sizeof(uint64_t));
+  memset(part, 0, SLOT_WORDS * sizeof(uint64_t));
+
+  for (int i = 0; i < hours->count; i++) { // Mark slots of every interval.
+    OpenInterval *interval = &hours->intervals[i];
+    int start = interval->day * DAY_MINUTES + interval->open;
+    int end   = start + (interval->close > interval->open ? interval->close - interval->open
+        : interval->close + DAY_MINUTES - interval->open);
+
+    markRun(whole, (start + SLOT_MINUTES - 1) / SLOT_MINUTES, end / SLOT_MINUTES);
+    if (start % SLOT_MINUTES != 0) { // If interval opens inside a slot.
+      markRun(part, start / SLOT_MINUTES, start / SLOT_MINUTES + 1);
+    }
+    if (end % SLOT_MINUTES != 0) { // If interval closes inside a slot.
+      markRun(part, end / SLOT_MINUTES, end / SLOT_MINUTES + 1);
+    }
+  }
+  for (int w = 0; w < SLOT_WORDS; w++) { // Drop part slots another interval holds whole.
+    part[w] &= ~whole[w];
+  }
+}
+
+/*
+ * Marks a run of slots, going on from the start of the week past its end.
+ *
+ * *words: SLOT_WORDS words marking slots.
+ * from:   first slot of the run.
+ * to:     slot past the run, at most a week after the first one.
+ */
+void markRun(uint64_t *words, int from, int to) {
+  while (from < to) { // Mark slots word by word.
+    int slot = from % WEEK_SLOTS;
+    int bits = 64 - (slot & 63);
+
+    bits = bits < to - from ? bits : to - from;
+    bits = bits < WEEK_SLOTS - slot ? bits : WEEK_SLOTS - slot;
+    words[slot >> 6] |= (bits == 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1) << (slot & 63);
+    from += bits;
+  }
+}
@@ -0,0 +1,148 @@
+#ifndef OPENINGHOURS_H
+#define OPENINGHOURS_H
+
+/*
+ * file: OpeningHours.h
+ * --------------------
+ * Implements opening hours of a restaurant as a list of intervals, each one opening on a day
+ * of the week and closing on the same or the next day. Times are minutes, and a moment of the
+ * week is minutes after Monday midnight. Week is also split into slots of SLOT_MINUTES, which
+ * the hours index uses. Functionality includes reading, writing and testing opening hours.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define DAY_MINUTES   1440                          // Minutes in a day.
+#define WEEK_MINUTES  (7 * DAY_MINUTES)             // Minutes in a week.
+#define SLOT_MINUTES  15                            // Minutes in a slot of the week.
+#define WEEK_SLOTS    (WEEK_MINUTES / SLOT_MINUTES) // Slots in a week.
+#define SLOT_WORDS    ((WEEK_SLOTS + 63) / 64)      // 64-bit words holding a bit per slot.
+#define INTERVAL_TEXT 32                            // Bytes of a written interval, at most.
+
+typedef struct { // Define time a restaurant is open from a day of the week.
+  unsigned char day;    // Day of the week it opens, 0 for Monday.
+  unsigned short open;  // Minutes after midnight when it opens.
+  unsigned short close; // Minutes after midnight when it closes, on the next day if not later.
+} OpenInterval;
+
+typedef struct { // Define opening hours as intervals in the order they were read.
+  OpenInterval *intervals;
+  int count;
+} OpeningHours;
+
+/*
+ * Reads opening hours from a string.
+ *
+ * char*:         comma-separated intervals, each one a day, an opening and a closing time.
+ * OpeningHours*: pointer to opening hours to fill.
+ */
+extern void parseHours(char*, OpeningHours*);
+
+/*
+ * Creates a string of opening hours in the form they are read in.
+ *
+ * OpeningHours*: pointer to opening hours.
+ * return:        string of the opening hours.
+ */
+extern char *toStringHours(OpeningHours*);
+
+/*
+ * Writes opening hours to a file in the form they are read in.
+ *
+ * OpeningHours*: pointer to opening hours.
+ * FILE*:         file to write to.
+ */
+extern void writeHours(OpeningHours*, FILE*);
+
+/*
+ * Writes one interval to a string as it is read in.
+ *
+ * OpenInterval*: pointer to an interval.
+ * char*:         INTERVAL_TEXT bytes to write to.
+ * return:        number of written bytes, not counting the zero byte.
+ */
+extern int formatInterval(OpenInterval*, char*);
+
+/*
+ * Writes a time of the day as hours and two-digit minutes.
+ *
+ * int:    minutes after midnight, at most DAY_MINUTES.
+ * char*:  bytes to write to, at least 5.
+ * return: number of written bytes.
+ */
+extern int formatTime(int, char*);
+
+/*
+ * Reads a moment of the week, a day and a time, from a string.
+ *
+ * char*:  string to read from.
+ * return: minutes after Monday midnight, -1 if string is invalid.
+ */
+extern int parseMoment(char*);
+
+/*
+ * Reads a day of the week from the front of a string.
+ *
+ * char*:  string to read from.
+ * int*:   pointer to the read day, 0 for Monday.
+ * return: pointer past the day, NULL if string does not start with one.
+ */
+extern char *parseDay(char*, int*);
+
+/*
+ * Reads a time of the day from the front of a string.
+ *
+ * char*:  string to read from.
+ * int*:   pointer to the read time in minutes after midnight, at most DAY_MINUTES.
+ * return: pointer past the time, NULL if string does not start with one.
+ */
+extern char *parseTime(char*, int*);
+
+/*
+ * Skips spaces and tabs.
+ *
+ * char*:  string to skip blanks of.
+ * return: pointer to the first byte that is not a blank.
+ */
+extern char *skipBlanks(char*);
+
+/*
+ * Checks whether a byte is a decimal digit, regardless of locale.
+ *
+ * char:   byte to check.
+ * return: 1 if byte is a digit, 0 otherwise.
+ */
+extern int isDigit(char);
+
+/*
+ * Checks whether a restaurant is open at a moment of the week.
+ *
+ * OpeningHours*: pointer to opening hours.
+ * int:           minutes after Monday midnight.
+ * return:        1 if restaurant is open, 0 otherwise.
+ */
+extern int isOpenAt(OpeningHours*, int);
+
+/*
+ * Marks slots of the week in which a restaurant is open.
+ *
+ * OpeningHours*: pointer to opening hours.
+ * uint64_t*:     SLOT_WORDS words marking slots the restaurant is open through.
+ * uint64_t*:     SLOT_WORDS words marking slots the restaurant is open in a part of only.
+ */
+extern void markSlots(OpeningHours*, uint64_t*, uint64_t*);
+
+/*
+ * Marks a run of slots.
+ *
+ * uint64_t*: SLOT_WORDS words marking slots.
+ * int:       first slot of the run.
+ * int:       slot past the run.
+ */
+extern void markRun(uint64_t*, int, int);
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * file: PostingList.c
+ * -------------------
+ * Implements posting list data structure: a sorted array of distinct restaurant ids.
+ * Functionality includes creating, inserting in, removing from, and converting posting lists.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "PostingList.h"
+
+/*
+ * Initialyzes an empty posting list with room for eight ids.
+ *
+ * return: pointer to a created posting list.
+ */
+PostingList *createPostingList() {
+  PostingList *list = (PostingList*)malloc(sizeof(PostingList));
+  list->ids   = (int*)malloc(8 * sizeof(int));
+  list->size  = 0;
+  list->space = 8;
+
+  return list;
+}
+
+/*
+ * Inserts an id in a posting list, keeping it sorted. Ids are usually handed out in increasing
+ * order, so the common case is an append. Ids already in the list are ignored. List doubles
+ * when it is full.
+ *
+ * *list: pointer to a posting list.
+ * id:    id to insert.
+ */
+void insertPosting(PostingList *list, int id) {
+  int index = list->size;
+
+  if (list->size > 0 && list->ids[list->size - 1] >= id) { // If id does not go at the end.
+    index = findPosting(list, id);
+    if (index < list->size && list->ids[index] == id) { // If id is already in the list.
+      return;
+    }
+  }
+
+  if (list->size == list->space) { // If list is full.
+    list->space *= 2;
+    list->ids = (int*)realloc(list->ids, list->space * sizeof(int));
+  }
+
+  memmove(list->ids + index + 1, list->ids + index, (list->size - index) * sizeof(int));
+  list->ids[index] = id;
+  list->size++;
+}
+
+/*
+ * Searches a posting list for an id with a binary search.
+ *
+ * *list:  pointer to a posting list.
+ * id:     id to search for.
+ * return: index of the id in the list, or index where it belongs if it is absent.
+ */
+int findPosting(PostingList *list, int id) {
+  int low  = 0;
+  int high = list->size;
+
+  while (low < high) { // Narrow down the range that may hold the id.
+    int middle = (low + high) / 2;
+
+    if (list->ids[middle] < id) { // If id is to the right of the middle.
+      low = middle + 1;
+    } else { // Id is at the middle or to the left of it.
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/*
+ * Removes an id from a posting list. Ids to the right are shifted by one to the left.
+ *
+ * *list:  pointer to a posting list.
+ * id:     id to remove.
+ * return: 0 if removal was successfull, -1 otherwise.
+ */
+int removePosting(PostingList *list, int id) {
+  int index = findPosting(list, id);
+
+  if (index == list->size || list->ids[index] != id) { // If id is not in the list.
+    return -1;
+  }
+
+  memmove(list->ids + index, list->ids + index + 1, (list->size - index - 1) * sizeof(int));
+  list->size--;
+
+  return 0;
+}
+
+/*
+ * Creates a bitmap of ids in a posting list. Ids are sorted, so each one is appended to the
+ * last container of the bitmap.
+ *
+ * *list:  pointer to a posting list.
+ * return: pointer to a created bitmap.
+ */
+Bitmap *postingBitmap(PostingList *list) {
+  Bitmap *bitmap = createBitmap();
+
+  for (int i = 0; i < list->size; i++) { // Add every id.
+    addToBitmap(bitmap, list->ids[i]);
+  }
+  return bitmap;
+}
+
+/*
+ * Frees a posting list and its ids.
+ *
+ * *list: pointer to a posting list.
+ */
+void freePostingList(PostingList *list) {
+  free(list->ids);
+  free(list);
+}
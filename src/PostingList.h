@@ -0,0 +1,70 @@
+#ifndef POSTINGLIST_H
+#define POSTINGLIST_H
+
+/*
+ * file: PostingList.h
+ * -------------------
+ * Implements posting list data structure: a sorted array of distinct restaurant ids.
+ * Functionality includes creating, inserting in, removing from, and converting posting lists.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "Bitmap.h"
+
+typedef struct { // Define posting list holding sorted restaurant ids.
+  int *ids;
+  int size;
+  int space;
+} PostingList;
+
+/*
+ * Initialyzes an empty posting list.
+ *
+ * return: pointer to a created posting list.
+ */
+extern PostingList *createPostingList();
+
+/*
+ * Inserts an id in a posting list, keeping it sorted. Ids already in the list are ignored.
+ *
+ * PostingList*: pointer to a posting list.
+ * int:          id to insert.
+ */
+extern void insertPosting(PostingList*, int);
+
+/*
+ * Searches a posting list for an id.
+ *
+ * PostingList*: pointer to a posting list.
+ * int:          id to search for.
+ * return:       index of the id in the list, or index where it belongs if it is absent.
+ */
+extern int findPosting(PostingList*, int);
+
+/*
+ * Removes an id from a posting list.
+ *
+ * PostingList*: pointer to a posting list.
+ * int:          id to remove.
+ * return:       0 if removal was successfull, -1 otherwise.
+ */
+extern int removePosting(PostingList*, int);
+
+/*
+ * Creates a bitmap of ids in a posting list.
+ *
+ * PostingList*: pointer to a posting list.
+ * return:       pointer to a created bitmap.
+ */
+extern Bitmap *postingBitmap(PostingList*);
+
+/*
+ * Frees a posting list.
+ *
+ * PostingList*: pointer to a posting list.
+ */
+extern void freePostingList(PostingList*);
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * file: Predicate.c
+ * -----------------
+ * Implements predicate kernels over dense columns. A kernel tests whether every value of a
+ * column lies within an inclusive range, and writes one bit per row to selection words, bit
+ * i of word w standing for row 64 * w + i. Kernels use AVX2 when the processor supports it,
+ * and scalar code otherwise. AVX2 kernels are compiled for that instruction set only, so the
+ * program runs on any processor of the family.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <string.h>
+#include "Predicate.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+static int simdSupport = -1; // Whether AVX2 kernels are used, -1 until checked.
+
+/*
+ * Checks whether AVX2 kernels are used. Processor is asked once, on the first call.
+ *
+ * return: 1 if processor supports AVX2, 0 otherwise.
+ */
+int simdPredicates() {
+  if (simdSupport == -1) { // If processor was not asked yet.
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    simdSupport = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+    simdSupport = 0;
+#endif
+  }
+  return simdSupport;
+}
+
+/*
+ * Selects rows of a byte column within a range, with AVX2 kernel if it is supported.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectBytes(unsigned char *column, int count, int low, int high, uint64_t *words) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (simdPredicates()) { // If processor supports AVX2.
+    selectBytesAVX2(column, count, low, high, words);
+    return;
+  }
+#endif
+  selectBytesScalar(column, count, low, high, words);
+}
+
+/*
+ * Selects rows of an integer column within a range, with AVX2 kernel if it is supported.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectInts(int *column, int count, int low, int high, uint64_t *words) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (simdPredicates()) { // If processor supports AVX2.
+    selectIntsAVX2(column, count, low, high, words);
+    return;
+  }
+#endif
+  selectIntsScalar(column, count, low, high, words);
+}
+
+/*
+ * Selects rows of a float column within a range, with AVX2 kernel if it is supported.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectFloats(float *column, int count, float low, float high, uint64_t *words) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (simdPredicates()) { // If processor supports AVX2.
+    selectFloatsAVX2(column, count, low, high, words);
+    return;
+  }
+#endif
+  selectFloatsScalar(column, count, low, high, words);
+}
+
+/*
+ * Selects rows of a byte column within a range, one row at a time. Words are cleared first,
+ * so bits past the last row stay unset.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectBytesScalar(unsigned char *column, int count, int low, int high, uint64_t *words) {
+  memset(words, 0, (count + 63) / 64 * sizeof(uint64_t));
+  for (int i = 0; i < count; i++) { // Test every row.
+    words[i >> 6] |= (uint64_t)(column[i] >= low && column[i] <= high) << (i & 63);
+  }
+}
+
+/*
+ * Selects rows of an integer column within a range, one row at a time. Words are cleared
+ * first, so bits past the last row stay unset.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectIntsScalar(int *column, int count, int low, int high, uint64_t *words) {
+  memset(words, 0, (count + 63) / 64 * sizeof(uint64_t));
+  for (int i = 0; i < count; i++) { // Test every row.
+    words[i >> 6] |= (uint64_t)(column[i] >= low && column[i] <= high) << (i & 63);
+  }
+}
+
+/*
+ * Selects rows of a float column within a range, one row at a time. Comparisons with NaN are
+ * false, so NaN values are never selected. Words are cleared first, so bits past the last row
+ * stay unset.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+void selectFloatsScalar(float *column, int count, float low, float high, uint64_t *words) {
+  memset(words, 0, (count + 63) / 64 * sizeof(uint64_t));
+  for (int i = 0; i < count; i++) { // Test every row.
+    words[i >> 6] |= (uint64_t)(column[i] >= low && column[i] <= high) << (i & 63);
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/*
+ * Selects rows of a byte column within a range, 32 rows at a time. Value is within the range
+ * when unsigned maximum with the low bound and minimum with the high bound leave it as is.
+ * Rows past the last full word are tested by the scalar kernel.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+AVX2 void selectBytesAVX2(unsigned char *column, int count, int low, int high,
+    uint64_t *words) {
+  int full = count / 64;
+  __m256i lows;
+  __m256i highs;
+
+  if (low > 255 || high < 0 || low > high) { // If no byte is within the range.
+    memset(words, 0, (count + 63) / 64 * sizeof(uint64_t));
+    return;
+  }
+  lows  = _mm256_set1_epi8((char)(low < 0 ? 0 : low));
+  highs = _mm256_set1_epi8((char)(high > 255 ? 255 : high));
+
+  for (int w = 0; w < full; w++) { // Test 64 rows for every word.
+    uint64_t word = 0;
+
+    for (int half = 0; half < 2; half++) { // Test 32 rows at a time.
+      __m256i values = _mm256_loadu_si256((__m256i*)(column + w * 64 + half * 32));
+      __m256i in = _mm256_and_si256(
+          _mm256_cmpeq_epi8(_mm256_max_epu8(values, lows), values),
+          _mm256_cmpeq_epi8(_mm256_min_epu8(values, highs), values));
+
+      word |= (uint64_t)(uint32_t)_mm256_movemask_epi8(in) << (half * 32);
+    }
+    words[w] = word;
+  }
+  if (full * 64 < count) { // If rows are left past the last full word.
+    selectBytesScalar(column + full * 64, count - full * 64, low, high, words + full);
+  }
+}
+
+/*
+ * Selects rows of an integer column within a range, 8 rows at a time. Value is out of the
+ * range when the low bound is greater than it or it is greater than the high bound. Rows past
+ * the last full word are tested by the scalar kernel.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+AVX2 void selectIntsAVX2(int *column, int count, int low, int high, uint64_t *words) {
+  int full = count / 64;
+  __m256i lows  = _mm256_set1_epi32(low);
+  __m256i highs = _mm256_set1_epi32(high);
+
+  for (int w = 0; w < full; w++) { // Test 64 rows for every word.
+    uint64_t word = 0;
+
+    for (int part = 0; part < 8; part++) { // Test 8 rows at a time.
+      __m256i values = _mm256_loadu_si256((__m256i*)(column + w * 64 + part * 8));
+      __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(lows, values),
+          _mm256_cmpgt_epi32(values, highs));
+
+      word |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xFF) << (part * 8);
+    }
+    words[w] = word;
+  }
+  if (full * 64 < count) { // If rows are left past the last full word.
+    selectIntsScalar(column + full * 64, count - full * 64, low, high, words + full);
+  }
+}
+
+/*
+ * Selects rows of a float column within a range, 8 rows at a time. Ordered comparisons are
+ * false for NaN, so NaN values are never selected. Rows past the last full word are tested by
+ * the scalar kernel.
+ *
+ * *column: pointer to the first row.
+ * count:   number of rows.
+ * low:     lowest value.
+ * high:    highest value.
+ * *words:  selection words with room for all rows.
+ */
+AVX2 void selectFloatsAVX2(float *column, int count, float low, float high, uint64_t *words) {
+  int full = count / 64;
+  __m256 lows  = _mm256_set1_ps(low);
+  __m256 highs = _mm256_set1_ps(high);
+
+  for (int w = 0; w < full; w++) { // Test 64 rows for every word.
+    uint64_t word = 0;
+
+    for (int part = 0; part < 8; part++) { // Test 8 rows at a time.
+      __m256 values = _mm256_loadu_ps(column + w * 64 + part * 8);
+      __m256 in = _mm256_and_ps(_mm256_cmp_ps(values, lows, _CMP_GE_OQ),
+          _mm256_cmp_ps(values, highs, _CMP_LE_OQ));
+
+      word |= (uint64_t)_mm256_movemask_ps(in) << (part * 8);
+    }
+    words[w] = word;
+  }
+  if (full * 64 < count) { // If rows are left past the last full word.
+    selectFloatsScalar(column + full * 64, count - full * 64, low, high, words + full);
+  }
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+/*
+ * file: Predicate.h
+ * -----------------
+ * Implements predicate kernels over dense columns. A kernel tests whether every value of a
+ * column lies within an inclusive range, and writes one bit per row to selection words, bit
+ * i of word w standing for row 64 * w + i. Kernels use AVX2 when the processor supports it,
+ * and scalar code otherwise.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+
+/*
+ * Checks whether AVX2 kernels are used.
+ *
+ * return: 1 if processor supports AVX2, 0 otherwise.
+ */
+extern int simdPredicates();
+
+/*
+ * Selects rows of a byte column within a range.
+ *
+ * unsigned char*: pointer to the first row.
+ * int:            number of rows.
+ * int:            lowest value.
+ * int:            highest value.
+ * uint64_t*:      selection words with room for all rows.
+ */
+extern void selectBytes(unsigned char*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of an integer column within a range.
+ *
+ * int*:      pointer to the first row.
+ * int:       number of rows.
+ * int:       lowest value.
+ * int:       highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectInts(int*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of a float column within a range. NaN values are never selected.
+ *
+ * float*:    pointer to the first row.
+ * int:       number of rows.
+ * float:     lowest value.
+ * float:     highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectFloats(float*, int, float, float, uint64_t*);
+
+/*
+ * Selects rows of a byte column within a range, one row at a time.
+ *
+ * unsigned char*: pointer to the first row.
+ * int:            number of rows.
+ * int:            lowest value.
+ * int:            highest value.
+ * uint64_t*:      selection words with room for all rows.
+ */
+extern void selectBytesScalar(unsigned char*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of an integer column within a range, one row at a time.
+ *
+ * int*:      pointer to the first row.
+ * int:       number of rows.
+ * int:       lowest value.
+ * int:       highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectIntsScalar(int*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of a float column within a range, one row at a time.
+ *
+ * float*:    pointer to the first row.
+ * int:       number of rows.
+ * float:     lowest value.
+ * float:     highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectFloatsScalar(float*, int, float, float, uint64_t*);
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/*
+ * Selects rows of a byte column within a range, 32 rows at a time.
+ *
+ * unsigned char*: pointer to the first row.
+ * int:            number of rows.
+ * int:            lowest value.
+ * int:            highest value.
+ * uint64_t*:      selection words with room for all rows.
+ */
+extern void selectBytesAVX2(unsigned char*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of an integer column within a range, 8 rows at a time.
+ *
+ * int*:      pointer to the first row.
+ * int:       number of rows.
+ * int:       lowest value.
+ * int:       highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectIntsAVX2(int*, int, int, int, uint64_t*);
+
+/*
+ * Selects rows of a float column within a range, 8 rows at a time.
+ *
+ * float*:    pointer to the first row.
+ * int:       number of rows.
+ * float:     lowest value.
+ * float:     highest value.
+ * uint64_t*: selection words with room for all rows.
+ */
+extern void selectFloatsAVX2(float*, int, float, float, uint64_t*);
+
+#endif
+
+#endif
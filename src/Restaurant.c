@@ -11,35 +11,59 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "Restaurant.h"
+#include "StringPool.h"
+#include "Arena.h"
 
 /*
  * Initialyzes a pointed Restaurant structure. Allocates space and sets fields equal to passed 
- * parameters.
+ * parameters. Name is copied, while city and cost are interned, so restaurants share a single 
+ * copy of each distinct value and can compare them as handles. Opening hours are read into 
+ * intervals. Memory comes from the current arena, if one is in use.
  *
  * *name:       name of a restaurant.
  * *city:       city where restaurant is located.
  * *categories: pointer to restaurant's food categories linked list. 
- * *
+ * *hours:      opening hours, see parseHours().
  * *cost:       how expensive restaurant is ($, $$, $$$).
  * rank:        restaurant's rank from 0.0 to 5.0
  * reviewers:   number of people who rated the restaurant.
  * return:      pointer to a restaurant struct.
  */
-Restaurant *initRestaurant(char *name, char* city, LinkedList *categories, 
-    // LinkedList *whenOpen, 
+Restaurant *initRestaurant(char *name, char* city, LinkedList *categories, char *hours,
     char *cost, float rank, int reviewers) {
-  Restaurant *restaurant = malloc(sizeof(Restaurant));
+  char *copy = (char*)allocate((strlen(name) + 1) * sizeof(char));
 
-  restaurant->name = (char*)malloc(64*sizeof(char));
-  restaurant->city = (char*)malloc(64*sizeof(char));
-  restaurant->cost = (char*)malloc(64*sizeof(char));
-  strcpy(restaurant->name, name);
-  strcpy(restaurant->city, city);
+  strcpy(copy, name);
+  return initPooledRestaurant(copy, internString(city), categories, hours, internString(cost), 
+      rank, reviewers);
+}
+
+/*
+ * Initialyzes a pointed Restaurant structure from a name it takes over and pooled handles of 
+ * city and cost, so nothing is copied. Loader builds these fields straight from the bytes of 
+ * the file. Memory comes from the current arena, if one is in use.
+ *
+ * *name:       name of a restaurant, allocated for the restaurant to keep.
+ * *city:       pooled handle of the city where restaurant is located.
+ * *categories: pointer to restaurant's food categories linked list. 
+ * *hours:      opening hours, see parseHours().
+ * *cost:       pooled handle of how expensive restaurant is ($, $$, $$$).
+ * rank:        restaurant's rank from 0.0 to 5.0
+ * reviewers:   number of people who rated the restaurant.
+ * return:      pointer to a restaurant struct.
+ */
+Restaurant *initPooledRestaurant(char *name, char* city, LinkedList *categories, char *hours,
+    char *cost, float rank, int reviewers) {
+  Restaurant *restaurant = (Restaurant*)allocate(sizeof(Restaurant));
+
+  restaurant->name       = name;
+  restaurant->city       = city;
   restaurant->categories = categories;
-  // restaurant->whenOpen   = whenOpen;
-  strcpy(restaurant->cost, cost);
+  parseHours(hours, &restaurant->hours);
+  restaurant->cost       = cost;
   restaurant->rank       = rank;
   restaurant->reviewers  = reviewers;
+  restaurant->id         = -1;
 
   return restaurant; 
 }
@@ -53,7 +77,8 @@ void printRestaurant(Restaurant restaurant) {
   printf("%s\n", restaurant.name);
   printf("%s\n", restaurant.city);
   printLinkedList(restaurant.categories);
-  // printf("%s\n", restaurant.whenOpen);
+  writeHours(&restaurant.hours, stdout);
+  printf("\n");
   printf("%s\n", restaurant.cost);
   printf("%0.1f\n", restaurant.rank);
   printf("%d\n", restaurant.reviewers);
@@ -78,6 +103,8 @@ char *toStringRestaurant(Restaurant *restaurant) {
   strcat(printbuf, "\n");
   strcat(printbuf, toStringLinkedList(restaurant->categories));
   strcat(printbuf, "\n");
+  strcat(printbuf, toStringHours(&restaurant->hours));
+  strcat(printbuf, "\n");
   strcat(printbuf, restaurant->cost);
   strcat(printbuf, "\n");
 
@@ -92,3 +119,23 @@ char *toStringRestaurant(Restaurant *restaurant) {
 
   return printbuf;
 }
+
+/*
+ * Writes information about the restaurant to a file, one field per line followed by an empty 
+ * line. Produces the same text as toStringRestaurant() without building a string.
+ *
+ * *restaurant: pointer to the restaurant.
+ * *file:       file to write to.
+ */
+void writeRestaurant(Restaurant *restaurant, FILE *file) {
+  fputs(restaurant->name, file);
+  fputc('\n', file);
+  fputs(restaurant->city, file);
+  fputc('\n', file);
+  writeLinkedList(restaurant->categories, file);
+  fputc('\n', file);
+  writeHours(&restaurant->hours, file);
+  fputc('\n', file);
+  fputs(restaurant->cost, file);
+  fprintf(file, "\n%0.1f\n%d\n\n", restaurant->rank, restaurant->reviewers);
+}
@@ -11,15 +11,17 @@
  */
 
 #include "LinkedList.h"
+#include "OpeningHours.h"
 
 typedef struct { // Define restaurant structure with appropriate field.
   char* name;
-  char* city;
-  LinkedList *categories;
-  // LinkedList *whenOpen;
-  char* cost;
+  char* city;             // Pooled handle.
+  LinkedList *categories; // List of pooled handles.
+  OpeningHours hours;
+  char* cost;             // Pooled handle.
   float rank;
   int reviewers;
+  int id;                 // Id in the knowledge base, -1 until added.
 } Restaurant;
 
 /*
@@ -28,15 +30,27 @@ typedef struct { // Define restaurant structure with appropriate field.
  * char*:       name of a restaurant.
  * char*:       city where restaurant is located.
  * LinkedList*: pointer to restaurant's food categories linked list.
- * *
+ * char*:       opening hours, see parseHours().
  * char*:       how expensive restaurant is ($, $$, $$$).
  * float:       restaurant's rank from 0.0 to 5.0
  * int:         number of people who rated the restaurant.
  * return:      pointer to a restaurant struct.
  */
-extern Restaurant *initRestaurant(char*, char*, LinkedList*, 
-    //LinkedList*, 
-    char*, float, int);
+extern Restaurant *initRestaurant(char*, char*, LinkedList*, char*, char*, float, int);
+
+/*
+ * Initialyzes a pointed Restaurant structure from a name it takes over and pooled handles.
+ *
+ * char*:       name of a restaurant, allocated for the restaurant to keep.
+ * char*:       pooled handle of the city where restaurant is located.
+ * LinkedList*: pointer to restaurant's food categories linked list.
+ * char*:       opening hours, see parseHours().
+ * char*:       pooled handle of how expensive restaurant is ($, $$, $$$).
+ * float:       restaurant's rank from 0.0 to 5.0
+ * int:         number of people who rated the restaurant.
+ * return:      pointer to a restaurant struct.
+ */
+extern Restaurant *initPooledRestaurant(char*, char*, LinkedList*, char*, char*, float, int);
 
 /*
  * Prints restaurant's information to the console.
@@ -53,4 +67,12 @@ extern void printRestaurant(Restaurant);
  */
 extern char* toStringRestaurant(Restaurant*);
 
+/*
+ * Writes information about the restaurant to a file.
+ *
+ * Restaurant*: pointer to the restaurant.
+ * FILE*:       file to write to.
+ */
+extern void writeRestaurant(Restaurant*, FILE*);
+
 #endif
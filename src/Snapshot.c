@@ -0,0 +1,455 @@
+/*
+ * file: Snapshot.c
+ * ----------------
+ * Saves knowledge base to a binary snapshot and loads it back without parsing. Snapshot holds
+ * a string table, a record of fixed width per restaurant, category ids, opening intervals and
+ * the order of restaurants in every tree, so trees are built without sorting. Loaded snapshot
+ * is mapped in memory, and names and opening intervals point into the mapping.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Snapshot.h"
+#include "StringPool.h"
+#include "Arena.h"
+#include "writeFile.h"
+
+/*
+ * Saves restaurants of a knowledge base to a snapshot. Restaurants are saved in order of their
+ * ids, leaving out removed ones, and every tree is saved as the list of its restaurants in
+ * order of the tree, so loaded trees hold their restaurants in the same order. Handles are
+ * saved as ids of the string table, which holds every pooled string. Snapshot is written to a
+ * temporary file that replaces the old one once it is complete and synced, so a loaded
+ * snapshot, still mapped, is never written over.
+ *
+ * *fileName: name of the snapshot file.
+ * *kb:       pointer to a knowledge base.
+ * return:    0 upon successful execution, -1 if snapshot could not be written.
+ */
+int saveSnapshot(char *fileName, KnowledgeBase *kb) {
+  BinaryTree *trees[TREE_ORDERS] = {kb->btName, kb->btCity, kb->btRank, kb->btReviewers,
+      kb->btCost};
+  int *records = (int*)malloc((kb->count > 0 ? kb->count : 1) * sizeof(int));
+  char *temporary = (char*)malloc(strlen(fileName) + 5);
+  SnapshotHeader header;
+  uint64_t *offsets;
+  SnapshotRecord *table;
+  uint32_t *categoryIds;
+  OpenInterval *intervals;
+  uint32_t *orders;
+  char *text;
+  size_t used = 0;
+  uint64_t checksum;
+  FILE *file;
+  int failed = 0;
+
+  memset(&header, 0, sizeof(SnapshotHeader));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version      = SNAPSHOT_VERSION;
+  header.marker       = SNAPSHOT_MARKER;
+  header.recordSize   = sizeof(SnapshotRecord);
+  header.intervalSize = sizeof(OpenInterval);
+  header.strings      = poolSize();
+  for (int s = 0; s < poolSize(); s++) { // Count bytes of pooled strings.
+    header.textBytes += strlen(stringById(s)) + 1;
+  }
+  for (int id = 0; id < kb->count; id++) { // Number restaurants and count their parts.
+    Restaurant *restaurant = kb->restaurants[id];
+
+    records[id] = restaurant != NULL ? (int)header.count : -1;
+    if (restaurant != NULL) { // If restaurant was not removed, it gets the next record.
+      header.count++;
+      header.textBytes  += strlen(restaurant->name) + 1;
+      header.categories += restaurant->categories->size;
+      header.intervals  += restaurant->hours.count;
+    }
+  }
+
+  offsets     = (uint64_t*)malloc((header.strings + 1) * sizeof(uint64_t));
+  table       = (SnapshotRecord*)malloc((header.count + 1) * sizeof(SnapshotRecord));
+  categoryIds = (uint32_t*)malloc((header.categories + 1) * sizeof(uint32_t));
+  intervals   = (OpenInterval*)calloc(header.intervals + 1, sizeof(OpenInterval));
+  orders      = (uint32_t*)malloc((TREE_ORDERS * header.count + 1) * sizeof(uint32_t));
+  text        = (char*)malloc(header.textBytes + 1);
+
+  for (int s = 0; s < poolSize(); s++) { // Add every pooled string to the text.
+    size_t length = strlen(stringById(s)) + 1;
+
+    offsets[s] = used;
+    memcpy(text + used, stringById(s), length);
+    used += length;
+  }
+  header.categories = 0;
+  header.intervals  = 0;
+  for (int id = 0; id < kb->count; id++) { // Fill record of every restaurant.
+    Restaurant *restaurant = kb->restaurants[id];
+    SnapshotRecord *record;
+    size_t length;
+
+    if (restaurant == NULL) { // If restaurant was removed, skip it.
+      continue;
+    }
+    record = &table[records[id]];
+    length = strlen(restaurant->name) + 1;
+    record->name = used;
+    memcpy(text + used, restaurant->name, length);
+    used += length;
+    record->city          = stringId(restaurant->city);
+    record->cost          = stringId(restaurant->cost);
+    record->categories    = header.categories;
+    record->categoryCount = restaurant->categories->size;
+    for (Node *node = restaurant->categories->head; node != NULL; node = node->next) { // Ids.
+      categoryIds[header.categories++] = stringId(node->data);
+    }
+    record->intervals     = header.intervals;
+    record->intervalCount = restaurant->hours.count;
+    for (int i = 0; i < restaurant->hours.count; i++) { // Copy fields, leaving padding zero.
+      OpenInterval *interval = &intervals[header.intervals++];
+
+      interval->day   = restaurant->hours.intervals[i].day;
+      interval->open  = restaurant->hours.intervals[i].open;
+      interval->close = restaurant->hours.intervals[i].close;
+    }
+    record->rank      = restaurant->rank;
+    record->reviewers = restaurant->reviewers;
+  }
+  for (int t = 0; t < TREE_ORDERS; t++) { // List records in order of every tree.
+    uint32_t *order = orders + (size_t)t * header.count;
+    BTIterator iterator;
+    BTNode *node;
+
+    initBTIterator(&iterator, trees[t]);
+    while ((node = nextBTNode(&iterator)) != NULL) { // Visit nodes in order of their keys.
+      for (int i = 0; i < getSize(node->restaurants); i++) { // Add every restaurant of node.
+        *order++ = records[getRestaurant(node->restaurants, i)->id];
+      }
+    }
+  }
+
+  sprintf(temporary, "%s.tmp", fileName);
+  file = fopen(temporary, "wb");
+  if (file != NULL) { // If temporary file was opened, write header and sections.
+    setvbuf(file, NULL, _IOFBF, WRITE_BUFFER);
+    checksum = checksumWords(CHECKSUM_BASIS, &header, offsetof(SnapshotHeader, checksum));
+    fwrite(&header, sizeof(SnapshotHeader), 1, file);
+    writeSection(file, offsets, header.strings * sizeof(uint64_t), &checksum);
+    writeSection(file, table, header.count * sizeof(SnapshotRecord), &checksum);
+    writeSection(file, categoryIds, header.categories * sizeof(uint32_t), &checksum);
+    writeSection(file, intervals, header.intervals * sizeof(OpenInterval), &checksum);
+    writeSection(file, orders, TREE_ORDERS * header.count * sizeof(uint32_t), &checksum);
+    writeSection(file, text, header.textBytes, &checksum);
+    header.checksum = checksum;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(SnapshotHeader), 1, file);
+    failed = ferror(file) || fflush(file) != 0 || fsync(fileno(file)) != 0;
+    failed = fclose(file) != 0 || failed;
+  }
+  if (file == NULL || failed || rename(temporary, fileName) != 0) { // If snapshot failed.
+    printf("Could not write snapshot %s.\n", fileName);
+    if (file != NULL) { // If temporary file was created, remove it.
+      unlink(temporary);
+    }
+    failed = 1;
+  }
+
+  free(records);
+  free(temporary);
+  free(offsets);
+  free(table);
+  free(categoryIds);
+  free(intervals);
+  free(orders);
+  free(text);
+
+  return failed ? -1 : 0;
+}
+
+/*
+ * Loads restaurants from a snapshot into an empty knowledge base. Snapshot is mapped in
+ * memory and checked whole before anything is loaded, so a knowledge base is left empty if
+ * snapshot is invalid. Names and opening intervals point into the mapping, which is kept for
+ * as long as the program runs. Mapping is private and writable, so names may be changed in
+ * place as any other name, copying only the pages written to and leaving the file as it is.
+ * The rest of restaurants comes from the current arena, if one is in use. Records are loaded
+ * in order, so restaurants get ids in the order they were saved, and trees are built from the
+ * saved orders without sorting.
+ *
+ * *fileName: name of the snapshot file.
+ * *kb:       pointer to an empty knowledge base.
+ * return:    0 upon successful execution, -1 if snapshot is missing or invalid.
+ */
+int loadSnapshot(char *fileName, KnowledgeBase *kb) {
+  int descriptor = open(fileName, O_RDONLY);
+  struct stat status;
+  char *base = MAP_FAILED;
+  size_t size = 0;
+  SnapshotHeader *header;
+  SnapshotLayout layout;
+  uint64_t *offsets;
+  SnapshotRecord *table;
+  uint32_t *categoryIds;
+  OpenInterval *intervals;
+  uint32_t *orders;
+  char **handles;
+  Restaurant *restaurants;
+  Restaurant **sorted[TREE_ORDERS];
+  ArrayList *loaded;
+
+  if (descriptor == -1) { // If snapshot cannot be opened.
+    return -1;
+  }
+  if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode)
+      && (size_t)status.st_size >= sizeof(SnapshotHeader)) { // If snapshot can be mapped.
+    size = status.st_size;
+    base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+  }
+  close(descriptor);
+  if (base == MAP_FAILED) { // If snapshot was not mapped.
+    return -1;
+  }
+  madvise(base, size, MADV_WILLNEED);
+  if (!checkSnapshot(base, size)) { // If snapshot is invalid, leave it.
+    munmap(base, size);
+    return -1;
+  }
+
+  header = (SnapshotHeader*)base;
+  layoutSnapshot(header, &layout);
+  offsets     = (uint64_t*)(base + layout.strings);
+  table       = (SnapshotRecord*)(base + layout.records);
+  categoryIds = (uint32_t*)(base + layout.categories);
+  intervals   = (OpenInterval*)(base + layout.intervals);
+  orders      = (uint32_t*)(base + layout.orders);
+
+  handles = (char**)malloc((header->strings + 1) * sizeof(char*));
+  for (uint32_t s = 0; s < header->strings; s++) { // Intern every string of the table.
+    handles[s] = internString(base + layout.text + offsets[s]);
+  }
+  restaurants = (Restaurant*)allocate((header->count + 1) * sizeof(Restaurant));
+  loaded = createArrayList();
+  for (uint32_t r = 0; r < header->count; r++) { // Point every restaurant to its record.
+    SnapshotRecord *record = &table[r];
+    Restaurant *restaurant = &restaurants[r];
+
+    restaurant->name       = base + layout.text + record->name;
+    restaurant->city       = handles[record->city];
+    restaurant->categories = createLinkedList();
+    for (uint32_t c = 0; c < record->categoryCount; c++) { // Add every category.
+      insertInLinkedList(restaurant->categories, handles[categoryIds[record->categories + c]]);
+    }
+    restaurant->hours.intervals = intervals + record->intervals;
+    restaurant->hours.count     = record->intervalCount;
+    restaurant->cost            = handles[record->cost];
+    restaurant->rank            = record->rank;
+    restaurant->reviewers       = record->reviewers;
+    restaurant->id              = -1;
+    insert(loaded, restaurant);
+  }
+  for (int t = 0; t < TREE_ORDERS; t++) { // Point to restaurants in order of every tree.
+    uint32_t *order = orders + (size_t)t * header->count;
+
+    sorted[t] = (Restaurant**)malloc((header->count + 1) * sizeof(Restaurant*));
+    for (uint32_t i = 0; i < header->count; i++) { // Point to restaurant of every index.
+      sorted[t][i] = &restaurants[order[i]];
+    }
+  }
+
+  loadSortedKnowledgeBase(kb, loaded, sorted);
+
+  for (int t = 0; t < TREE_ORDERS; t++) { // Free every order.
+    free(sorted[t]);
+  }
+  free(handles);
+
+  return 0;
+}
+
+/*
+ * Checks whether a snapshot exists and was written after its text source. Snapshot without a
+ * text source is newer.
+ *
+ * *snapshot: name of the snapshot file.
+ * *source:   name of the text file.
+ * return:    1 if snapshot is newer, 0 otherwise.
+ */
+int isSnapshotNewer(char *snapshot, char *source) {
+  struct stat saved;
+  struct stat text;
+
+  if (stat(snapshot, &saved) == -1) { // If there is no snapshot.
+    return 0;
+  }
+  if (stat(source, &text) == -1) { // If there is no text source.
+    return 1;
+  }
+  return saved.st_mtim.tv_sec > text.st_mtim.tv_sec || (saved.st_mtim.tv_sec ==
+      text.st_mtim.tv_sec && saved.st_mtim.tv_nsec > text.st_mtim.tv_nsec);
+}
+
+/*
+ * Computes offsets of the sections of a snapshot from the counts in its header. Sections
+ * follow the header in order of the layout, each one padded to a multiple of 8 bytes.
+ *
+ * *header: pointer to a header.
+ * *layout: pointer to the layout to fill.
+ */
+void layoutSnapshot(SnapshotHeader *header, SnapshotLayout *layout) {
+  layout->strings    = sizeof(SnapshotHeader);
+  layout->records    = layout->strings + alignSection(header->strings * sizeof(uint64_t));
+  layout->categories = layout->records + alignSection(header->count * sizeof(SnapshotRecord));
+  layout->intervals  = layout->categories + alignSection(header->categories * sizeof(uint32_t));
+  layout->orders     = layout->intervals
+      + alignSection(header->intervals * sizeof(OpenInterval));
+  layout->text       = layout->orders
+      + alignSection(TREE_ORDERS * (size_t)header->count * sizeof(uint32_t));
+  layout->end        = layout->text + alignSection(header->textBytes);
+}
+
+/*
+ * Rounds a number of bytes up to a multiple of 8.
+ *
+ * bytes:  number of bytes.
+ * return: rounded number of bytes.
+ */
+size_t alignSection(size_t bytes) {
+  return (bytes + 7) & ~(size_t)7;
+}
+
+/*
+ * Mixes bytes into a checksum with FNV-1a, taking 8 bytes at a time instead of one, so a
+ * snapshot is checked at the speed it is read.
+ *
+ * checksum: checksum so far.
+ * *bytes:   first byte, 8-byte aligned.
+ * size:     number of bytes, a multiple of 8.
+ * return:   updated checksum.
+ */
+uint64_t checksumWords(uint64_t checksum, void *bytes, size_t size) {
+  uint64_t *words = (uint64_t*)bytes;
+
+  for (size_t w = 0; w < size / 8; w++) { // Mix in every word.
+    checksum ^= words[w];
+    checksum *= CHECKSUM_PRIME;
+  }
+  return checksum;
+}
+
+/*
+ * Writes a section of a snapshot, padded with zeros to a multiple of 8 bytes. Checksum takes
+ * the last bytes and the padding as one word.
+ *
+ * *file:     file to write to.
+ * *bytes:    bytes of the section.
+ * size:      number of bytes.
+ * *checksum: pointer to the checksum, updated with the written bytes.
+ */
+void writeSection(FILE *file, void *bytes, size_t size, uint64_t *checksum) {
+  size_t whole = size & ~(size_t)7;
+  uint64_t last = 0;
+
+  fwrite(bytes, 1, size, file);
+  *checksum = checksumWords(*checksum, bytes, whole);
+  if (whole < size) { // If section ends inside a word, pad it.
+    memcpy(&last, (char*)bytes + whole, size - whole);
+    fwrite((char*)&last + (size - whole), 1, 8 - (size - whole), file);
+    *checksum = checksumWords(*checksum, &last, 8);
+  }
+}
+
+/*
+ * Checks that a mapped snapshot is whole and its records point inside it: header must match
+ * this layout, sections must fill the snapshot exactly and match the checksum, and every
+ * offset, id and index must be in bounds, so loading needs no further checks.
+ *
+ * *base:  first byte of the snapshot.
+ * size:   number of bytes.
+ * return: 1 if snapshot is valid, 0 otherwise.
+ */
+int checkSnapshot(char *base, size_t size) {
+  SnapshotHeader *header = (SnapshotHeader*)base;
+  SnapshotLayout layout;
+  uint64_t *offsets;
+  SnapshotRecord *table;
+  uint32_t *categoryIds;
+  OpenInterval *intervals;
+  char *text;
+  char *seen;
+  int valid = 1;
+
+  if (size < sizeof(SnapshotHeader) || memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0
+      || header->version != SNAPSHOT_VERSION || header->marker != SNAPSHOT_MARKER
+      || header->recordSize != sizeof(SnapshotRecord)
+      || header->intervalSize != sizeof(OpenInterval)
+      || header->textBytes > size) { // If header is not of this layout.
+    return 0;
+  }
+  layoutSnapshot(header, &layout);
+  if (layout.end != size || checksumWords(checksumWords(CHECKSUM_BASIS, header,
+      offsetof(SnapshotHeader, checksum)), base + layout.strings, size - layout.strings)
+      != header->checksum) { // If snapshot is cut short or damaged.
+    return 0;
+  }
+
+  offsets     = (uint64_t*)(base + layout.strings);
+  table       = (SnapshotRecord*)(base + layout.records);
+  categoryIds = (uint32_t*)(base + layout.categories);
+  intervals   = (OpenInterval*)(base + layout.intervals);
+  text        = base + layout.text;
+  if (header->textBytes > 0 && text[header->textBytes - 1] != 0) { // If last string is open.
+    return 0;
+  }
+  for (uint32_t s = 0; s < header->strings; s++) { // Check every string offset.
+    valid &= offsets[s] < header->textBytes;
+  }
+  for (uint32_t c = 0; c < header->categories; c++) { // Check every category id.
+    valid &= categoryIds[c] < header->strings;
+  }
+  for (uint32_t i = 0; i < header->intervals; i++) { // Check every interval.
+    valid &= intervals[i].day < 7 && intervals[i].open < DAY_MINUTES
+        && intervals[i].close <= DAY_MINUTES;
+  }
+  for (uint32_t r = 0; r < header->count; r++) { // Check every record.
+    SnapshotRecord *record = &table[r];
+
+    valid &= record->name < header->textBytes && record->city < header->strings
+        && record->cost < header->strings
+        && (uint64_t)record->categories + record->categoryCount <= header->categories
+        && (uint64_t)record->intervals + record->intervalCount <= header->intervals;
+  }
+
+  seen = (char*)malloc(header->count + 1);
+  for (int t = 0; t < TREE_ORDERS && valid; t++) { // Check order of every tree.
+    valid = checkOrder((uint32_t*)(base + layout.orders) + (size_t)t * header->count,
+        header->count, seen);
+  }
+  free(seen);
+
+  return valid;
+}
+
+/*
+ * Checks that a list of record indexes names every record exactly once.
+ *
+ * *order: list of indexes.
+ * count:  number of records.
+ * *seen:  count bytes of scratch space.
+ * return: 1 if list is an ordering of the records, 0 otherwise.
+ */
+int checkOrder(uint32_t *order, uint32_t count, char *seen) {
+  memset(seen, 0, count);
+  for (uint32_t i = 0; i < count; i++) { // Mark record of every index.
+    if (order[i] >= count || seen[order[i]]) { // If index is out of bounds or repeated.
+      return 0;
+    }
+    seen[order[i]] = 1;
+  }
+  return 1;
+}
@@ -0,0 +1,146 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*
+ * file: Snapshot.h
+ * ----------------
+ * Saves knowledge base to a binary snapshot and loads it back without parsing. Snapshot holds
+ * a string table, a record of fixed width per restaurant, category ids, opening intervals and
+ * the order of restaurants in every tree, so trees are built without sorting. Loaded snapshot
+ * is mapped in memory, and names and opening intervals point into the mapping.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "KnowledgeBase.h"
+
+#define SNAPSHOT_FILE    "restaurants.snap"      // Loaded instead of the text while newer.
+#define SNAPSHOT_MAGIC   "YELPSNAP"              // First bytes of every snapshot.
+#define SNAPSHOT_VERSION 1                       // Version of the layout, raised on changes.
+#define SNAPSHOT_MARKER  0x01020304u             // Written as is, so byte order can be checked.
+#define CHECKSUM_BASIS   14695981039346656037ull // Starting checksum, offset basis of FNV-1a.
+#define CHECKSUM_PRIME   1099511628211ull        // Multiplier of the checksum, prime of FNV-1a.
+
+typedef struct { // Define header at the start of a snapshot, followed by its sections.
+  char magic[8];
+  uint32_t version;
+  uint32_t marker;
+  uint32_t recordSize;   // Bytes of a record, to tell snapshots of another layout.
+  uint32_t intervalSize; // Bytes of an opening interval.
+  uint32_t strings;      // Number of pooled strings.
+  uint32_t count;        // Number of restaurants.
+  uint32_t categories;   // Number of category ids of all restaurants.
+  uint32_t intervals;    // Number of opening intervals of all restaurants.
+  uint64_t textBytes;    // Bytes of pooled strings and names, each one with its terminator.
+  uint64_t checksum;     // Checksum of the fields above and of all sections.
+} SnapshotHeader;
+
+typedef struct { // Define restaurant in a snapshot, strings given by offsets and ids.
+  uint64_t name;          // Offset of the name in the text.
+  uint32_t city;          // Id of the city in the string table.
+  uint32_t cost;          // Id of the cost in the string table.
+  uint32_t categories;    // Index of the first category id.
+  uint32_t categoryCount;
+  uint32_t intervals;     // Index of the first opening interval.
+  uint32_t intervalCount;
+  float rank;
+  int32_t reviewers;
+} SnapshotRecord;
+
+typedef struct { // Define offsets of the sections of a snapshot, each one 8-byte aligned.
+  size_t strings;    // Offsets of pooled strings in the text.
+  size_t records;
+  size_t categories;
+  size_t intervals;
+  size_t orders;     // Records in order of every tree, TREE_ORDERS lists of indexes.
+  size_t text;
+  size_t end;
+} SnapshotLayout;
+
+/*
+ * Saves restaurants of a knowledge base to a snapshot.
+ *
+ * char*:          name of the snapshot file.
+ * KnowledgeBase*: pointer to a knowledge base.
+ * return:         0 upon successful execution, -1 if snapshot could not be written.
+ */
+extern int saveSnapshot(char*, KnowledgeBase*);
+
+/*
+ * Loads restaurants from a snapshot into an empty knowledge base.
+ *
+ * char*:          name of the snapshot file.
+ * KnowledgeBase*: pointer to an empty knowledge base.
+ * return:         0 upon successful execution, -1 if snapshot is missing or invalid.
+ */
+extern int loadSnapshot(char*, KnowledgeBase*);
+
+/*
+ * Checks whether a snapshot exists and was written after its text source.
+ *
+ * char*:  name of the snapshot file.
+ * char*:  name of the text file.
+ * return: 1 if snapshot is newer, 0 otherwise.
+ */
+extern int isSnapshotNewer(char*, char*);
+
+/*
+ * Computes offsets of the sections of a snapshot from the counts in its header.
+ *
+ * SnapshotHeader*: pointer to a header.
+ * SnapshotLayout*: pointer to the layout to fill.
+ */
+extern void layoutSnapshot(SnapshotHeader*, SnapshotLayout*);
+
+/*
+ * Rounds a number of bytes up to a multiple of 8.
+ *
+ * size_t: number of bytes.
+ * return: rounded number of bytes.
+ */
+extern size_t alignSection(size_t);
+
+/*
+ * Mixes bytes into a checksum, 8 at a time.
+ *
+ * uint64_t: checksum so far.
+ * void*:    first byte, 8-byte aligned.
+ * size_t:   number of bytes, a multiple of 8.
+ * return:   updated checksum.
+ */
+extern uint64_t checksumWords(uint64_t, void*, size_t);
+
+/*
+ * Writes a section of a snapshot, padded with zeros to a multiple of 8 bytes.
+ *
+ * FILE*:     file to write to.
+ * void*:     bytes of the section.
+ * size_t:    number of bytes.
+ * uint64_t*: pointer to the checksum, updated with the written bytes.
+ */
+extern void writeSection(FILE*, void*, size_t, uint64_t*);
+
+/*
+ * Checks that a mapped snapshot is whole and its records point inside it.
+ *
+ * char*:  first byte of the snapshot.
+ * size_t: number of bytes.
+ * return: 1 if snapshot is valid, 0 otherwise.
+ */
+extern int checkSnapshot(char*, size_t);
+
+/*
+ * Checks that a list of record indexes names every record exactly once.
+ *
+ * uint32_t*: list of indexes.
+ * uint32_t:  number of records.
+ * char*:     count bytes of scratch space.
+ * return:    1 if list is an ordering of the records, 0 otherwise.
+ */
+extern int checkOrder(uint32_t*, uint32_t, char*);
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * file: StringPool.c
+ * ------------------
+ * Implements a global pool of interned strings. Each distinct string is stored once, and its
+ * pooled copy serves as a stable handle: two handles are equal only if their strings are
+ * equal, so handles are compared as pointers instead of with strcmp(). Every handle also has
+ * a dense id, assigned in order of interning.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "StringPool.h"
+
+static char **poolHandles = NULL; // Handles indexed by their ids.
+static int  poolCount     = 0;
+static int  poolSpace     = 0;
+static int  *poolSlots    = NULL; // Open addressing table of ids plus one, 0 if slot is empty.
+static int  slotSpace     = 0;
+
+/*
+ * Hashes a string with FNV-1a.
+ *
+ * *string: string to hash.
+ * return:  hash of the string.
+ */
+unsigned int hashString(char *string) {
+  return hashBytes(string, strlen(string));
+}
+
+/*
+ * Hashes bytes of a string that need not end with a zero byte, the same as hashString() does
+ * the whole string.
+ *
+ * *bytes: first byte of the string.
+ * length: number of bytes.
+ * return: hash of the string.
+ */
+unsigned int hashBytes(char *bytes, int length) {
+  unsigned int hash = 2166136261u;
+
+  for (int i = 0; i < length; i++) { // Mix in every character.
+    hash ^= (unsigned char)bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/*
+ * Finds a slot of the hash table holding a string, or an empty slot where it belongs.
+ * Collisions are resolved by linear probing. String is compared by its bytes, so it need not
+ * end with a zero byte, but must not hold one.
+ *
+ * *bytes: first byte of the string to look for.
+ * length: number of bytes.
+ * return: index of a slot.
+ */
+int probePool(char *bytes, int length) {
+  unsigned int slot = hashBytes(bytes, length) & (slotSpace - 1);
+
+  while (poolSlots[slot] != 0 && (strncmp(poolHandles[poolSlots[slot] - 1], bytes, length) != 0
+      || poolHandles[poolSlots[slot] - 1][length] != 0)) { // Probe until string or empty slot.
+    slot = (slot + 1) & (slotSpace - 1);
+  }
+  return slot;
+}
+
+/*
+ * Doubles the hash table and reinserts every handle.
+ */
+void growPool() {
+  int *old = poolSlots;
+
+  slotSpace = slotSpace == 0 ? 64 : slotSpace * 2;
+  poolSlots = (int*)calloc(slotSpace, sizeof(int));
+  for (int id = 0; id < poolCount; id++) { // Reinsert handles in the new table.
+    poolSlots[probePool(poolHandles[id], strlen(poolHandles[id]))] = id + 1;
+  }
+  free(old);
+}
+
+/*
+ * Gets a handle of a string, adding the string to the pool if it is not there yet.
+ *
+ * *string: string to intern.
+ * return:  handle of the string.
+ */
+char *internString(char *string) {
+  return internBytes(string, strlen(string));
+}
+
+/*
+ * Gets a handle of a string that need not end with a zero byte, like a field of a mapped 
+ * file, adding the string to the pool if it is not there yet. Pooled copy is allocated right 
+ * after its id, so stringId() does not need a lookup.
+ *
+ * *bytes: first byte of the string, which must not hold a zero byte.
+ * length: number of bytes.
+ * return: handle of the string.
+ */
+char *internBytes(char *bytes, int length) {
+  int slot;
+  int *block;
+  char *handle;
+
+  if (2 * (poolCount + 1) > slotSpace) { // Keep the table at most half full.
+    growPool();
+  }
+
+  slot = probePool(bytes, length);
+  if (poolSlots[slot] != 0) { // If string is already pooled.
+    return poolHandles[poolSlots[slot] - 1];
+  }
+
+  if (poolCount == poolSpace) { // If there is no room for another handle.
+    poolSpace   = poolSpace == 0 ? 64 : poolSpace * 2;
+    poolHandles = (char**)realloc(poolHandles, poolSpace * sizeof(char*));
+  }
+
+  block  = (int*)malloc(sizeof(int) + length + 1);
+  *block = poolCount;
+  handle = (char*)(block + 1);
+  memcpy(handle, bytes, length);
+  handle[length] = 0;
+
+  poolHandles[poolCount] = handle;
+  poolSlots[slot] = poolCount + 1;
+  poolCount++;
+
+  return handle;
+}
+
+/*
+ * Gets a handle of a string without adding it to the pool.
+ *
+ * *string: string to look up.
+ * return:  handle of the string, NULL if string was never interned.
+ */
+char *lookupString(char *string) {
+  int slot;
+
+  if (slotSpace == 0) { // If pool is empty.
+    return NULL;
+  }
+
+  slot = probePool(string, strlen(string));
+  if (poolSlots[slot] == 0) { // If string is not pooled.
+    return NULL;
+  }
+  return poolHandles[poolSlots[slot] - 1];
+}
+
+/*
+ * Gets id of a handle, stored right before the pooled string.
+ *
+ * *handle: handle of a pooled string.
+ * return:  id of the handle.
+ */
+int stringId(char *handle) {
+  return ((int*)handle)[-1];
+}
+
+/*
+ * Gets handle with a given id.
+ *
+ * id:     id of a handle.
+ * return: handle with the id.
+ */
+char *stringById(int id) {
+  return poolHandles[id];
+}
+
+/*
+ * Gets number of distinct strings in the pool.
+ *
+ * return: number of pooled strings.
+ */
+int poolSize() {
+  return poolCount;
+}
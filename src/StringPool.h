@@ -0,0 +1,96 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+/*
+ * file: StringPool.h
+ * ------------------
+ * Implements a global pool of interned strings. Each distinct string is stored once, and its
+ * pooled copy serves as a stable handle: two handles are equal only if their strings are
+ * equal, so handles are compared as pointers instead of with strcmp(). Every handle also has
+ * a dense id, assigned in order of interning.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+/*
+ * Gets a handle of a string, adding the string to the pool if it is not there yet.
+ *
+ * char*:  string to intern.
+ * return: handle of the string.
+ */
+extern char *internString(char*);
+
+/*
+ * Gets a handle of a string that need not end with a zero byte, adding it to the pool if it
+ * is not there yet.
+ *
+ * char*:  first byte of the string, which must not hold a zero byte.
+ * int:    number of bytes.
+ * return: handle of the string.
+ */
+extern char *internBytes(char*, int);
+
+/*
+ * Gets a handle of a string without adding it to the pool.
+ *
+ * char*:  string to look up.
+ * return: handle of the string, NULL if string was never interned.
+ */
+extern char *lookupString(char*);
+
+/*
+ * Gets id of a handle.
+ *
+ * char*:  handle of a pooled string.
+ * return: id of the handle.
+ */
+extern int stringId(char*);
+
+/*
+ * Gets handle with a given id.
+ *
+ * int:    id of a handle.
+ * return: handle with the id.
+ */
+extern char *stringById(int);
+
+/*
+ * Gets number of distinct strings in the pool.
+ *
+ * return: number of pooled strings.
+ */
+extern int poolSize();
+
+/*
+ * Hashes a string.
+ *
+ * char*:  string to hash.
+ * return: hash of the string.
+ */
+extern unsigned int hashString(char*);
+
+/*
+ * Hashes bytes of a string that need not end with a zero byte.
+ *
+ * char*:  first byte of the string.
+ * int:    number of bytes.
+ * return: hash of the string.
+ */
+extern unsigned int hashBytes(char*, int);
+
+/*
+ * Finds a slot of the hash table holding a string, or an empty slot where it belongs.
+ *
+ * char*:  first byte of the string to look for.
+ * int:    number of bytes.
+ * return: index of a slot.
+ */
+extern int probePool(char*, int);
+
+/*
+ * Doubles the hash table and reinserts every handle.
+ */
+extern void growPool();
+
+#endif
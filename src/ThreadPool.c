@@ -0,0 +1,176 @@
+/*
+ * file: ThreadPool.c
+ * ------------------
+ * Implements pool of worker threads that run a job split into morsels, slices of rows small
+ * enough to share out evenly. Workers and the thread that runs the job take morsels in turn
+ * until none is left. Scans and filters split their work into morsels of the current pool if
+ * one is in use, and run them one after another otherwise.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include "ThreadPool.h"
+
+static ThreadPool *currentPool = NULL; // Pool that jobs run on.
+
+/*
+ * Initialyzes a pool and starts its workers. Thread that runs a job takes morsels as well, so
+ * a pool of n threads has n - 1 workers. Workers that fail to start are left out.
+ *
+ * threads: number of threads running a job, counting the one that runs it.
+ * return:  pointer to a created pool.
+ */
+ThreadPool *createThreadPool(int threads) {
+  ThreadPool *pool = (ThreadPool*)malloc(sizeof(ThreadPool));
+  pool->threads = (pthread_t*)malloc((threads > 1 ? threads - 1 : 1) * sizeof(pthread_t));
+  pool->size    = 0;
+  pool->task    = NULL;
+  pool->job     = NULL;
+  pool->morsels = 0;
+  pool->next    = 0;
+  pool->busy    = 0;
+  pool->round   = 0;
+  pool->stop    = 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->finish, NULL);
+
+  for (int t = 1; t < threads; t++) { // Start every worker.
+    if (pthread_create(&pool->threads[pool->size], NULL, runWorker, pool) == 0) { // If started.
+      pool->size++;
+    }
+  }
+  return pool;
+}
+
+/*
+ * Stops workers of a pool, waits for them to exit and frees the pool.
+ *
+ * *pool: pointer to a pool.
+ */
+void freeThreadPool(ThreadPool *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (int t = 0; t < pool->size; t++) { // Wait for every worker.
+    pthread_join(pool->threads[t], NULL);
+  }
+  if (currentPool == pool) { // Stop running jobs on freed pool.
+    currentPool = NULL;
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->finish);
+  free(pool->threads);
+  free(pool);
+}
+
+/*
+ * Sets pool that jobs run on.
+ *
+ * *pool: pointer to a pool, NULL to run jobs in the calling thread.
+ */
+void usePool(ThreadPool *pool) {
+  currentPool = pool;
+}
+
+/*
+ * Gets number of threads running a job on the current pool.
+ *
+ * return: number of threads, 1 if no pool is in use.
+ */
+int poolThreads() {
+  return currentPool != NULL ? currentPool->size + 1 : 1;
+}
+
+/*
+ * Runs every morsel of a job on the current pool, and waits until all of them are done.
+ * Morsels are taken in no fixed order, so each one must write only its own part of the
+ * result, and the caller puts the parts together in order of the morsels. Job of a single
+ * morsel, or with no pool in use, runs in the calling thread. Current arena is kept per 
+ * thread, so morsels that workers run allocate from the heap unless they set an arena.
+ *
+ * task:    function running one morsel of the job.
+ * *job:    job passed to the function.
+ * morsels: number of morsels.
+ */
+void runMorsels(MorselTask task, void *job, int morsels) {
+  ThreadPool *pool = currentPool;
+
+  if (pool == NULL || pool->size == 0 || morsels < 2) { // If job runs in this thread.
+    for (int m = 0; m < morsels; m++) { // Run every morsel.
+      task(job, m);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->task    = task;
+  pool->job     = job;
+  pool->morsels = morsels;
+  pool->next    = 0;
+  pool->busy    = pool->size;
+  pool->round++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  takeMorsels(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->busy > 0) { // Wait for workers to finish their morsels.
+    pthread_cond_wait(&pool->finish, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/*
+ * Takes morsels of the job of a pool and runs them until none is left. Morsels are taken by
+ * an atomic counter, so threads take them without the lock.
+ *
+ * *pool: pointer to a pool.
+ */
+void takeMorsels(ThreadPool *pool) {
+  int morsel;
+
+  while ((morsel = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED))
+      < pool->morsels) { // Take morsels while any is left.
+    pool->task(pool->job, morsel);
+  }
+}
+
+/*
+ * Runs jobs of a pool as they are given, until pool stops. Worker remembers the round of its
+ * last job, so it takes part in every job exactly once.
+ *
+ * *argument: pointer to a pool.
+ * return:    NULL.
+ */
+void *runWorker(void *argument) {
+  ThreadPool *pool = (ThreadPool*)argument;
+  int round = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  while (1) { // Run jobs until pool stops.
+    while (pool->round == round && !pool->stop) { // Wait for a new job.
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stop) { // If pool stops, exit.
+      break;
+    }
+    round = pool->round;
+    pthread_mutex_unlock(&pool->lock);
+
+    takeMorsels(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->busy == 0) { // If this worker is the last one done, wake the caller.
+      pthread_cond_signal(&pool->finish);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
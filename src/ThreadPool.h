@@ -0,0 +1,90 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/*
+ * file: ThreadPool.h
+ * ------------------
+ * Implements pool of worker threads that run a job split into morsels, slices of rows small
+ * enough to share out evenly. Workers and the thread that runs the job take morsels in turn
+ * until none is left. Scans and filters split their work into morsels of the current pool if
+ * one is in use, and run them one after another otherwise.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <pthread.h>
+
+#define MORSEL_ROWS 16384 // Rows of a morsel, a multiple of 64 that divides a bitmap container.
+
+typedef void (*MorselTask)(void*, int); // Runs one morsel of a job.
+
+typedef struct { // Define pool of threads running morsels of one job at a time.
+  pthread_t *threads;
+  int size;               // Number of worker threads, the thread running a job helps them.
+  pthread_mutex_t lock;
+  pthread_cond_t start;   // Signals workers that a job was given or pool stops.
+  pthread_cond_t finish;  // Signals that the last worker is done with a job.
+  MorselTask task;
+  void *job;
+  int morsels;            // Number of morsels of the job.
+  int next;               // Next morsel to take.
+  int busy;               // Number of workers not done with the job.
+  int round;              // Number of jobs given, so workers tell a new job from the last one.
+  int stop;
+} ThreadPool;
+
+/*
+ * Initialyzes a pool and starts its workers.
+ *
+ * int:    number of threads running a job, counting the one that runs it.
+ * return: pointer to a created pool.
+ */
+extern ThreadPool *createThreadPool(int);
+
+/*
+ * Stops workers of a pool and frees it.
+ *
+ * ThreadPool*: pointer to a pool.
+ */
+extern void freeThreadPool(ThreadPool*);
+
+/*
+ * Sets pool that jobs run on.
+ *
+ * ThreadPool*: pointer to a pool, NULL to run jobs in the calling thread.
+ */
+extern void usePool(ThreadPool*);
+
+/*
+ * Gets number of threads running a job on the current pool.
+ *
+ * return: number of threads, 1 if no pool is in use.
+ */
+extern int poolThreads();
+
+/*
+ * Runs every morsel of a job on the current pool, and waits until all of them are done.
+ *
+ * MorselTask: function running one morsel of the job.
+ * void*:      job passed to the function.
+ * int:        number of morsels.
+ */
+extern void runMorsels(MorselTask, void*, int);
+
+/*
+ * Takes morsels of the job of a pool and runs them until none is left.
+ *
+ * ThreadPool*: pointer to a pool.
+ */
+extern void takeMorsels(ThreadPool*);
+
+/*
+ * Runs jobs of a pool as they are given, until pool stops.
+ *
+ * void*:  pointer to a pool.
+ * return: NULL.
+ */
+extern void *runWorker(void*);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * file: TopK.c
+ * ------------
+ * Implements top-K operator over restaurants. Keeps the best K restaurants offered to it by 
+ * rank and number of reviewers in a bounded heap, and lists them from the best one. Heap 
+ * root is the worst kept restaurant, so a restaurant is only kept if it beats the root, and 
+ * n offers take O(n log K).
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdlib.h>
+#include "TopK.h"
+#include "BinaryTree.h"
+
+/*
+ * Initialyzes an empty top-K operator.
+ *
+ * limit:  most restaurants to keep.
+ * return: pointer to a created top-K operator.
+ */
+TopK *createTopK(int limit) {
+  TopK *top = (TopK*)malloc(sizeof(TopK));
+  top->heap  = (Restaurant**)malloc((limit + 1) * sizeof(Restaurant*));
+  top->size  = 0;
+  top->limit = limit;
+
+  return top;
+}
+
+/*
+ * Offers a restaurant to a top-K operator. While fewer than K restaurants are kept, it is 
+ * added to the heap. Otherwise it replaces the root if it is better than the root.
+ *
+ * *top:        pointer to a top-K operator.
+ * *restaurant: pointer to a restaurant.
+ */
+void offerTopK(TopK *top, Restaurant *restaurant) {
+  if (top->size < top->limit) { // If heap has room, add restaurant as a leaf.
+    top->heap[top->size] = restaurant;
+    top->size++;
+    siftUpTopK(top, top->size - 1);
+  } else if (top->size > 0 
+      && compareByRank(&restaurant, &top->heap[0]) < 0) { // If better than the worst kept.
+    top->heap[0] = restaurant;
+    siftDownTopK(top, 0);
+  }
+}
+
+/*
+ * Lists kept restaurants from the best one and frees the operator. Kept restaurants are 
+ * sorted in O(K log K).
+ *
+ * *top:   pointer to a top-K operator.
+ * return: pointer to an array list of kept restaurants.
+ */
+ArrayList *finishTopK(TopK *top) {
+  ArrayList *result = createArrayList();
+
+  qsort(top->heap, top->size, sizeof(Restaurant*), compareByRank);
+  for (int i = 0; i < top->size; i++) { // Add kept restaurants in order.
+    insert(result, top->heap[i]);
+  }
+  free(top->heap);
+  free(top);
+
+  return result;
+}
+
+/*
+ * Moves a restaurant down a heap, swapping it with its worse child, until it is not better 
+ * than its children.
+ *
+ * *top:  pointer to a top-K operator.
+ * index: index of the restaurant.
+ */
+void siftDownTopK(TopK *top, int index) {
+  Restaurant **heap = top->heap;
+
+  while (2 * index + 1 < top->size) { // Walk down while restaurant has a child.
+    int child = 2 * index + 1;
+    Restaurant *moved = heap[index];
+
+    if (child + 1 < top->size 
+        && compareByRank(&heap[child + 1], &heap[child]) > 0) { // If right child is worse.
+      child++;
+    }
+    if (compareByRank(&heap[child], &moved) <= 0) { // If no child is worse.
+      return;
+    }
+    heap[index] = heap[child];
+    heap[child] = moved;
+    index = child;
+  }
+}
+
+/*
+ * Moves a restaurant up a heap, swapping it with its parent, until it is not worse than its 
+ * parent.
+ *
+ * *top:  pointer to a top-K operator.
+ * index: index of the restaurant.
+ */
+void siftUpTopK(TopK *top, int index) {
+  Restaurant **heap = top->heap;
+
+  while (index > 0) { // Walk up while restaurant has a parent.
+    int parent = (index - 1) / 2;
+    Restaurant *moved = heap[index];
+
+    if (compareByRank(&moved, &heap[parent]) <= 0) { // If parent is not better.
+      return;
+    }
+    heap[index] = heap[parent];
+    heap[parent] = moved;
+    index = parent;
+  }
+}
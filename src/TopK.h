@@ -0,0 +1,62 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+/*
+ * file: TopK.h
+ * ------------
+ * Implements top-K operator over restaurants. Keeps the best K restaurants offered to it by 
+ * rank and number of reviewers in a bounded heap, and lists them from the best one.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include "ArrayList.h"
+
+typedef struct { // Define bounded heap with the worst kept restaurant at the root.
+  Restaurant **heap;
+  int size;
+  int limit;
+} TopK;
+
+/*
+ * Initialyzes an empty top-K operator.
+ *
+ * int:    most restaurants to keep.
+ * return: pointer to a created top-K operator.
+ */
+extern TopK *createTopK(int);
+
+/*
+ * Offers a restaurant to a top-K operator.
+ *
+ * TopK*:       pointer to a top-K operator.
+ * Restaurant*: pointer to a restaurant.
+ */
+extern void offerTopK(TopK*, Restaurant*);
+
+/*
+ * Lists kept restaurants from the best one and frees the operator.
+ *
+ * TopK*:  pointer to a top-K operator.
+ * return: pointer to an array list of kept restaurants.
+ */
+extern ArrayList *finishTopK(TopK*);
+
+/*
+ * Moves a restaurant down a heap until it is not better than its children.
+ *
+ * TopK*: pointer to a top-K operator.
+ * int:   index of the restaurant.
+ */
+extern void siftDownTopK(TopK*, int);
+
+/*
+ * Moves a restaurant up a heap until it is not worse than its parent.
+ *
+ * TopK*: pointer to a top-K operator.
+ * int:   index of the restaurant.
+ */
+extern void siftUpTopK(TopK*, int);
+
+#endif
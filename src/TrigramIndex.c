@@ -0,0 +1,165 @@
+/*
+ * file: TrigramIndex.c
+ * --------------------
+ * Implements inverted index of trigrams of restaurant names. Each trigram maps to a posting 
+ * list of ids of restaurants which name has it. Names are lowercased and padded with two 
+ * spaces in front and one at the end, so a name of n bytes has n + 1 trigrams, and one edit 
+ * changes at most three of them. Trigrams are three bytes packed into an integer, and are 
+ * kept in a hash table with linear probing. Ids of removed restaurants stay in posting lists, 
+ * since shifting long lists on every removal costs more than skipping them in a search, and 
+ * ids are never reused.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "TrigramIndex.h"
+
+/*
+ * Initialyzes an empty trigram index with room for 1024 trigrams.
+ *
+ * return: pointer to a created trigram index.
+ */
+TrigramIndex *createTrigramIndex() {
+  TrigramIndex *index = (TrigramIndex*)malloc(sizeof(TrigramIndex));
+  index->space    = 2048;
+  index->count    = 0;
+  index->trigrams = (uint32_t*)calloc(index->space, sizeof(uint32_t));
+  index->lists    = (PostingList**)calloc(index->space, sizeof(PostingList*));
+
+  return index;
+}
+
+/*
+ * Adds id of a restaurant to posting lists of trigrams of its name. Creates missing posting 
+ * lists, and grows the table to keep it at most half full. Trigrams of names shorter than 64 
+ * bytes are kept on the stack.
+ *
+ * *index:      pointer to a trigram index.
+ * *restaurant: pointer to a restaurant to index.
+ */
+void indexName(TrigramIndex *index, Restaurant *restaurant) {
+  int length = strlen(restaurant->name);
+  uint32_t buffer[64];
+  uint32_t *trigrams = length < 64 ? buffer : (uint32_t*)malloc((length + 1) * sizeof(uint32_t));
+  int count = nameTrigrams(restaurant->name, trigrams);
+
+  for (int i = 0; i < count; i++) { // Add id to posting list of every trigram.
+    int slot;
+
+    if (2 * (index->count + 1) > index->space) { // Keep the table at most half full.
+      growTrigramIndex(index);
+    }
+    slot = findTrigramSlot(index, trigrams[i]);
+    if (index->trigrams[slot] == 0) { // If trigram has no posting list yet.
+      index->trigrams[slot] = trigrams[i];
+      index->lists[slot]    = createPostingList();
+      index->count++;
+    }
+    insertPosting(index->lists[slot], restaurant->id);
+  }
+  if (trigrams != buffer) { // If name was too long for the buffer.
+    free(trigrams);
+  }
+}
+
+/*
+ * Gets posting list of a trigram.
+ *
+ * *index:  pointer to a trigram index.
+ * trigram: trigram.
+ * return:  pointer to a posting list, NULL if no name has the trigram.
+ */
+PostingList *getTrigramPostings(TrigramIndex *index, uint32_t trigram) {
+  return index->lists[findTrigramSlot(index, trigram)];
+}
+
+/*
+ * Writes distinct trigrams of a name in increasing order. Name is lowercased and padded, and 
+ * every three bytes in a row make a trigram, the first one in the highest bits. Padding is a 
+ * space and names hold no zero bytes, so no trigram is 0.
+ *
+ * *name:      name.
+ * *trigrams:  array with room for length of the name plus one trigrams.
+ * return:     number of written trigrams.
+ */
+int nameTrigrams(char *name, uint32_t *trigrams) {
+  uint32_t trigram = ' ' << 8 | ' ';
+  int count = 0;
+  int distinct = 0;
+
+  for (char *curr = name; ; curr++) { // Shift every byte and the end padding in.
+    unsigned char next = *curr == 0 ? ' ' : (unsigned char)tolower((unsigned char)*curr);
+
+    trigram = (trigram << 8 | next) & 0xFFFFFF;
+    trigrams[count] = trigram;
+    count++;
+    if (*curr == 0) { // If end padding was shifted in.
+      break;
+    }
+  }
+
+  for (int i = 1; i < count; i++) { // Sort trigrams by insertion, since names are short.
+    uint32_t moved = trigrams[i];
+    int j = i;
+
+    while (j > 0 && trigrams[j - 1] > moved) { // Shift greater trigrams.
+      trigrams[j] = trigrams[j - 1];
+      j--;
+    }
+    trigrams[j] = moved;
+  }
+  for (int i = 0; i < count; i++) { // Drop repeated trigrams.
+    if (distinct == 0 || trigrams[distinct - 1] != trigrams[i]) { // If trigram is new.
+      trigrams[distinct] = trigrams[i];
+      distinct++;
+    }
+  }
+  return distinct;
+}
+
+/*
+ * Finds a slot of the hash table holding a trigram, or an empty slot where it belongs. 
+ * Trigrams are spread by a multiplicative hash, and collisions are resolved by linear 
+ * probing.
+ *
+ * *index:  pointer to a trigram index.
+ * trigram: trigram.
+ * return:  index of the slot.
+ */
+int findTrigramSlot(TrigramIndex *index, uint32_t trigram) {
+  int slot = (int)((trigram * 2654435761u) & (uint32_t)(index->space - 1));
+
+  while (index->trigrams[slot] != 0 && index->trigrams[slot] != trigram) { // Probe on.
+    slot = (slot + 1) & (index->space - 1);
+  }
+  return slot;
+}
+
+/*
+ * Doubles the hash table and reinserts every trigram with its posting list.
+ *
+ * *index: pointer to a trigram index.
+ */
+void growTrigramIndex(TrigramIndex *index) {
+  uint32_t *trigrams = index->trigrams;
+  PostingList **lists = index->lists;
+  int space = index->space;
+
+  index->space   *= 2;
+  index->trigrams = (uint32_t*)calloc(index->space, sizeof(uint32_t));
+  index->lists    = (PostingList**)calloc(index->space, sizeof(PostingList*));
+  for (int i = 0; i < space; i++) { // Reinsert every trigram.
+    if (trigrams[i] != 0) { // If slot holds a trigram.
+      int slot = findTrigramSlot(index, trigrams[i]);
+
+      index->trigrams[slot] = trigrams[i];
+      index->lists[slot]    = lists[i];
+    }
+  }
+  free(trigrams);
+  free(lists);
+}
@@ -0,0 +1,76 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+/*
+ * file: TrigramIndex.h
+ * --------------------
+ * Implements inverted index of trigrams of restaurant names. Each trigram maps to a posting 
+ * list of ids of restaurants which name has it. Names are lowercased and padded, so short 
+ * names and their ends have trigrams too. Ids of removed restaurants stay in posting lists. 
+ * Functionality includes indexing, and getting trigrams and their posting lists.
+ *
+ * author: Max Turkot
+ * version: 12/11/21
+ */
+
+#include <stdint.h>
+#include "Restaurant.h"
+#include "PostingList.h"
+
+typedef struct { // Define trigram index as a hash table of posting lists.
+  uint32_t *trigrams;  // Trigram of every slot, 0 for an empty slot.
+  PostingList **lists; // Posting list of every slot.
+  int count;
+  int space;
+} TrigramIndex;
+
+/*
+ * Initialyzes an empty trigram index.
+ *
+ * return: pointer to a created trigram index.
+ */
+extern TrigramIndex *createTrigramIndex();
+
+/*
+ * Adds id of a restaurant to posting lists of trigrams of its name.
+ *
+ * TrigramIndex*: pointer to a trigram index.
+ * Restaurant*:   pointer to a restaurant to index.
+ */
+extern void indexName(TrigramIndex*, Restaurant*);
+
+/*
+ * Gets posting list of a trigram.
+ *
+ * TrigramIndex*: pointer to a trigram index.
+ * uint32_t:      trigram.
+ * return:        pointer to a posting list, NULL if no name has the trigram.
+ */
+extern PostingList *getTrigramPostings(TrigramIndex*, uint32_t);
+
+/*
+ * Writes distinct trigrams of a name.
+ *
+ * char*:     name.
+ * uint32_t*: array with room for length of the name plus one trigrams.
+ * return:    number of written trigrams.
+ */
+extern int nameTrigrams(char*, uint32_t*);
+
+/*
+ * Finds a slot of the hash table holding a trigram, or an empty slot where it belongs.
+ *
+ * TrigramIndex*: pointer to a trigram index.
+ * uint32_t:      trigram.
+ * return:        index of the slot.
+ */
+extern int findTrigramSlot(TrigramIndex*, uint32_t);
+
+/*
+ * Doubles the hash table and reinserts every trigram.
+ *
+ * TrigramIndex*: pointer to a trigram index.
+ */
+extern void growTrigramIndex(TrigramIndex*);
+
+#endif
@@ -14,22 +14,27 @@
 #include "readFile.h"
 #include "writeFile.h"
 #include "search.h"
+#include "OpLog.h"
 
 /*
  * Runs console with a while loop. Available commands:
  * x: exit
  * p: print list of restaurant in the knowledge base
  * s: search for restaurants based on entered criteria
+ * t: search for the best restaurants by rank and number of reviewers
+ * e: explain query plan of a search
+ * f: find restaurants which name starts with a prefix
+ * z: find restaurants which name is close to a name
  * a: add a new restarurant
  * w: write restaurants to a file
+ * v: save knowledge base to a snapshot loaded on the next start, emptying the log
  * r: remove restaurant from all indexing structures
  * Any other character command will produce an error and 
  * wait for a new command.
  *
- * *btName: pointer to a binary tree with NAME ordering rule.
- * *btCity: pointer to a binary tree with LOCATION ordering rule.
+ * *kb: pointer to a knowledge base of restaurants.
  */
-void runConsole(BinaryTree *btName, BinaryTree *btCity) {
+void runConsole(KnowledgeBase *kb) {
   ArrayList *result;
   char *input = malloc(64 * sizeof(char));
   int match;
@@ -38,6 +43,10 @@ void runConsole(BinaryTree *btName, BinaryTree *btCity) {
   char *city;
   char *categories;
   char *cost;
+  char *rank;
+  char *reviewers;
+  char *open;
+  char *limit;
   // time
 
   printf("Welcome to mini-Yelp\n");
@@ -49,23 +58,55 @@ void runConsole(BinaryTree *btName, BinaryTree *btCity) {
     
     if (strcmp(input, "print") == 0 || strcmp(input, "p") == 0) { // Identify print.
       printf("\nrestaurants:\n\n");
-      printf("%s", toStringBinaryTree(btName));
-      printf("\nprint finished\n");
+      writeBinaryTree(kb->btName, stdout);
+      printf("print finished\n");
     } else if (strcmp(input, "search") == 0 || strcmp(input, "s") == 0) { // Identify search.
       printf("enter search criteria:\n");
-      getParam(&city, &cost, &categories);
-      // result = search(arrayList, city, cost, categories);
+      getParam(&city, &cost, &categories, &rank, &reviewers, &open);
+      result = search(kb, city, cost, categories, rank, reviewers, open);
       printf("\nresults:\n\n");
-      // printAll(result);
+      writeArrayList(result, stdout);
       printf("search finished\n");
+    } else if (strcmp(input, "top") == 0 || strcmp(input, "t") == 0) { // Identify top.
+      printf("enter search criteria:\n");
+      getParam(&city, &cost, &categories, &rank, &reviewers, &open);
+      limit = getLimit();
+      result = searchTop(kb, city, cost, categories, rank, reviewers, open, 
+          strcmp(limit, "*") == 0 ? -1 : atoi(limit));
+      printf("\nresults:\n\n");
+      writeArrayList(result, stdout);
+      printf("top finished\n");
+    } else if (strcmp(input, "explain") == 0 || strcmp(input, "e") == 0) { // Identify explain.
+      printf("enter search criteria:\n");
+      getParam(&city, &cost, &categories, &rank, &reviewers, &open);
+      printf("\nplan:\n\n");
+      explainSearch(kb, city, cost, categories, rank, reviewers, open, stdout);
+      printf("explain finished\n");
+    } else if (strcmp(input, "prefix") == 0 || strcmp(input, "f") == 0) { // Identify prefix.
+      result = callPrefix(kb);
+      printf("\nresults:\n\n");
+      writeArrayList(result, stdout);
+      printf("prefix finished\n");
+    } else if (strcmp(input, "fuzzy") == 0 || strcmp(input, "z") == 0) { // Identify fuzzy.
+      result = callFuzzy(kb);
+      printf("\nresults:\n\n");
+      writeArrayList(result, stdout);
+      printf("fuzzy finished\n");
     } else if (strcmp(input, "add") == 0 || strcmp(input, "a") == 0) { // Identify add.
-      addRestaurant(btName, btCity);
-      printf("\nrestaurant added\n");
+      if (addRestaurant(kb) == 0) { // If restaurant was added.
+        printf("\nrestaurant added\n");
+      } else { // Restaurant with the name and city exists.
+        printf("\nrestaurant already exists\n");
+      }
     } else if (strcmp(input, "write") == 0 || strcmp(input, "w") == 0) { // Identify write.
-      callWrite(btName);
+      callWrite(kb);
       printf("\nwrite finished\n");
+    } else if (strcmp(input, "save") == 0 || strcmp(input, "v") == 0) { // Identify save.
+      if (compactLog(kb) == 0) { // If snapshot and a new log were written.
+        printf("\nsave finished\n");
+      }
     } else if (strcmp(input, "remove") == 0 || strcmp(input, "r") == 0) { // Identify remove.
-      callRemove(btName, btCity);
+      callRemove(kb);
       printf("\nremove finished\n");
     } else if (strcmp(input, "exit") == 0 || strcmp(input, "x") == 0) { // Identify exit.
       printf("exiting...\n");
@@ -82,14 +123,21 @@ void runConsole(BinaryTree *btName, BinaryTree *btCity) {
  * **city:       pointer to the string of restaurant's city.
  * **cost:       pointer to the string of restaurant's cost.
  * **categories: pointer to the string of restaurant's categories.
+ * **rank:       pointer to the string of restaurant's rank.
+ * **reviewers:  pointer to the string of restaurant's number of reviewers.
+ * **open:       pointer to the string of a moment restaurant is open at.
  */
-void getParam(char **city, char **cost, char **categories) {
+void getParam(char **city, char **cost, char **categories, char **rank, char **reviewers, 
+    char **open) {
   char* cityEdit;
   char* costEdit;
   char* categoriesEdit;
   *city       = malloc(64 * sizeof(char));
   *cost       = malloc(64 * sizeof(char));
   *categories = malloc(64 * sizeof(char));
+  *rank       = malloc(64 * sizeof(char));
+  *reviewers  = malloc(64 * sizeof(char));
+  *open       = malloc(64 * sizeof(char));
 
   printf("- city: ");
   fgets(*city, 64, stdin);
@@ -111,19 +159,33 @@ void getParam(char **city, char **cost, char **categories) {
   categoriesEdit = *categories;
   categoriesEdit[strcspn(categoriesEdit, "\n")] = 0;
   strcpy(*categories, categoriesEdit);
+
+  printf("- rank: ");
+  fgets(*rank, 64, stdin);
+  (*rank)[strcspn(*rank, "\n")] = 0;
+
+  printf("- reviewers: ");
+  fgets(*reviewers, 64, stdin);
+  (*reviewers)[strcspn(*reviewers, "\n")] = 0;
+
+  printf("- open at: ");
+  fgets(*open, 64, stdin);
+  (*open)[strcspn(*open, "\n")] = 0;
 }
 
 /*
  * Adds a new restaurant to the indexing structures. Prompts user for restaurant paramenters, 
- * creates a restaurant, and inserts it into indexing structures.
+ * creates a restaurant, and adds it to the knowledge base. Restaurant is not added if one 
+ * with the same name and city already exists. Added restaurant is appended to the log.
  * 
- * *btName: pointer to a binary tree with NAME ordering rule.
- * *btCity: pointer to a binary tree with LOCATION ordering rule.
+ * *kb:    pointer to a knowledge base of restaurants.
+ * return: 0 if restaurant was added, -1 if it already exists.
  */
-void addRestaurant(BinaryTree *btName, BinaryTree *btCity) {
+int addRestaurant(KnowledgeBase *kb) {
   char *name       = malloc(64 * sizeof(char));
   char *city       = malloc(64 * sizeof(char));
   char *categ = malloc(64 * sizeof(char));
+  char *hours      = malloc(256 * sizeof(char));
   char *cost       = malloc(6  * sizeof(char));
   char *rankStr    = malloc(6  * sizeof(char));
   char *reviewsStr = malloc(16 * sizeof(char));
@@ -143,6 +205,10 @@ void addRestaurant(BinaryTree *btName, BinaryTree *btCity) {
   fgets(categ, 64, stdin);
   categ[strcspn(categ, "\n")] = 0;
 
+  printf("- hours: ");
+  fgets(hours, 256, stdin);
+  hours[strcspn(hours, "\n")] = 0;
+
   printf("- cost: ");
   fgets(cost, 6, stdin);
   cost[strcspn(cost, "\n")]   = 0;
@@ -153,39 +219,50 @@ void addRestaurant(BinaryTree *btName, BinaryTree *btCity) {
   printf("- reviews: ");
   fgets(reviewsStr, 6, stdin);
   
+  if (searchKnowledgeBase(kb, name, city) != NULL) { // If restaurant already exists.
+    return -1;
+  }
+
   categList = makeCategoryList(categ);
   rank = atof(rankStr);
   reviews = atof(reviewsStr);
-  Restaurant *restaurant = initRestaurant(name, city, categList, cost, rank, reviews);
+  Restaurant *restaurant = initRestaurant(name, city, categList, hours, cost, rank, 
+      reviews);
   
-  insertInBinaryTree(btName, restaurant);
-  insertInBinaryTree(btCity, restaurant);
+  addToKnowledgeBase(kb, restaurant);
+  logAdd(restaurant);
+  commitLog();
+
+  return 0;
 }
 
 /*
- * Calls write funciton to write restaurants to a file. Prompts for filename of a new file.
+ * Calls write funciton to write restaurants to a file. Prompts for filename of a new file. 
+ * Restaurants are written in order of the name tree. If the file is the base loaded on the
+ * next start, the log is started again on it.
  *
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
+ * *kb: pointer to a knowledge base of restaurants.
  */
-void callWrite(BinaryTree *btName) {
+void callWrite(KnowledgeBase *kb) {
   char *fileName = malloc(64 * sizeof(char));
-  char *string = toStringBinaryTree(btName);
 
   printf("- file name: ");
   fgets(fileName, 64, stdin);
   fileName[strcspn(fileName, "\n")] = 0;
 
-  writeFile(fileName, string);
+  if (writeFile(fileName, kb->btName) == 0) { // If file was written, it may be the new base.
+    rebaseLog(fileName);
+  }
 }
 
 /*
  * Calls remove funciton to remove element from indexing structures. Prompts for name and
- * location of an element to remove. Calls removeBT() funciton for each binary tree.
+ * location of an element to remove. Removes matching restaurants from the knowledge base,
+ * and appends the remove to the log if any matched.
  *
- * btName: pointer to a binary tree with NAME ordering rule.
- * btLocation: pointer to a binery tree with LOCATION ordering rule.
+ * *kb: pointer to a knowledge base of restaurants.
  */
-void callRemove(BinaryTree *btName, BinaryTree *btCity) {
+void callRemove(KnowledgeBase *kb) {
   char *name     = malloc(64 * sizeof(char));
   char *location = malloc(64 * sizeof(char));
 
@@ -197,6 +274,70 @@ void callRemove(BinaryTree *btName, BinaryTree *btCity) {
   fgets(location, 64, stdin);
   location[strcspn(location, "\n")] = 0;
 
-  removeBT(btName, name, location);
-  removeBT(btCity, name, location);
+  if (removeFromKnowledgeBase(kb, name, location) > 0) { // If restaurants were removed, log it.
+    logRemove(name, location);
+    commitLog();
+  }
+}
+
+/*
+ * Calls prefix function to find restaurants which name starts with a prefix. Prompts for the 
+ * prefix and the most restaurants to find, "*" for no limit. Restaurants are found in order 
+ * of the name tree, which stops being scanned past the prefix or the limit.
+ *
+ * *kb:    pointer to a knowledge base of restaurants.
+ * return: pointer to an array list of found restaurants.
+ */
+ArrayList *callPrefix(KnowledgeBase *kb) {
+  char *prefix = malloc(64 * sizeof(char));
+  char *limit;
+
+  printf("- prefix: ");
+  fgets(prefix, 64, stdin);
+  prefix[strcspn(prefix, "\n")] = 0;
+
+  limit = getLimit();
+
+  return prefixBinaryTree(kb->btName, prefix, strcmp(limit, "*") == 0 ? -1 : atoi(limit));
+}
+
+/*
+ * Calls fuzzy search to find restaurants which name is within an edit distance of a name, 
+ * ignoring case. Prompts for the name, the greatest distance and the most restaurants to 
+ * find, "*" for no limit. Restaurants are found from the closest one.
+ *
+ * *kb:    pointer to a knowledge base of restaurants.
+ * return: pointer to an array list of found restaurants.
+ */
+ArrayList *callFuzzy(KnowledgeBase *kb) {
+  char *name = malloc(64 * sizeof(char));
+  char *distance = malloc(64 * sizeof(char));
+  char *limit;
+
+  printf("- name: ");
+  fgets(name, 64, stdin);
+  name[strcspn(name, "\n")] = 0;
+
+  printf("- distance: ");
+  fgets(distance, 64, stdin);
+  distance[strcspn(distance, "\n")] = 0;
+
+  limit = getLimit();
+
+  return fuzzySearch(kb, name, atoi(distance), strcmp(limit, "*") == 0 ? -1 : atoi(limit));
+}
+
+/*
+ * Queries the user for the most results to show, "*" for no limit.
+ *
+ * return: entered string.
+ */
+char *getLimit() {
+  char *limit = malloc(64 * sizeof(char));
+
+  printf("- limit: ");
+  fgets(limit, 64, stdin);
+  limit[strcspn(limit, "\n")] = 0;
+
+  return limit;
 }
@@ -12,6 +12,7 @@
 
 #include "ArrayList.h"
 #include "BinaryTree.h"
+#include "KnowledgeBase.h"
 
 /*
  * Runs console interface. Available commands:
@@ -24,10 +25,9 @@
  * Any other character command will produce an error and
  * wait for a new command.
  *
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
  */
-extern void runConsole(BinaryTree*, BinaryTree*);
+extern void runConsole(KnowledgeBase*);
 
 /*
  * Queries the user for parameters.
@@ -35,31 +35,58 @@ extern void runConsole(BinaryTree*, BinaryTree*);
  * char**: pointer to the string of restaurant's city.
  * char**: pointer to the string of restaurant's cost.
  * char*8: pointer to the string of restaurant's categories.
+ * char**: pointer to the string of restaurant's rank.
+ * char**: pointer to the string of restaurant's number of reviewers.
+ * char**: pointer to the string of a moment restaurant is open at.
  */
-extern void getParam(char**, char**, char**);
+extern void getParam(char**, char**, char**, char**, char**, char**);
 
 /*
  * Adds a new restaurant to the indexing structures.
  * 
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
+ * return:         0 if restaurant was added, -1 if it already exists.
  */
-extern void addRestaurant(BinaryTree*, BinaryTree*);
+extern int addRestaurant(KnowledgeBase*);
 
 /*
  * Calls write funciton to write restaurants to a file. Prompts for filename of a new file.
  * 
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
  */
-extern void callWrite(BinaryTree*);
+extern void callWrite(KnowledgeBase*);
 
 /*
  * Calls remove funciton to remove element from indexing structures. Prompts for name and 
  * location of an element to remove.
  * 
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binery tree with LOCATION ordering rule.
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
  */
-extern void callRemove(BinaryTree*, BinaryTree*);
+extern void callRemove(KnowledgeBase*);
+
+/*
+ * Calls prefix function to find restaurants which name starts with a prefix. Prompts for the 
+ * prefix and the most restaurants to find.
+ * 
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
+ * return:         pointer to an array list of found restaurants.
+ */
+extern ArrayList *callPrefix(KnowledgeBase*);
+
+/*
+ * Calls fuzzy search to find restaurants which name is within an edit distance of a name. 
+ * Prompts for the name, the greatest distance and the most restaurants to find.
+ * 
+ * KnowledgeBase*: pointer to a knowledge base of restaurants.
+ * return:         pointer to an array list of found restaurants.
+ */
+extern ArrayList *callFuzzy(KnowledgeBase*);
+
+/*
+ * Queries the user for the most results to show.
+ *
+ * return: entered string, "*" for no limit.
+ */
+extern char *getLimit();
 
 #endif
@@ -8,22 +8,80 @@
  * version: 12/10/21
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 #include "main.h"
 #include "ArrayList.h"
 #include "BinaryTree.h"
+#include "KnowledgeBase.h"
 #include "console.h"
 #include "readFile.h"
+#include "Arena.h"
+#include "ThreadPool.h"
+#include "Snapshot.h"
+#include "OpLog.h"
 
 /*
- * Initiates binary trees of restaruants using readFile from restaurants.txt file. Calls 
- * console.
+ * Initiates knowledge base of restaruants using readFile from restaurants.txt file, or from
+ * the snapshot the save command writes if it is newer and valid, and replays the log of edits
+ * made since on top of it. Calls console. Restaurants, lists and tree nodes are allocated 
+ * from an arena that is released at once on exit. Loading, scans and filters run on a pool of 
+ * threads, one per processor by default. Options:
+ * -b:   store indexes in B+ trees instead of AVL trees.
+ * -t n: load file and run scans and filters on n threads, 1 to run them in the main thread.
+ * -s n: sync the log of edits to disk once n edits are written to it, 0 to leave it to the
+ *       system; 1 by default, so every edit is durable once its command finishes.
+ *
+ * argc:   number of command line arguments.
+ * **argv: command line arguments.
  */
-int main() {
-  BinaryTree *btName = createBinaryTree(NAME);
-  BinaryTree *btCity = createBinaryTree(LOCATION);
-  readFile("restaurants.txt", btName, btCity);
+int main(int argc, char **argv) {
+  TreeBackend backend = AVL;
+  int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  ThreadPool *pool = NULL;
+  int syncEvery = 1;
+  char *base = SNAPSHOT_FILE;
+  OpLog *log;
+  int option;
+
+  while ((option = getopt(argc, argv, "bt:s:")) != -1) { // Read command line options.
+    if (option == 'b') { // Use B+ trees.
+      backend = BPLUS;
+    } else if (option == 't' && atoi(optarg) > 0) { // Use given number of threads.
+      threads = atoi(optarg);
+    } else if (option == 's' && atoi(optarg) >= 0) { // Sync log after given number of edits.
+      syncEvery = atoi(optarg);
+    } else { // Option unknown or invalid.
+      fprintf(stderr, "usage: %s [-b] [-t threads] [-s edits]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (threads > 1) { // If loading, scans and filters share out work, start workers.
+    pool = createThreadPool(threads);
+    usePool(pool);
+  }
+
+  Arena *arena = createArena();
+  useArena(arena);
+
+  KnowledgeBase *kb = createKnowledgeBase(backend);
+  if (!isSnapshotNewer(SNAPSHOT_FILE, TEXT_FILE)
+      || loadSnapshot(SNAPSHOT_FILE, kb) != 0) { // If there is no valid snapshot, parse text.
+    base = TEXT_FILE;
+    readFile(base, kb);
+  }
+  log = openOpLog(OPLOG_FILE, base, kb, syncEvery);
+  useOpLog(log);
+
+  runConsole(kb);
+
+  closeOpLog(log);
 
-  runConsole(btName, btCity);
+  releaseArena(arena);
+  if (pool != NULL) { // If workers were started, stop them.
+    freeThreadPool(pool);
+  }
 
   return 0;
 }
@@ -16,7 +16,10 @@
 
 /*
  * Runs the program. Initiates binary tree of restaruants from restaurants.txt file.
+ *
+ * int:    number of command line arguments.
+ * char**: command line arguments.
  */
-extern int main();
+extern int main(int, char**);
 
 #endif
@@ -7,121 +7,437 @@
  * version: 12/10/21
  */
 
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "readFile.h"
+#include "StringPool.h"
+#include "Arena.h"
 
 /*
- * Reads data about restaurants from a file with a passed name. Reads file line by line, and 
- * depending on the line counter, stores line's value in corresponding restaurant's field. If 
- * file cannot be opened, prints an arror. Data is stored in binary trees.
+ * Reads data about restaurants from a file with a passed name. File is mapped in memory and 
+ * parsed in place, see parseFile(), and files that cannot be mapped, like pipes, are read 
+ * whole instead. If file cannot be opened, prints an arror. Restaurants are collected in an 
+ * array list and then loaded in the knowledge base at once, so its trees are built bottom-up.
  * 
  * fileName: name of file to be read.
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
+ * *kb:      pointer to a knowledge base to store restaurants in.
  */
-void readFile(char *fileName, BinaryTree *btName, BinaryTree *btCity) {
-  FILE *file = fopen(fileName, "r");
-  char *name         = malloc(64 * sizeof(char));
-  char *city         = malloc(64 * sizeof(char));
-  char *categories   = malloc(64 * sizeof(char));
-  char *cost         = malloc(64 * sizeof(char));
-  float rank         = 0;
-  int reviewers      = 0;
-  int lineCnt        = 0;
-
-  if (file == NULL) { // Check if file wasn't opened.
+void readFile(char *fileName, KnowledgeBase *kb) {
+  int descriptor = open(fileName, O_RDONLY);
+  ArrayList *loaded = createArrayList();
+  struct stat status;
+  char *text = MAP_FAILED;
+  size_t size = 0;
+
+  if (descriptor == -1 || fstat(descriptor, &status) == -1) { // Check if file wasn't opened.
     perror("In readFile.c");
-  } 
- 
-  char *line = 0;
-  size_t len = 0;
-
-  while(getline(&line, &len, file) != -1) { // Read file line by line.
-    switch(lineCnt % 8) { // Check what line is being read.
-      case 0:
-        strcpy(name, line);
-        name[strcspn(name, "\n")] = 0; 
-	      break;
-      case 1:
-        strcpy(city, line);
-        city[strcspn(city, "\n")] = 0; 
-        break;
-      case 2:
-        strcpy(categories, line);
-        categories[strcspn(categories, "\n")] = 0; 
-        break;
-      case 3:
-        // whenOpen todo
-        // name[strcspn(name, "\n")] = 0; 
-	      break;
-      case 4:
-        strcpy(cost, line);
-        cost[strcspn(cost, "\n")] = 0; 
-        break;
-      case 5:
-        rank = atof(line);
-        break;
-      case 6:
-        reviewers = atoi(line);
-        
-        saveInsert(btName, btCity, name, city, categories, cost, rank, reviewers);
-	      break;
+    if (descriptor != -1) { // If file was opened, close it.
+      close(descriptor);
+    }
+    return;
+  }
+
+  if (S_ISREG(status.st_mode) && status.st_size > 0) { // If file can be mapped, map it.
+    size = status.st_size;
+    text = (char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  }
+  if (text != MAP_FAILED) { // If file is mapped, read it in order.
+    madvise(text, size, MADV_SEQUENTIAL);
+    parseFile(text, size, loaded);
+    munmap(text, size);
+  } else { // Read file whole.
+    text = readWhole(descriptor, &size);
+    parseFile(text, size, loaded);
+    free(text);
+  }
+  close(descriptor);
+  loadKnowledgeBase(kb, loaded);
+}
+
+/*
+ * Reads a file that cannot be mapped from its current position to its end.
+ *
+ * descriptor: descriptor of an open file.
+ * *size:      pointer to the number of read bytes.
+ * return:     read bytes, to be freed.
+ */
+char *readWhole(int descriptor, size_t *size) {
+  size_t space = 65536;
+  char *text = (char*)malloc(space);
+  ssize_t got;
+
+  *size = 0;
+  while ((got = read(descriptor, text + *size, space - *size)) > 0) { // Read until the end.
+    *size += got;
+    if (*size == space) { // If buffer is full, grow it.
+      space *= 2;
+      text = (char*)realloc(text, space);
+    }
+  }
+  return text;
+}
+
+/*
+ * Parses restaurants from the bytes of a file. Every record takes eight lines, the seven 
+ * fields of a restaurant and a blank line, and the number of a line within the file tells 
+ * which field it holds. With a thread pool in use, file is cut into chunks that start at 
+ * records, up to CHUNKS_PER_THREAD per thread and at least CHUNK_BYTES each, see cutChunks(), 
+ * and chunks are parsed at the same time, each one into a batch of its own, see parseChunk(). 
+ * Batches are then pooled and collected in order of the file, so restaurants and handles of 
+ * strings are the same as when the file is parsed as a single chunk.
+ *
+ * *text:   first byte of the file.
+ * size:    number of bytes.
+ * *loaded: pointer to an array list to store restaurants in.
+ */
+void parseFile(char *text, size_t size, ArrayList *loaded) {
+  Arena *arena = getArena();
+  size_t most = size / CHUNK_BYTES;
+  int count = poolThreads() * CHUNKS_PER_THREAD;
+  FileChunk *chunks;
+
+  count  = poolThreads() == 1 || most < 2 ? 1 : most < (size_t)count ? (int)most : count;
+  chunks = (FileChunk*)calloc(count, sizeof(FileChunk));
+  cutChunks(chunks, count, text, size);
+  for (int c = 0; c < count && count > 1 && arena != NULL; c++) { // Give chunks arenas.
+    chunks[c].arena = createArena();
+  }
+  runMorsels(parseChunk, chunks, count);
+
+  for (int c = 0; c < count; c++) { // Pool and collect restaurants of every chunk.
+    FileChunk *chunk = &chunks[c];
+
+    for (int r = 0; r < chunk->count; r++) { // Pool and collect every restaurant.
+      poolRecord(chunk->restaurants[r], &chunk->fields[r]);
+      insert(loaded, chunk->restaurants[r]);
+    }
+    if (chunk->arena != NULL) { // If chunk had an arena, release it with the current one.
+      mergeArena(arena, chunk->arena);
+    }
+    free(chunk->restaurants);
+    free(chunk->fields);
+  }
+  free(chunks);
+}
+
+/*
+ * Cuts bytes of a file into chunks that start at records. Bytes are first split evenly and 
+ * newlines of every part are counted at the same time, see countChunk(), so the number of the 
+ * line every part starts in is known. Chunk then starts at the first line of a record in its 
+ * part or after it, which is one of the next eight lines.
+ *
+ * *chunks: chunks to fill.
+ * count:   number of chunks.
+ * *text:   first byte of the file.
+ * size:    number of bytes.
+ */
+void cutChunks(FileChunk *chunks, int count, char *text, size_t size) {
+  char *end = text + size;
+  size_t line = 0;
+
+  for (int c = 0; c < count; c++) { // Split bytes evenly.
+    chunks[c].text = text + size * c / count;
+    chunks[c].size = size * (c + 1) / count - size * c / count;
+  }
+  runMorsels(countChunk, chunks, count > 1 ? count : 0);
+
+  for (int c = 1; c < count; c++) { // Move start of every chunk but the first to a record.
+    char *start = chunks[c].text;
+    size_t number;
+
+    line  += chunks[c - 1].lines;
+    number = line;
+
+    if (start[-1] != '\n') { // If part starts inside a line, go to the next one.
+      start = nextLine(start, end);
+      number++;
+    }
+    while (start < end && number % 8 != 0) { // Skip lines until a record starts.
+      start = nextLine(start, end);
+      number++;
+    }
+    chunks[c].text = start > chunks[c - 1].text ? start : chunks[c - 1].text;
+  }
+  for (int c = 0; c < count; c++) { // Set sizes to reach the next chunk.
+    chunks[c].size = (c + 1 < count ? chunks[c + 1].text : end) - chunks[c].text;
+  }
+}
+
+/*
+ * Counts newlines in the bytes of one chunk.
+ *
+ * *job:  array of chunks.
+ * index: index of the chunk.
+ */
+void countChunk(void *job, int index) {
+  FileChunk *chunk = (FileChunk*)job + index;
+  char *text = chunk->text;
+  char *end = text + chunk->size;
+
+  chunk->lines = 0;
+  while ((text = (char*)memchr(text, '\n', end - text)) != NULL) { // Count every newline.
+    chunk->lines++;
+    text++;
+  }
+}
+
+/*
+ * Finds the start of the line after the one a byte is in.
+ *
+ * *text:  byte in a line.
+ * *end:   byte past the file.
+ * return: first byte of the next line, or end if there is none.
+ */
+char *nextLine(char *text, char *end) {
+  char *newline = (char*)memchr(text, '\n', end - text);
+
+  return newline != NULL ? newline + 1 : end;
+}
+
+/*
+ * Parses restaurants from the bytes of one chunk, which starts at a record. Lines are found 
+ * with memchr(), which tests many bytes at a time, and fields are left where they are until 
+ * a restaurant is built from them, see parseRecord(). Restaurants are allocated from the 
+ * arena of the chunk, if it has one, and strings to be pooled are kept in its batch, since 
+ * the string pool is not shared between threads. Last line need not end with a newline.
+ *
+ * *job:  array of chunks.
+ * index: index of the chunk.
+ */
+void parseChunk(void *job, int index) {
+  FileChunk *chunk = (FileChunk*)job + index;
+  Arena *previous = getArena();
+  char *text = chunk->text;
+  char *end = text + chunk->size;
+  char *lines[7];
+  int lengths[7];
+  int lineCnt = 0;
+  char *hours = (char*)malloc(64);
+  int space = 64;
+
+  if (chunk->arena != NULL) { // If chunk has an arena, allocate from it.
+    useArena(chunk->arena);
+  }
+  chunk->space       = 64;
+  chunk->restaurants = (Restaurant**)malloc(chunk->space * sizeof(Restaurant*));
+  chunk->fields      = (RecordFields*)malloc(chunk->space * sizeof(RecordFields));
+  while (text < end) { // Read bytes line by line.
+    char *newline = (char*)memchr(text, '\n', end - text);
+    int length = (newline != NULL ? newline : end) - text;
+
+    if (lineCnt % 8 < 7) { // If line holds a field, keep where it is.
+      lines[lineCnt % 8]   = text;
+      lengths[lineCnt % 8] = length;
+    }
+    if (lineCnt % 8 == 6 && chunk->count == chunk->space) { // If batch is full, grow it.
+      chunk->space      *= 2;
+      chunk->restaurants = (Restaurant**)realloc(chunk->restaurants, 
+          chunk->space * sizeof(Restaurant*));
+      chunk->fields      = (RecordFields*)realloc(chunk->fields, 
+          chunk->space * sizeof(RecordFields));
     }
+    if (lineCnt % 8 == 6) { // If record is complete, build its restaurant.
+      chunk->restaurants[chunk->count] = parseRecord(lines, lengths, &hours, &space, 
+          &chunk->fields[chunk->count]);
+      chunk->count++;
+    }
+    text = newline != NULL ? newline + 1 : end;
     lineCnt++;
   }
-  fclose(file);
-  free(line);
-  free(name);
-  free(city);
-  free(cost);
+  useArena(previous);
+  free(hours);
+}
+
+/*
+ * Builds a restaurant from the lines of its record, all but the fields that are pooled. Text 
+ * fields end at the first carriage return or zero byte. Name is copied once to memory the 
+ * restaurant keeps, and city, cost and categories are kept as bytes of the lines, see 
+ * poolRecord(). Opening hours are parsed from a copy that ends with a zero byte. Rank and 
+ * number of reviewers are read like atof() and atoi() would.
+ *
+ * **lines:  first bytes of the seven lines of a record.
+ * *lengths: lengths of the lines, without newlines.
+ * **hours:  pointer to a buffer for the opening hours line, grown as needed.
+ * *space:   pointer to the size of the buffer.
+ * *fields:  pointer to fields to fill with the bytes of city, cost and categories.
+ * return:   pointer to a created restaurant.
+ */
+Restaurant *parseRecord(char **lines, int *lengths, char **hours, int *space, 
+    RecordFields *fields) {
+  int length = fieldLength(lines[0], lengths[0]);
+  char *name = (char*)allocate(length + 1);
+
+  memcpy(name, lines[0], length);
+  name[length] = 0;
+
+  fields->categories       = lines[2];
+  fields->categoriesLength = fieldLength(lines[2], lengths[2]);
+  fields->city             = lines[1];
+  fields->cityLength       = fieldLength(lines[1], lengths[1]);
+  fields->cost             = lines[4];
+  fields->costLength       = fieldLength(lines[4], lengths[4]);
+
+  length = fieldLength(lines[3], lengths[3]);
+  if (length + 1 > *space) { // If hours do not fit in the buffer, grow it.
+    *space = length + 1;
+    *hours = (char*)realloc(*hours, *space);
+  }
+  memcpy(*hours, lines[3], length);
+  (*hours)[length] = 0;
+
+  return initPooledRestaurant(name, NULL, NULL, *hours, NULL, 
+      (float)parseDecimal(lines[5], strnlen(lines[5], lengths[5])), 
+      parseInteger(lines[6], strnlen(lines[6], lengths[6])));
+}
+
+/*
+ * Sets categories, city and cost of a parsed restaurant, interned straight from the bytes of 
+ * its record, in that order.
+ *
+ * *restaurant: pointer to a restaurant built by parseRecord().
+ * *fields:     pointer to bytes of its city, cost and categories.
+ */
+void poolRecord(Restaurant *restaurant, RecordFields *fields) {
+  restaurant->categories = splitCategories(fields->categories, fields->categoriesLength);
+  restaurant->city       = internBytes(fields->city, fields->cityLength);
+  restaurant->cost       = internBytes(fields->cost, fields->costLength);
+}
+
+/*
+ * Gets length of a text field in a line, up to the first carriage return or zero byte.
+ *
+ * *line:  first byte of the line.
+ * length: length of the line, without its newline.
+ * return: length of the field.
+ */
+int fieldLength(char *line, int length) {
+  char *carriage;
+
+  length   = strnlen(line, length);
+  carriage = (char*)memchr(line, '\r', length);
+  return carriage != NULL ? carriage - line : length;
+}
+
+/*
+ * Reads a decimal number from bytes like atof() in the "C" locale, without a zero byte at 
+ * its end. Plain numbers of at most 15 digits are read digit by digit, and then divided by a 
+ * power of ten, which is exact, so one correctly rounded division gives what strtod() does. 
+ * Exponents, hexadecimal numbers, infinities and longer numbers are left to strtod().
+ *
+ * *text:  first byte of the number, leading spaces allowed.
+ * length: number of bytes, none of them zero.
+ * return: read number, 0 if bytes do not start with one.
+ */
+double parseDecimal(char *text, int length) {
+  static const double powers[16] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 
+      1e11, 1e12, 1e13, 1e14, 1e15};
+  int i = 0;
+  int negative;
+  int digits = 0;
+  int fraction = 0;
+  uint64_t mantissa = 0;
+
+  while (i < length && isspace((unsigned char)text[i])) { // Skip leading spaces.
+    i++;
+  }
+  negative = i < length && text[i] == '-';
+  i += i < length && (text[i] == '-' || text[i] == '+');
+  for (; i < length && isdigit((unsigned char)text[i]); i++, digits++) { // Read integer part.
+    mantissa = mantissa * 10 + (text[i] - '0');
+  }
+  if (i < length && text[i] == '.') { // If number has a fraction, read it.
+    for (i++; i < length && isdigit((unsigned char)text[i]); i++, fraction++) { // Read digit.
+      mantissa = mantissa * 10 + (text[i] - '0');
+    }
+  }
+  if (digits + fraction == 0 || digits + fraction > 15 
+      || (i < length && strchr("eExXpP", text[i]) != NULL)) { // If number is not plain.
+    char *copy = (char*)malloc(length + 1);
+    double value;
+
+    memcpy(copy, text, length);
+    copy[length] = 0;
+    value = strtod(copy, NULL);
+    free(copy);
+    return value;
+  }
+  return (negative ? -1.0 : 1.0) * ((double)mantissa / powers[fraction]);
 }
 
 /*
- * Creates a linked list of strings from a single comma-space-separated string.
+ * Reads an integer from bytes like atoi() does, without a zero byte at its end. Numbers of at 
+ * most 18 digits are read digit by digit, and longer ones are left to strtol().
+ *
+ * *text:  first byte of the number, leading spaces allowed.
+ * length: number of bytes, none of them zero.
+ * return: read number, 0 if bytes do not start with one.
+ */
+int parseInteger(char *text, int length) {
+  int i = 0;
+  int negative;
+  int digits = 0;
+  long value = 0;
+
+  while (i < length && isspace((unsigned char)text[i])) { // Skip leading spaces.
+    i++;
+  }
+  negative = i < length && text[i] == '-';
+  i += i < length && (text[i] == '-' || text[i] == '+');
+  for (; i < length && isdigit((unsigned char)text[i]); i++, digits++) { // Read digit.
+    value = value * 10 + (text[i] - '0');
+  }
+  if (digits > 18) { // If number may not fit, leave it to strtol().
+    char *copy = (char*)malloc(length + 1);
+
+    memcpy(copy, text, length);
+    copy[length] = 0;
+    value = strtol(copy, NULL, 10);
+    free(copy);
+    return (int)value;
+  }
+  return (int)(negative ? -value : value);
+}
+
+/*
+ * Creates a linked list of strings from a single comma-space-separated string, see 
+ * splitCategories().
  *
  * *categories: string read from a file containing comma-space-separated values.
  * return:      a linked list of strings of categories.
  */
 LinkedList *makeCategoryList(char *categories) {
-  LinkedList *categoryList = createLinkedList();
-  char *token;
-  char *toSplit = categories;
-  char *toSave;
-
-  while((token = strtok_r(toSplit, ",", &toSplit))) { // Read next token.
-    if (token[0] == ' ') { // If token contains a space at the front.
-      for (int i = 0; i < strlen(token) - 1; i++) { // Shift characters one to the left.
-        token[i] = token[i + 1];
-      }
-      token[strlen(token) - 1] = 0;
-    }
-    toSave = malloc(64 * sizeof(char));
-    strcpy(toSave, token);
-    insertInLinkedList(categoryList, toSave);
-  }
-  return categoryList;  
+  return splitCategories(categories, strlen(categories));
 }
 
 /*
- * Saves a restaurant with read parameters and stores in binary trees.
+ * Creates a linked list of categories from comma-separated bytes, without a zero byte at 
+ * their end. Empty categories are skipped, and a space in front of a category is dropped. 
+ * Categories are interned straight from the bytes, so the list holds pooled handles.
  *
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
- * *name:       name of a restaurant.
- * *city:       city where restaurant is located.
- * *categories: string of restaurant's food categories.
- * *
- * *cost:       how expensive restaurant is ($, $$, $$$).
- * rank:        restaurant's rank from 0.0 to 5.0
- * reviewers:   number of people who rated the restaurant.
+ * *text:  first byte of the categories.
+ * length: number of bytes, none of them zero.
+ * return: a linked list of strings of categories.
  */
-void saveInsert(BinaryTree *btName, BinaryTree *btCity, char *name, char *city, 
-    char *categories, char *cost, float rank, int reviewers) {
-  LinkedList *categoryList = makeCategoryList(categories);
-  Restaurant *restaurant = initRestaurant(name, city, categoryList, cost, rank, reviewers); 
-  
-  insertInBinaryTree(btName, restaurant);
-  insertInBinaryTree(btCity, restaurant);
+LinkedList *splitCategories(char *text, int length) {
+  LinkedList *categoryList = createLinkedList();
+  char *end = text + length;
+
+  while (text < end) { // Read every category.
+    char *comma = (char*)memchr(text, ',', end - text);
+    char *stop  = comma != NULL ? comma : end;
+
+    if (stop > text) { // If category is not empty, drop a space at its front.
+      text += *text == ' ';
+      insertInLinkedList(categoryList, internBytes(text, stop - text));
+    }
+    text = stop + 1;
+  }
+  return categoryList;  
 }
@@ -9,19 +9,146 @@
  * author: Max Turkot
  * version: 12/10/21
  */
+#include <stddef.h>
 #include "ArrayList.h"
 #include "LinkedList.h"
-#include "BinaryTree.h"
+#include "KnowledgeBase.h"
+#include "Arena.h"
+#include "ThreadPool.h"
+
+#define TEXT_FILE         "restaurants.txt" // Text the knowledge base is read from.
+#define CHUNK_BYTES       (1 << 20)         // Fewest bytes of a chunk parsed by a thread alone.
+#define CHUNKS_PER_THREAD 4                 // Most chunks per thread, to finish together.
+
+typedef struct { // Define bytes of the fields of a record that are pooled after it is parsed.
+  char *categories;
+  int categoriesLength;
+  char *city;
+  int cityLength;
+  char *cost;
+  int costLength;
+} RecordFields;
+
+typedef struct { // Define part of a file parsed by one thread, starting at a record.
+  char *text;               // First byte of the chunk.
+  size_t size;
+  size_t lines;             // Number of newlines in the chunk.
+  Arena *arena;             // Arena to allocate restaurants from, NULL for the current one.
+  Restaurant **restaurants; // Batch of parsed restaurants, in order of the file.
+  RecordFields *fields;     // Fields of every parsed restaurant left to pool.
+  int count;
+  int space;
+} FileChunk;
 
 /*
  * Reads data about restaurants from a file with a passed name. If file cannot be opened, 
- * prints an arror. Data is stored in binary trees.
+ * prints an arror. Data is loaded in the knowledge base at once.
+ *
+ * char*:          name of file to be read.
+ * KnowledgeBase*: pointer to a knowledge base to store restaurants in.
+ */
+extern void readFile(char*, KnowledgeBase*);
+
+/*
+ * Reads a file that cannot be mapped from its current position to its end.
+ *
+ * int:     descriptor of an open file.
+ * size_t*: pointer to the number of read bytes.
+ * return:  read bytes, to be freed.
+ */
+extern char *readWhole(int, size_t*);
+
+/*
+ * Parses restaurants from the bytes of a file, eight lines per record, in chunks parsed at 
+ * the same time on the current thread pool.
+ *
+ * char*:      first byte of the file.
+ * size_t:     number of bytes.
+ * ArrayList*: pointer to an array list to store restaurants in.
+ */
+extern void parseFile(char*, size_t, ArrayList*);
+
+/*
+ * Cuts bytes of a file into chunks that start at records.
+ *
+ * FileChunk*: chunks to fill.
+ * int:        number of chunks.
+ * char*:      first byte of the file.
+ * size_t:     number of bytes.
+ */
+extern void cutChunks(FileChunk*, int, char*, size_t);
+
+/*
+ * Counts newlines in the bytes of one chunk.
+ *
+ * void*: array of chunks.
+ * int:   index of the chunk.
+ */
+extern void countChunk(void*, int);
+
+/*
+ * Finds the start of the line after the one a byte is in.
+ *
+ * char*:  byte in a line.
+ * char*:  byte past the file.
+ * return: first byte of the next line, or the end if there is none.
+ */
+extern char *nextLine(char*, char*);
+
+/*
+ * Parses restaurants from the bytes of one chunk into its batch.
+ *
+ * void*: array of chunks.
+ * int:   index of the chunk.
+ */
+extern void parseChunk(void*, int);
+
+/*
+ * Builds a restaurant from the lines of its record, all but the fields that are pooled.
+ *
+ * char**:        first bytes of the seven lines of a record.
+ * int*:          lengths of the lines, without newlines.
+ * char**:        pointer to a buffer for the opening hours line, grown as needed.
+ * int*:          pointer to the size of the buffer.
+ * RecordFields*: pointer to fields to fill with the bytes of city, cost and categories.
+ * return:        pointer to a created restaurant.
+ */
+extern Restaurant *parseRecord(char**, int*, char**, int*, RecordFields*);
+
+/*
+ * Sets categories, city and cost of a parsed restaurant, interned from the bytes of its record.
+ *
+ * Restaurant*:   pointer to a restaurant built by parseRecord().
+ * RecordFields*: pointer to bytes of its city, cost and categories.
+ */
+extern void poolRecord(Restaurant*, RecordFields*);
+
+/*
+ * Gets length of a text field in a line, up to the first carriage return or zero byte.
+ *
+ * char*:  first byte of the line.
+ * int:    length of the line, without its newline.
+ * return: length of the field.
+ */
+extern int fieldLength(char*, int);
+
+/*
+ * Reads a decimal number from bytes like atof() does.
+ *
+ * char*:  first byte of the number, leading spaces allowed.
+ * int:    number of bytes, none of them zero.
+ * return: read number, 0 if bytes do not start with one.
+ */
+extern double parseDecimal(char*, int);
+
+/*
+ * Reads an integer from bytes like atoi() does.
  *
- * char*: name of file to be read.
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
+ * char*:  first byte of the number, leading spaces allowed.
+ * int:    number of bytes, none of them zero.
+ * return: read number, 0 if bytes do not start with one.
  */
-extern void readFile(char*, BinaryTree*, BinaryTree*);
+extern int parseInteger(char*, int);
 
 /*
  * Creates a linked list of strings from a single comma-space-separated string.
@@ -32,18 +159,12 @@ extern void readFile(char*, BinaryTree*, BinaryTree*);
 extern LinkedList *makeCategoryList(char*);
 
 /*
- * Saves a restaurant with read parameters and stores in in binary trees.
+ * Creates a linked list of categories from comma-separated bytes.
  *
- * BinaryTree*: pointer to a binary tree with NAME ordering rule.
- * BinaryTree*: pointer to a binary tree with LOCATION ordering rule.
- * char*:       name of a restaurant.
- * char*:       city where restaurant is located.
- * char*:       string of restaurant's food categories.
- * *
- * char*:       how expensive restaurant is ($, $$, $$$).
- * float:       restaurant's rank from 0.0 to 5.0
- * int:         number of people who rated the restaurant.
+ * char*:  first byte of the categories.
+ * int:    number of bytes, none of them zero.
+ * return: a linked list of pooled handles of categories.
  */
-extern void saveInsert(BinaryTree*, BinaryTree*, char*, char*, char*, char*, float, int);
+extern LinkedList *splitCategories(char*, int);
 
 #endif
@@ -1,8 +1,9 @@
 /*
  * file: search.c
  * --------------
- * Searches passed array list based on different parameters. Search results for each parameter 
- * are merged and returned as a linked list of elements matching the criteria.
+ * Searches passed array list based on different parameters. Parameters are ordered by a query 
+ * plan from the most selective one, which finds candidates as a bitmap, and the rest filter 
+ * them. Found elements are returned as an array list of elements matching the criteria.
  *
  * author: Max Turkot
  * version: 10/30/21
@@ -12,171 +13,986 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <ctype.h>
 #include "search.h"
+#include "StringPool.h"
+#include "ThreadPool.h"
 
 /*
- * Searches the array based on specified parameters for matches. Returns a list of elements 
- * matching all parameters.
+ * Searches the knowledge base based on specified parameters for matches. Returns a list of 
+ * elements matching all parameters. Parameters are ordered by a query plan, see planSearch(), 
+ * and parameter set to "*" is not used. All restaurants are returned if no parameter is used.
  *
- * *data:       pointer to an array list to search.
+ * *kb:         pointer to a knowledge base to search.
  * *city:       desired city.
- * *cost:       desired cost.
+ * *cost:       desired cost, see parseRange().
  * *categories: pointer to a list of desired categories.
- * return:      pointer to an array list with found elements.
- */
-ArrayList *search(ArrayList *data, char* city, char* cost, char *categories) {
-  LinkedList *categoryList = stringToList(categories);
-  ArrayList  *foundCity;
-  ArrayList  *foundCost;
-  ArrayList  *foundCategory;
-  ArrayList  *result;
-
-  if (strcmp(city, "*") == 0) { // Copy all elements if user doesn't care about city.
-    foundCity = data;
-  } else {
-    foundCity = searchCity(data, city);
-  } 
-  if (strcmp(cost, "*") == 0) { // Copy all elements if user doesn't care about cost.
-    foundCost = data;
-  } else {
-    foundCost = searchCost(data, cost);
-  }
-  if (strcmp(categories, "*") == 0) { // Copy all elements if user doesn't care about category.
-    foundCategory = data;
-  } else {
-    foundCategory = searchCategory(data, categoryList);
-  }
-
-  result = merge(foundCity, foundCost);
-  result = merge(result, foundCategory);
+ * *rank:       desired rank, see parseRange().
+ * *reviewers:  desired number of reviewers, see parseRange().
+ * *open:       desired moment of the week restaurants are open at, see parseMoment().
+ * return:      pointer to an array list with found elements, in order of their ids.
+ */
+ArrayList *search(KnowledgeBase *kb, char* city, char* cost, char *categories, char *rank,
+    char *reviewers, char *open) {
+  QueryPlan *plan = planSearch(kb, city, cost, categories, rank, reviewers, open);
+  Bitmap *result;
+  ArrayList *list;
+
+  if (plan->size == 0) { // If user doesn't care about any parameter.
+    free(plan);
+    return listRestaurants(kb);
+  }
+  result = runPlan(kb, plan);
+  list   = listBitmap(kb, result);
+  freeBitmap(result);
+  free(plan);
+
+  return list;
+}
+
+/*
+ * Searches the knowledge base like search() for the best restaurants by rank and number of 
+ * reviewers. If the rank tree, which holds restaurants from the best one, is expected to 
+ * give enough matches before as many restaurants are visited as the most selective step 
+ * would find, it is streamed until the limit is reached, see streamTop(). Otherwise the plan 
+ * is run and found restaurants go through a top-K heap, which takes O(n log K).
+ *
+ * *kb:         pointer to a knowledge base to search.
+ * *city:       desired city.
+ * *cost:       desired cost, see parseRange().
+ * *categories: pointer to a list of desired categories.
+ * *rank:       desired rank, see parseRange().
+ * *reviewers:  desired number of reviewers, see parseRange().
+ * *open:       desired moment of the week restaurants are open at, see parseMoment().
+ * limit:       most restaurants to find, negative for no limit.
+ * return:      pointer to an array list with found elements, from the best one.
+ */
+ArrayList *searchTop(KnowledgeBase *kb, char* city, char* cost, char *categories, char *rank,
+    char *reviewers, char *open, int limit) {
+  QueryPlan *plan = planSearch(kb, city, cost, categories, rank, reviewers, open);
+  double matches = plan->total;
+  double streamed = plan->total;
+  ArrayList *list;
+  Bitmap *result;
+  TopK *top;
+  int *ids;
+  int count;
+
+  for (int i = 0; i < plan->size; i++) { // Estimate matches, assuming independent steps.
+    PlanStep *step = &plan->steps[i];
+
+    matches = plan->total == 0 ? 0 : matches * step->estimate / plan->total;
+    if (step->kind == RANGE_STEP && step->range.column == RANK_COLUMN) { // If tree is cut.
+      streamed = step->estimate;
+    }
+  }
+  if (limit >= 0 && (plan->size == 0 
+      || (matches > 0 && limit * streamed / matches < plan->steps[0].estimate))) { // If few.
+    list = streamTop(kb, plan, limit);
+    free(plan);
+    return list;
+  }
+
+  result = plan->size == 0 ? NULL : runPlan(kb, plan);
+  count  = result == NULL ? kb->count : bitmapCardinality(result);
+  top    = createTopK(limit < 0 || limit > count ? count : limit);
+  if (result == NULL) { // If every restaurant is found.
+    for (int id = 0; id < kb->count; id++) { // Offer every restaurant that was not removed.
+      if (kb->restaurants[id] != NULL) { // If restaurant is in the knowledge base.
+        offerTopK(top, kb->restaurants[id]);
+      }
+    }
+  } else { // Offer found restaurants.
+    ids   = (int*)malloc((count + 1) * sizeof(int));
+    count = extractBitmap(result, ids);
+    for (int i = 0; i < count; i++) { // Offer every found restaurant.
+      offerTopK(top, kb->restaurants[ids[i]]);
+    }
+    free(ids);
+    freeBitmap(result);
+  }
+  free(plan);
+
+  return finishTopK(top);
+}
+
+/*
+ * Finds the best restaurants matching a query plan by streaming the rank tree. Tree holds 
+ * restaurants by rank and number of reviewers, both descending, so the first ones matching 
+ * every step are the best ones, and the stream stops once the limit is reached. If a rank 
+ * range is desired, stream starts with a seek to its highest rank and stops past its lowest 
+ * one, so it takes O(log n + v) for v visited restaurants.
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *plan:  pointer to a query plan.
+ * limit:  most restaurants to find.
+ * return: pointer to an array list with found elements, from the best one.
+ */
+ArrayList *streamTop(KnowledgeBase *kb, QueryPlan *plan, int limit) {
+  ArrayList *result = createArrayList();
+  float lowRank = -INFINITY;
+  char key[TREE_KEY_SIZE] = "";
+  BTIterator iterator;
+  BTNode *node;
+
+  for (int i = 0; i < plan->size; i++) { // Find rank range.
+    PlanStep *step = &plan->steps[i];
+
+    if (step->kind == RANGE_STEP && step->range.column == RANK_COLUMN) { // If rank is cut.
+      writeRankKey(step->range.highRank, INT_MAX, key);
+      lowRank = step->range.lowRank;
+    }
+  }
+
+  seekBTIterator(&iterator, kb->btRank, key);
+  while (getSize(result) < limit && (node = nextBTNode(&iterator)) != NULL) { // Stream.
+    if (getRestaurant(node->restaurants, 0)->rank < lowRank) { // If past the rank range.
+      break;
+    }
+    for (int i = 0; i < getSize(node->restaurants) && getSize(result) < limit; i++) {
+      Restaurant *restaurant = getRestaurant(node->restaurants, i);
+
+      if (matchesPlan(kb, plan, restaurant->id)) { // If restaurant matches every step.
+        insert(result, restaurant);
+      }
+    }
+  }
   return result;
 }
 
 /*
- * Searches for restaurants matching the city and saves them in an array list.
+ * Checks whether a restaurant matches every step of a query plan. Steps are checked in order 
+ * of the plan, so the most selective one rules out most restaurants first.
  *
- * *data:  pointer to an array list to search.
- * *city:  string of a desired city name.
- * return: pointer to an array list with found elements.
+ * *kb:    pointer to a knowledge base to search.
+ * *plan:  pointer to a query plan.
+ * id:     id of the restaurant.
+ * return: 1 if restaurant matches, 0 otherwise.
  */
-ArrayList *searchCity(ArrayList *data, char *city) {
-  ArrayList *foundCity = createArrayList();
-  
-  for(int i = 0; i < getSize(data); i++) { // Iterate over element pointers in array list.
-    Restaurant *curr = getRestaurant(data, i);
+int matchesPlan(KnowledgeBase *kb, QueryPlan *plan, int id) {
+  for (int i = 0; i < plan->size; i++) { // Check every step.
+    PlanStep *step = &plan->steps[i];
 
-    if (strcmp(curr->city, city) == 0) { // Check if restaurant's city matches.
-      insert(foundCity, curr); 
-    } 
+    if (step->kind == CITY_STEP && (plan->city == NULL 
+        || kb->columns->cities[id] != stringId(plan->city))) { // If not in the city.
+      return 0;
+    } else if (step->kind == RANGE_STEP 
+        && !inRange(kb->columns, &step->range, id)) { // If out of the range.
+      return 0;
+    } else if (step->kind == CATEGORY_STEP 
+        && !hasCategory(kb, id, plan->categories, plan->categoryMask)) { // If none matches.
+      return 0;
+    } else if (step->kind == OPEN_STEP && (step->moment < 0 
+        || !isOpenAt(&kb->restaurants[id]->hours, step->moment))) { // If it is closed.
+      return 0;
+    }
   }
+  return 1;
+}
 
-  return foundCity;
+/*
+ * Searches for restaurants which name is within an edit distance of a name, ignoring case. 
+ * An edit changes at most three trigrams, so such names share all but three per edit of the 
+ * distinct trigrams of the name. Posting lists of its trigrams in the trigram index are 
+ * counted per restaurant, and only those reaching that many shared trigrams are candidates, 
+ * which skips removed restaurants left in posting lists. If the name has too few trigrams to 
+ * rule any restaurant out, every restaurant is a candidate. Candidates are verified by 
+ * boundedDistance() in morsels on the current thread pool, and matches of the morsels are put 
+ * together in order of the candidates before they are ordered from the closest one, then by 
+ * rank, so found restaurants do not depend on the number of threads.
+ *
+ * *kb:      pointer to a knowledge base to search.
+ * *name:    name to search for, names over 64 bytes find nothing.
+ * distance: greatest edit distance.
+ * limit:    most restaurants to find, negative for no limit.
+ * return:   pointer to an array list with found elements, from the closest one.
+ */
+ArrayList *fuzzySearch(KnowledgeBase *kb, char *name, int distance, int limit) {
+  ArrayList *result = createArrayList();
+  int length = strlen(name);
+  uint64_t masks[256] = {0};
+  uint32_t *trigrams;
+  int count;
+  int needed;
+  int *candidates;
+  int found = 0;
+  FuzzyMatch *matches;
+  int matched = 0;
+  int morsels;
+  FuzzyJob job;
+
+  if (length > 64 || distance < 0) { // If name is too long for a bit-parallel check.
+    return result;
+  }
+  for (int i = 0; i < length; i++) { // Mark positions of every byte of the name.
+    masks[(unsigned char)tolower((unsigned char)name[i])] |= (uint64_t)1 << i;
+  }
+  trigrams = (uint32_t*)malloc((length + 1) * sizeof(uint32_t));
+  count    = nameTrigrams(name, trigrams);
+  needed   = count - 3 * distance;
+
+  candidates = (int*)malloc((kb->count + 1) * sizeof(int));
+  if (needed <= 0) { // If trigrams rule nothing out, every restaurant is a candidate.
+    for (int id = 0; id < kb->count; id++) { // Add every restaurant that was not removed.
+      if (kb->restaurants[id] != NULL) { // If restaurant is in the knowledge base.
+        candidates[found++] = id;
+      }
+    }
+  } else { // Count shared trigrams.
+    unsigned char *shared = (unsigned char*)calloc(kb->count + 1, sizeof(unsigned char));
+
+    for (int t = 0; t < count; t++) { // Count every posting of every trigram.
+      PostingList *list = getTrigramPostings(kb->names, trigrams[t]);
+
+      for (int i = 0; list != NULL && i < list->size; i++) { // Count restaurant.
+        if (++shared[list->ids[i]] == needed 
+            && kb->restaurants[list->ids[i]] != NULL) { // If it shares enough and is present.
+          candidates[found++] = list->ids[i];
+        }
+      }
+    }
+    free(shared);
+  }
+
+  morsels = (found + MORSEL_ROWS - 1) / MORSEL_ROWS;
+  matches = (FuzzyMatch*)malloc((found + 1) * sizeof(FuzzyMatch));
+  job.restaurants = kb->restaurants;
+  job.masks       = masks;
+  job.length      = length;
+  job.distance    = distance;
+  job.candidates  = candidates;
+  job.count       = found;
+  job.matches     = matches;
+  job.matched     = (int*)malloc((morsels + 1) * sizeof(int));
+  runMorsels(verifyMorsel, &job, morsels);
+  for (int m = 0; m < morsels; m++) { // Move matches of every morsel after the previous ones.
+    memmove(matches + matched, matches + m * MORSEL_ROWS, job.matched[m] * sizeof(FuzzyMatch));
+    matched += job.matched[m];
+  }
+  free(job.matched);
+  qsort(matches, matched, sizeof(FuzzyMatch), compareMatches);
+  for (int i = 0; i < matched && (limit < 0 || i < limit); i++) { // Add closest matches.
+    insert(result, matches[i].restaurant);
+  }
+
+  free(trigrams);
+  free(candidates);
+  free(matches);
+  return result;
 }
 
 /*
- * Searches for restaurants with cost that does not exceed specified value and saves them in 
- * an array list.
- * 
- * *data:  pointer ro an array list to search.
- * *cost:  string of a maximum cost.
- * return: pointer to an array list with found elements.
- */
-ArrayList *searchCost(ArrayList *data, char *cost) {
-  ArrayList *foundCost = createArrayList();
-  
-  for (int i = 0; i < getSize(data); i++) { // Iterate over element pointers in array list.
-    Restaurant *curr = getRestaurant(data, i);
-    
-    if (strcmp(cost, "$$$") == 0) { // If prise limit is maximum, save all elements.
-      insert(foundCost, curr);
-    } else if (strcmp(cost, "$$") == 0) {
-      if (strcmp(curr->cost, "$$$") != 0) { // Save all but most expensive restaurants.
-        insert(foundCost, curr);
+ * Finds edit distance between a pattern and a text with Myers' bit-parallel algorithm. Bit i 
+ * of vertical deltas tells whether distance to the first i + 1 bytes of the pattern grows or 
+ * shrinks against the first i bytes, and all of them are updated at once for every byte of 
+ * the text, so it takes O(n) for a text of n bytes. Distance to the whole pattern is tracked 
+ * through the last bit. Text is lowercased as it is read. Distance drops by at most one per 
+ * byte, so check gives up once it cannot come back within the bound.
+ *
+ * *masks:  masks of positions of every byte in the lowercased pattern.
+ * length:  length of the pattern, at most 64.
+ * *text:   text.
+ * bound:   greatest distance of interest.
+ * return:  edit distance, or the bound plus one if distance is greater.
+ */
+int boundedDistance(uint64_t *masks, int length, char *text, int bound) {
+  int left = strlen(text);
+  uint64_t last;
+  uint64_t positive = ~(uint64_t)0;
+  uint64_t negative = 0;
+  int score = length;
+
+  if (abs(left - length) > bound) { // If lengths alone differ too much.
+    return bound + 1;
+  }
+  if (length == 0) { // If pattern is empty, every byte of the text is an insertion.
+    return left;
+  }
+  last = (uint64_t)1 << (length - 1);
+  for (; *text != 0; text++) { // Update deltas for every byte of the text.
+    uint64_t equal = masks[(unsigned char)tolower((unsigned char)*text)];
+    uint64_t vertical = equal | negative;
+    uint64_t horizontal = (((equal & positive) + positive) ^ positive) | equal;
+    uint64_t up = negative | ~(horizontal | positive);
+    uint64_t down = positive & horizontal;
+
+    if (up & last) { // If distance to the whole pattern grows.
+      score++;
+    } else if (down & last) { // If distance to the whole pattern shrinks.
+      score--;
+    }
+    up   = up << 1 | 1;
+    down = down << 1;
+    positive = down | ~(vertical | up);
+    negative = up & vertical;
+    left--;
+
+    if (score - left > bound) { // If distance cannot come back within the bound.
+      return bound + 1;
+    }
+  }
+  return score;
+}
+
+/*
+ * Compares two fuzzy matches by distance, then like compareByRank(), so equally close 
+ * restaurants go from the best one.
+ *
+ * *first:  pointer to the first match.
+ * *second: pointer to the second match.
+ * return:  negative, zero or positive if first match goes before, with or after.
+ */
+int compareMatches(const void *first, const void *second) {
+  FuzzyMatch *a = (FuzzyMatch*)first;
+  FuzzyMatch *b = (FuzzyMatch*)second;
+
+  if (a->distance != b->distance) { // If distances differ, smaller one goes first.
+    return a->distance < b->distance ? -1 : 1;
+  }
+  return compareByRank(&a->restaurant, &b->restaurant);
+}
+
+/*
+ * Verifies candidates of one morsel of a fuzzy search. Matches are written from the place of 
+ * the first candidate of the morsel, so morsels do not share any.
+ *
+ * *job:   pointer to a fuzzy job.
+ * morsel: number of the morsel.
+ */
+void verifyMorsel(void *job, int morsel) {
+  FuzzyJob *fuzzy = (FuzzyJob*)job;
+  int first = morsel * MORSEL_ROWS;
+  int last  = fuzzy->count - first < MORSEL_ROWS ? fuzzy->count : first + MORSEL_ROWS;
+  FuzzyMatch *matches = fuzzy->matches + first;
+  int matched = 0;
+
+  for (int i = first; i < last; i++) { // Verify every candidate of the morsel.
+    Restaurant *restaurant = fuzzy->restaurants[fuzzy->candidates[i]];
+    int edits = boundedDistance(fuzzy->masks, fuzzy->length, restaurant->name, fuzzy->distance);
+
+    if (edits <= fuzzy->distance) { // If name is close enough.
+      matches[matched].restaurant = restaurant;
+      matches[matched].distance   = edits;
+      matched++;
+    }
+  }
+  fuzzy->matched[morsel] = matched;
+}
+
+/*
+ * Searches the knowledge base like search() and writes its query plan, with estimated and 
+ * actual numbers of restaurants left after every step, instead of the found restaurants.
+ *
+ * *kb:         pointer to a knowledge base to search.
+ * *city:       desired city.
+ * *cost:       desired cost, see parseRange().
+ * *categories: pointer to a list of desired categories.
+ * *rank:       desired rank, see parseRange().
+ * *reviewers:  desired number of reviewers, see parseRange().
+ * *open:       desired moment of the week restaurants are open at, see parseMoment().
+ * *file:       pointer to a file to write to.
+ */
+void explainSearch(KnowledgeBase *kb, char* city, char* cost, char *categories, char *rank,
+    char *reviewers, char *open, FILE *file) {
+  QueryPlan *plan = planSearch(kb, city, cost, categories, rank, reviewers, open);
+
+  if (plan->size > 0) { // If user cares about some parameter.
+    freeBitmap(runPlan(kb, plan));
+  }
+  writePlan(plan, file);
+  free(plan);
+}
+
+/*
+ * Plans a search. Every used parameter becomes a step with an estimated number of matching 
+ * restaurants: bucket size of a city in the city tree, histogram counts of a range, sum of 
+ * posting list lengths of categories, and restaurants open in the slot of a moment in the 
+ * hours index. Steps are ordered from the lowest estimate, so the 
+ * most selective one finds candidates and the rest only filter them.
+ *
+ * *kb:         pointer to a knowledge base to search.
+ * *city:       desired city.
+ * *cost:       desired cost, see parseRange().
+ * *categories: pointer to a list of desired categories.
+ * *rank:       desired rank, see parseRange().
+ * *reviewers:  desired number of reviewers, see parseRange().
+ * *open:       desired moment of the week restaurants are open at, see parseMoment().
+ * return:      pointer to a created query plan.
+ */
+QueryPlan *planSearch(KnowledgeBase *kb, char* city, char* cost, char *categories, char *rank,
+    char *reviewers, char *open) {
+  QueryPlan *plan = (QueryPlan*)malloc(sizeof(QueryPlan));
+  char *texts[3]    = {cost, rank, reviewers};
+  Column columns[3] = {COST_COLUMN, RANK_COLUMN, REVIEWERS_COLUMN};
+  PlanStep *step;
+
+  plan->size         = 0;
+  plan->total        = kb->live;
+  plan->city         = lookupString(city);
+  plan->categories   = NULL;
+  plan->categoryMask = 0;
+
+  if (strcmp(city, "*") != 0) { // If user cares about city.
+    BTNode *node = searchBinaryTree(kb->btCity, city);
+
+    step = &plan->steps[plan->size++];
+    step->kind     = CITY_STEP;
+    step->estimate = node == NULL ? 0 : getSize(node->restaurants);
+    strncpy(step->text, city, sizeof(step->text) - 1);
+  }
+  for (int c = 0; c < 3; c++) { // Plan range of every column.
+    if (strcmp(texts[c], "*") == 0) { // If user doesn't care about the column.
+      continue;
+    }
+    step = &plan->steps[plan->size++];
+    step->kind = RANGE_STEP;
+    strncpy(step->text, texts[c], sizeof(step->text) - 1);
+    parseRange(texts[c], columns[c], &step->range);
+    step->estimate = estimateRange(kb->columns, &step->range);
+  }
+  if (strcmp(categories, "*") != 0) { // If user cares about category.
+    step = &plan->steps[plan->size++];
+    step->kind     = CATEGORY_STEP;
+    step->estimate = 0;
+    strncpy(step->text, categories, sizeof(step->text) - 1);
+    plan->categories = stringToList(categories);
+    plan->categoryMask = categoryMask(plan->categories);
+    for (Node *curr = plan->categories->head; curr != 0; curr = curr->next) { // Add lengths.
+      PostingList *list = getPostings(kb->categories, curr->data);
+
+      step->estimate += list == NULL ? 0 : list->size;
+    }
+    if (step->estimate > plan->total) { // If categories overlap, at most all match.
+      step->estimate = plan->total;
+    }
+  }
+  if (strcmp(open, "*") != 0) { // If user cares about opening hours.
+    step = &plan->steps[plan->size++];
+    step->kind     = OPEN_STEP;
+    step->moment   = parseMoment(open);
+    step->estimate = step->moment < 0 ? 0 : estimateHours(kb->hours, step->moment);
+    strncpy(step->text, open, sizeof(step->text) - 1);
+  }
+
+  for (int i = 0; i < plan->size; i++) { // Mark steps as not run yet.
+    plan->steps[i].text[sizeof(plan->steps[i].text) - 1] = 0;
+    plan->steps[i].actual  = -1;
+    plan->steps[i].scanned = 0;
+    plan->steps[i].indexed = 0;
+  }
+  for (int i = 1; i < plan->size; i++) { // Order steps by estimate, keeping ties in place.
+    PlanStep moved = plan->steps[i];
+    int j = i;
+
+    while (j > 0 && plan->steps[j - 1].estimate > moved.estimate) { // Shift bigger steps.
+      plan->steps[j] = plan->steps[j - 1];
+      j--;
+    }
+    plan->steps[j] = moved;
+  }
+  return plan;
+}
+
+/*
+ * Runs steps of a query plan in order. The first step finds candidates through an index or a 
+ * column scan, see findRange(), and every next step keeps the candidates matching it. Range 
+ * steps scan their column and intersect instead when candidates are more than SCAN_RATIO-th of 
+ * the rows, since kernels test rows faster than candidates are checked one by one. Open 
+ * steps always read the hours index, and intersect when they do not find candidates, since 
+ * bitmaps of slots are at hand. Number of candidates is recorded after every step.
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *plan:  pointer to a query plan with at least one step.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *runPlan(KnowledgeBase *kb, QueryPlan *plan) {
+  Bitmap *result = NULL;
+
+  for (int i = 0; i < plan->size; i++) { // Run every step.
+    PlanStep *step = &plan->steps[i];
+    Bitmap *found;
+
+    step->scanned = result == NULL;
+    if (step->kind == CITY_STEP) { // If step matches city.
+      found = result == NULL ? searchCity(kb, step->text) : filterCity(kb, result, plan->city);
+    } else if (step->kind == RANGE_STEP && result == NULL) { // If range finds candidates.
+      found = findRange(kb, step);
+    } else if (step->kind == RANGE_STEP 
+        && (double)bitmapCardinality(result) * SCAN_RATIO > kb->columns->size) { // If many.
+      Bitmap *range = findRange(kb, step);
+
+      found = andBitmaps(result, range);
+      freeBitmap(range);
+      step->scanned = 1;
+    } else if (step->kind == RANGE_STEP) { // Range filters few candidates.
+      found = filterRange(kb, result, &step->range);
+    } else if (step->kind == OPEN_STEP) { // If step matches opening hours.
+      found = searchOpen(kb, step->moment);
+      if (result != NULL) { // If step filters candidates, intersect.
+        Bitmap *open = found;
+
+        found = andBitmaps(result, open);
+        freeBitmap(open);
+        step->scanned = 1;
       }
-    } else if (strcmp(cost, "$") == 0) {
-      if (strcmp(curr->cost, "$") == 0) { // Save only the cheapest restaurants.
-        insert(foundCost, curr);
+    } else { // Step matches categories.
+      found = result == NULL ? searchCategory(kb, plan->categories) 
+          : filterCategories(kb, result, plan->categories);
+    }
+    if (result != NULL) { // If step filtered candidates, drop them.
+      freeBitmap(result);
+    }
+    result = found;
+    step->actual = bitmapCardinality(result);
+  }
+  return result;
+}
+
+/*
+ * Writes steps of a query plan with the way they find or filter candidates. Estimated number 
+ * of candidates after a step assumes parameters are independent, so it is the number of all 
+ * restaurants times the share of them matching each step so far.
+ *
+ * *plan: pointer to a query plan.
+ * *file: pointer to a file to write to.
+ */
+void writePlan(QueryPlan *plan, FILE *file) {
+  char *names[4]    = {"city", "range", "categories", "open at"};
+  char *columns[3]  = {"cost", "rank", "reviewers"};
+  char *scans[4]    = {"city tree bucket", "column scan", "category index", "hours index"};
+  char *filters[4]  = {"city column", "column filter", "category masks", "hours index"};
+  double estimate = plan->total;
+
+  if (plan->size == 0) { // If no parameter is used.
+    fprintf(file, "1. all restaurants: estimated %d, actual %d\n", plan->total, plan->total);
+    return;
+  }
+  for (int i = 0; i < plan->size; i++) { // Write every step.
+    PlanStep *step = &plan->steps[i];
+    char *name = step->kind == RANGE_STEP ? columns[step->range.column] : names[step->kind];
+
+    estimate = plan->total == 0 ? 0 : estimate * step->estimate / plan->total;
+    fprintf(file, "%d. %s = %s (%s%s): estimated %.0f, actual %d\n", i + 1, name, step->text,
+        step->indexed ? "tree range" : step->scanned ? scans[step->kind] : filters[step->kind], 
+        step->scanned && i > 0 ? ", intersected" : "", estimate, step->actual);
+  }
+}
+
+/*
+ * Searches for restaurants matching the city and saves their ids in a bitmap. Ids are taken 
+ * from the bucket of the city in the city tree, which holds restaurants in order of their ids.
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *city:  string of a desired city name.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchCity(KnowledgeBase *kb, char *city) {
+  BTNode *node = searchBinaryTree(kb->btCity, city);
+  Bitmap *foundCity = createBitmap();
+
+  if (node == NULL) { // If no restaurant is located in the city.
+    return foundCity;
+  }
+  for (int i = 0; i < getSize(node->restaurants); i++) { // Add id of every restaurant.
+    addToBitmap(foundCity, getRestaurant(node->restaurants, i)->id);
+  }
+  return foundCity;
+}
+
+/*
+ * Searches for restaurants open at a moment of the week in the hours index, see 
+ * searchHoursIndex().
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * moment: minutes after Monday midnight, -1 for an invalid moment.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchOpen(KnowledgeBase *kb, int moment) {
+  if (moment < 0) { // If moment is invalid, no restaurant is open at it.
+    return createBitmap();
+  }
+  return searchHoursIndex(kb->hours, kb->restaurants, moment);
+}
+
+/*
+ * Finds restaurants within the range of a range step. Range of fewer than TREE_RATIO-th of 
+ * the rows by estimate is looked up in the tree of its column, and other ranges scan the 
+ * column, which tests every row but needs no sorting.
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *step:  pointer to a range step.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *findRange(KnowledgeBase *kb, PlanStep *step) {
+  if ((double)step->estimate * TREE_RATIO < kb->columns->size) { // If range holds few rows.
+    step->indexed = 1;
+    return searchRangeTree(kb, &step->range);
+  }
+  return scanRange(kb->columns, &step->range);
+}
+
+/*
+ * Finds restaurants within a range in the tree of its column. Tree is walked from the seek 
+ * of the lowest key within the range to the first key past it, which takes O(log n + k) for 
+ * k found restaurants, and ids are sorted before they go to the bitmap. Cost levels past 255 
+ * share keys, so found restaurants are checked in the column.
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *range: pointer to a range of a column.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchRangeTree(KnowledgeBase *kb, ColumnRange *range) {
+  Bitmap *foundRange = createBitmap();
+  char low[TREE_KEY_SIZE];
+  char high[TREE_KEY_SIZE];
+  BTIterator iterator;
+  BTNode *node;
+  int *ids;
+  int count = 0;
+  int space = 64;
+
+  if (rangeKeys(range, low, high) == -1) { // If no restaurant is within the range.
+    return foundRange;
+  }
+  ids = (int*)malloc(space * sizeof(int));
+  seekBTIterator(&iterator, columnTree(kb, range->column), low);
+  while ((node = nextBTNode(&iterator)) != NULL 
+      && (high[0] == 0 || strcmp(node->name, high) < 0)) { // Visit nodes within the range.
+    for (int i = 0; i < getSize(node->restaurants); i++) { // Collect bucket.
+      int id = getRestaurant(node->restaurants, i)->id;
+
+      if (count == space) { // If there is no room for another id.
+        space *= 2;
+        ids = (int*)realloc(ids, space * sizeof(int));
       }
+      ids[count] = id;
+      count += inRange(kb->columns, range, id);
+    }
+  }
+
+  qsort(ids, count, sizeof(int), compareIds);
+  for (int i = 0; i < count; i++) { // Add ids in increasing order.
+    addToBitmap(foundRange, ids[i]);
+  }
+  free(ids);
+  return foundRange;
+}
+
+/*
+ * Writes keys bounding a range in the tree of its column. Ranks and numbers of reviewers 
+ * order from the greatest one, so the lowest key is that of the high end and the key past 
+ * the range follows the low end. Bounds only hold leading digits of a key, which sort before 
+ * all keys starting with them.
+ *
+ * *range: pointer to a range of a column.
+ * *low:   buffer for the lowest key within the range.
+ * *high:  buffer for the key past the range, empty if range has no end in the tree.
+ * return: 0 if some value is within the range, -1 otherwise.
+ */
+int rangeKeys(ColumnRange *range, char *low, char *high) {
+  if (range->column == RANK_COLUMN) { // If range is of ranks.
+    if (!(range->lowRank <= range->highRank)) { // If range is empty.
+      return -1;
     }
+    writeHexKey(rankBits(range->highRank), 8, low);
+    writeHexKey((uint64_t)rankBits(range->lowRank) + 1, 8, high);
+    return 0;
+  }
+  if (range->low > range->high) { // If range is empty.
+    return -1;
   }
-  return foundCost;
+  if (range->column == REVIEWERS_COLUMN) { // If range is of numbers of reviewers.
+    writeHexKey(reviewersBits(range->high), 8, low);
+    writeHexKey((uint64_t)reviewersBits(range->low) + 1, 8, high);
+  } else { // Range is of cost levels.
+    writeHexKey(costBits(range->low), 2, low);
+    writeHexKey(costBits(range->high) + 1, 2, high);
+    high[costBits(range->high) == 255 ? 0 : 2] = 0;
+  }
+  return 0;
+}
+
+/*
+ * Compares two ids.
+ *
+ * *first:  pointer to the first id.
+ * *second: pointer to the second id.
+ * return:  negative, zero or positive if first id is less, equal or greater.
+ */
+int compareIds(const void *first, const void *second) {
+  return *(int*)first - *(int*)second;
+}
+
+/*
+ * Keeps restaurant ids from a bitmap which value is within a range. Restaurants are checked 
+ * in the column of the range, see filterIds().
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *data:  pointer to a bitmap to filter.
+ * *range: pointer to a range of a column.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *filterRange(KnowledgeBase *kb, Bitmap *data, ColumnRange *range) {
+  FilterJob job = {kb, RANGE_STEP, range, 0, NULL, 0, NULL, 0, NULL};
+
+  return filterIds(data, &job);
+}
+
+/*
+ * Keeps restaurant ids from a bitmap of restaurants in a city. Restaurants are checked in the 
+ * city column by the id of the city handle, see filterIds().
+ *
+ * *kb:    pointer to a knowledge base to search.
+ * *data:  pointer to a bitmap to filter.
+ * *city:  pooled handle of a desired city, NULL if no restaurant is in it.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *filterCity(KnowledgeBase *kb, Bitmap *data, char *city) {
+  FilterJob job = {kb, CITY_STEP, NULL, city == NULL ? -2 : stringId(city), NULL, 0, NULL, 0, 
+      NULL};
+
+  return filterIds(data, &job);
 }
 
 /*
- * Searches for restaurants that have at least one of the specified categories.
+ * Searches for restaurants that have at least one of the specified categories. Unites posting 
+ * lists of the categories from the category index, so only matching restaurants are visited.
  * 
- * *data:     pointer to an array list to search.
+ * *kb:       pointer to a knowledge base to search.
  * *category: pointer to a list of desired categories.
- * return:    pointer to an array list with found elements.
- */
-ArrayList *searchCategory(ArrayList *data, LinkedList *categoryList) {
-  ArrayList *foundCategory = createArrayList();
-  
-  for (int restIndex = 0; restIndex < getSize(data); restIndex++) { // Iterate restaurants.
-    Restaurant *currRest = getRestaurant(data, restIndex);
-    Node *currCat        = currRest->categories->head;
-
-    while (currCat != 0) { // Iterate restaurant category nodes.
-      Node *currList = categoryList->head;
-      bool found = false;
-
-      while (currList != 0) { // Iterate desired category nodes.
-	if (strcmp(currCat->data, currList->data) == 0) { // Compare categories.
-          insert(foundCategory, currRest);
-	  found = true;
-	}
-	currList = currList->next;
-      }
-      if (found) { // Current restaurant was already added.
-        break;
-      }
-      currCat = currCat->next;
-    } 
+ * return:    pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *searchCategory(KnowledgeBase *kb, LinkedList *categoryList) {
+  return searchCategoryIndex(kb->categories, categoryList);
+}
+
+/*
+ * Keeps restaurant ids from a bitmap that have at least one of the specified categories, see 
+ * hasCategory() and filterIds().
+ *
+ * *kb:           pointer to a knowledge base to search.
+ * *data:         pointer to a bitmap to filter.
+ * *categoryList: pointer to a list of desired categories.
+ * return:        pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *filterCategories(KnowledgeBase *kb, Bitmap *data, LinkedList *categoryList) {
+  FilterJob job = {kb, CATEGORY_STEP, NULL, 0, categoryList, categoryMask(categoryList), NULL, 
+      0, NULL};
+
+  return filterIds(data, &job);
+}
+
+/*
+ * Keeps restaurant ids from a bitmap that match the step of a filter job. Ids are checked in 
+ * morsels on the current thread pool, each one moving its kept ids to its front, and kept ids 
+ * go to the bitmap in order of the morsels afterwards, so found ids do not depend on the 
+ * number of threads.
+ *
+ * *data:  pointer to a bitmap to filter.
+ * *job:   pointer to a filter job with the step to match.
+ * return: pointer to a bitmap of found restaurant ids.
+ */
+Bitmap *filterIds(Bitmap *data, FilterJob *job) {
+  Bitmap *found = createBitmap();
+  int morsels;
+
+  job->ids   = (int*)malloc((bitmapCardinality(data) + 1) * sizeof(int));
+  job->count = extractBitmap(data, job->ids);
+  morsels    = (job->count + MORSEL_ROWS - 1) / MORSEL_ROWS;
+  job->kept  = (int*)malloc((morsels + 1) * sizeof(int));
+  runMorsels(filterMorsel, job, morsels);
+
+  for (int m = 0; m < morsels; m++) { // Add kept ids of every morsel.
+    for (int i = m * MORSEL_ROWS; i < m * MORSEL_ROWS + job->kept[m]; i++) { // Add kept id.
+      addToBitmap(found, job->ids[i]);
+    }
   }
-  return foundCategory;
+  free(job->ids);
+  free(job->kept);
+  return found;
 }
 
 /*
- * Merges two array list into one that only contains elements appearing in both lists. 
- * Iterates over each element pair and compairs element pointers.
+ * Checks candidates of one morsel of a filter job against its step, and moves kept ids to the 
+ * front of the morsel in the order they were in.
  *
- * *one:   pointer to the first array list to merge.
- * *two:   pointer to the second array list to merge.
- * return: pointer to a merger array list.
+ * *job:   pointer to a filter job.
+ * morsel: number of the morsel.
  */
-ArrayList *merge(ArrayList *one, ArrayList *two) {
-  ArrayList *result = createArrayList();
+void filterMorsel(void *job, int morsel) {
+  FilterJob *filter = (FilterJob*)job;
+  int *ids  = filter->ids + morsel * MORSEL_ROWS;
+  int count = filter->count - morsel * MORSEL_ROWS;
+  int kept  = 0;
+
+  count = count < MORSEL_ROWS ? count : MORSEL_ROWS;
+  if (filter->kind == CITY_STEP) { // If step matches city.
+    int *cities = filter->kb->columns->cities;
+
+    for (int i = 0; i < count; i++) { // Keep candidates in the city.
+      ids[kept] = ids[i];
+      kept += cities[ids[i]] == filter->city;
+    }
+  } else if (filter->kind == RANGE_STEP) { // If step matches range.
+    for (int i = 0; i < count; i++) { // Keep candidates within the range.
+      ids[kept] = ids[i];
+      kept += inRange(filter->kb->columns, filter->range, ids[i]);
+    }
+  } else { // Step matches categories.
+    for (int i = 0; i < count; i++) { // Keep candidates with a desired category.
+      ids[kept] = ids[i];
+      kept += hasCategory(filter->kb, ids[i], filter->categories, filter->mask);
+    }
+  }
+  filter->kept[morsel] = kept;
+}
 
-  for (int i = 0; i < getSize(one); i++) { // Iterate over elements of the firs array list.
-    Restaurant *currOne = getRestaurant(one, i);
+/*
+ * Checks whether a restaurant has at least one of the specified categories. Category mask 
+ * column rules out most restaurants without reading their categories, and the rest are 
+ * checked by comparing category handles.
+ *
+ * *kb:           pointer to a knowledge base to search.
+ * id:            id of the restaurant.
+ * *categoryList: pointer to a list of desired categories.
+ * mask:          category mask of the desired categories.
+ * return:        1 if restaurant has a desired category, 0 otherwise.
+ */
+int hasCategory(KnowledgeBase *kb, int id, LinkedList *categoryList, uint64_t mask) {
+  Restaurant *curr = kb->restaurants[id];
 
-    for (int j = 0; j < getSize(two); j++) { // Iterate over elements of the second array list.
-      Restaurant *currTwo = getRestaurant(two, j);
-      
-      if (currOne == currTwo) { // If pointers match, add to a new array list.
-        insert(result, currOne); 
+  if ((kb->columns->categories[id] & mask) == 0) { // If no category can match.
+    return 0;
+  }
+  for (Node *currCat = curr->categories->head; currCat != 0; 
+      currCat = currCat->next) { // Iterate restaurant category nodes.
+    for (Node *currList = categoryList->head; currList != 0; currList = currList->next) {
+      if (currCat->data == currList->data) { // Compare category handles.
+        return 1;
       }
     }
-  }  
-  return result;
+  }
+  return 0;
 }
 
 /*
- * Creates a linked list of strings from a single comma-separated string.
+ * Creates a linked list of strings from a single comma-separated string. Spaces in front of 
+ * strings are skipped. Strings are looked up in the string pool, and those that were never 
+ * interned are skipped, since no restaurant can match them.
  *
  * *string: string read from a file containing csv.
- * return:  a linked list of strings of categories.
+ * return:  a linked list of handles of categories.
  */
 LinkedList *stringToList(char* string) {
   LinkedList *list = createLinkedList();
   char *token;
   char *toSplit = string;
-  char *toSave;
+  char *handle;
 
   while((token = strtok_r(toSplit, ",", &toSplit))) { // Read next token.
-    toSave = malloc(64 * sizeof(char));
-    strcpy(toSave, token);
-    insertInLinkedList(list, toSave);
+    token += strspn(token, " ");
+    handle = lookupString(token);
+    if (handle != NULL) { // If some restaurant has the category.
+      insertInLinkedList(list, handle);
+    }
   }
   return list;
 }
+
+/*
+ * Reads a range of a column from a string. Range is either "low-high", "between low and high", 
+ * or a bound after one of operators ">=", ">", "<=", "<" and "=". Bare value is the highest 
+ * cost, or the lowest rank and number of reviewers. Costs are written as dollar signs, and 
+ * ranks and numbers of reviewers as numbers. Invalid string gives a range no restaurant is 
+ * within.
+ *
+ * *text:   string read from the user.
+ * column:  column of the range.
+ * *range:  pointer to a range to fill.
+ * return:  0 if string was valid, -1 otherwise.
+ */
+int parseRange(char *text, Column column, ColumnRange *range) {
+  char *operators[5] = {">=", ">", "<=", "<", "="};
+  double low  = -INFINITY;
+  double high = INFINITY;
+  int lowOpen  = 0;
+  int highOpen = 0;
+  int op = 0;
+
+  text += strspn(text, " ");
+  while (op < 5 && strncmp(text, operators[op], strlen(operators[op])) != 0) { // Find op.
+    op++;
+  }
+  if (strncmp(text, "between ", 8) == 0) { // If range is "between low and high".
+    text = parseValue(text + 8, column, &low);
+    if (text != NULL) { // If low end was read, expect "and" before high end.
+      text += strspn(text, " ");
+      text = strncmp(text, "and ", 4) == 0 ? parseValue(text + 4, column, &high) : NULL;
+    }
+  } else if (op < 5) { // If bound follows an operator.
+    double value;
+
+    text = parseValue(text + strlen(operators[op]), column, &value);
+    low      = op == 0 || op == 1 || op == 4 ? value : low;
+    high     = op == 2 || op == 3 || op == 4 ? value : high;
+    lowOpen  = op == 1;
+    highOpen = op == 3;
+  } else if ((text = parseValue(text, column, &low)) != NULL) { // If value is bare.
+    text += strspn(text, " ");
+    if (*text == '-') { // If value is the low end of a range.
+      text = parseValue(text + 1, column, &high);
+    } else if (column == COST_COLUMN) { // Bare cost is the highest one.
+      high = low;
+      low  = -INFINITY;
+    }
+  }
+  if (text != NULL) { // If values were read, skip trailing spaces.
+    text += strspn(text, " ");
+  }
+
+  range->column = column;
+  if (text == NULL || *text != 0) { // If string is invalid, select nothing.
+    range->low      = 1;
+    range->high     = 0;
+    range->lowRank  = 1;
+    range->highRank = 0;
+    return -1;
+  }
+  range->lowRank  = lowOpen ? nextafterf((float)low, INFINITY) : (float)low;
+  range->highRank = highOpen ? nextafterf((float)high, -INFINITY) : (float)high;
+  low  = lowOpen ? floor(low) + 1 : ceil(low);
+  high = highOpen ? ceil(high) - 1 : floor(high);
+  low  = fmax(low, column == COST_COLUMN ? 1 : 0); // Cost level 0 and reviewers -1 are unset.
+  high = fmin(high, INT_MAX);
+  range->low  = low > high ? 1 : (int)low;
+  range->high = low > high ? 0 : (int)high;
+  if (column == COST_COLUMN && low <= high) { // If range is of costs, clamp it like the column.
+    range->low  = costBits(range->low);
+    range->high = costBits(range->high);
+  }
+  return 0;
+}
+
+/*
+ * Reads a value of a column from the front of a string. Spaces in front of the value are 
+ * skipped. Costs are read as dollar signs, other values as numbers.
+ *
+ * *text:  string to read from.
+ * column: column of the value.
+ * *value: pointer to the read value.
+ * return: pointer past the value, NULL if string does not start with one.
+ */
+char *parseValue(char *text, Column column, double *value) {
+  char *end;
+
+  text += strspn(text, " ");
+  if (column == COST_COLUMN) { // If value is dollar signs.
+    end    = text + strspn(text, "$");
+    *value = end - text;
+  } else { // Value is a number.
+    *value = strtod(text, &end);
+  }
+  return end == text ? NULL : end;
+}
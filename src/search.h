@@ -10,56 +10,325 @@
  * version: 10/30/21
  */
 
+#include <stdio.h>
 #include "ArrayList.h"
 #include "LinkedList.h"
+#include "Bitmap.h"
+#include "KnowledgeBase.h"
+#include "TopK.h"
+
+#define SCAN_RATIO 16  // Rows a column scan tests in the time a filter checks one candidate.
+#define TREE_RATIO 128 // Rows a column scan tests in the time a tree range finds one row.
+
+typedef enum { // Define parameters that query plan steps match.
+  CITY_STEP, RANGE_STEP, CATEGORY_STEP, OPEN_STEP
+} StepKind;
+
+typedef struct { // Define step of a query plan.
+  StepKind kind;
+  ColumnRange range; // Range matched by a range step.
+  int moment;        // Minutes after Monday midnight matched by an open step, -1 if invalid.
+  char text[64];     // Parameter as entered by the user.
+  int estimate;      // Estimated number of restaurants matching the step alone.
+  int actual;        // Number of candidates left after the step, -1 until it is run.
+  int scanned;       // 1 if step read its index or column, 0 if it checked candidates.
+  int indexed;       // 1 if range step read the tree of its column instead of the column.
+} PlanStep;
+
+typedef struct { // Define restaurant found by a fuzzy search.
+  Restaurant *restaurant;
+  int distance; // Edit distance between the searched name and the name of the restaurant.
+} FuzzyMatch;
+
+typedef struct { // Define query plan with steps ordered from the most selective one.
+  PlanStep steps[6];
+  int size;
+  int total;              // Number of restaurants in the knowledge base.
+  char *city;             // Pooled handle of a desired city, NULL if no restaurant is in it.
+  LinkedList *categories; // Pooled handles of desired categories.
+  uint64_t categoryMask;  // Bits of the desired categories, see categoryMask().
+} QueryPlan;
+
+typedef struct { // Define check of candidates against one step, split into morsels.
+  KnowledgeBase *kb;
+  StepKind kind;          // Kind of step candidates are checked against.
+  ColumnRange *range;     // Range of a range step.
+  int city;               // Id of the city handle of a city step.
+  LinkedList *categories; // Desired categories of a category step.
+  uint64_t mask;          // Category mask of the desired categories.
+  int *ids;               // Candidate ids in increasing order, kept ones moved to the front
+  int count;              // of every morsel.
+  int *kept;              // Number of kept ids of every morsel.
+} FilterJob;
+
+typedef struct { // Define check of fuzzy search candidates, split into morsels.
+  Restaurant **restaurants; // Restaurants of the knowledge base by id.
+  uint64_t *masks;          // Masks of positions of every byte in the lowercased name.
+  int length;               // Length of the name.
+  int distance;             // Greatest edit distance.
+  int *candidates;
+  int count;
+  FuzzyMatch *matches;      // Matches of every morsel, from the first candidate of it.
+  int *matched;             // Number of matches of every morsel.
+} FuzzyJob;
+
+/*
+ * Searches the knowledge base based on specified parameters for matches. Returns a list of 
+ * elements matching all parameters.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          desired city.
+ * char*:          desired cost.
+ * char*:          desired categories.
+ * char*:          desired rank.
+ * char*:          desired number of reviewers.
+ * char*:          desired moment of the week restaurants are open at.
+ * return:         pointer to an array list with found elements.
+ */
+extern ArrayList *search(KnowledgeBase*, char*, char*, char*, char*, char*, char*);
+
+/*
+ * Searches the knowledge base like search() for the best restaurants by rank and number of 
+ * reviewers.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          desired city.
+ * char*:          desired cost.
+ * char*:          desired categories.
+ * char*:          desired rank.
+ * char*:          desired number of reviewers.
+ * char*:          desired moment of the week restaurants are open at.
+ * int:            most restaurants to find, negative for no limit.
+ * return:         pointer to an array list with found elements, from the best one.
+ */
+extern ArrayList *searchTop(KnowledgeBase*, char*, char*, char*, char*, char*, char*, int);
+
+/*
+ * Finds the best restaurants matching a query plan by streaming the rank tree.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * QueryPlan*:     pointer to a query plan.
+ * int:            most restaurants to find.
+ * return:         pointer to an array list with found elements, from the best one.
+ */
+extern ArrayList *streamTop(KnowledgeBase*, QueryPlan*, int);
+
+/*
+ * Checks whether a restaurant matches every step of a query plan.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * QueryPlan*:     pointer to a query plan.
+ * int:            id of the restaurant.
+ * return:         1 if restaurant matches, 0 otherwise.
+ */
+extern int matchesPlan(KnowledgeBase*, QueryPlan*, int);
+
+/*
+ * Checks whether a restaurant has at least one of the specified categories.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * int:            id of the restaurant.
+ * LinkedList*:    pointer to a list of desired categories.
+ * uint64_t:       category mask of the desired categories.
+ * return:         1 if restaurant has a desired category, 0 otherwise.
+ */
+extern int hasCategory(KnowledgeBase*, int, LinkedList*, uint64_t);
+
+/*
+ * Searches for restaurants which name is within an edit distance of a name.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          name to search for, at most 64 bytes.
+ * int:            greatest edit distance.
+ * int:            most restaurants to find, negative for no limit.
+ * return:         pointer to an array list with found elements, from the closest one.
+ */
+extern ArrayList *fuzzySearch(KnowledgeBase*, char*, int, int);
+
+/*
+ * Finds edit distance between a pattern and a text, giving up past a bound.
+ *
+ * uint64_t*: masks of positions of every byte in the lowercased pattern.
+ * int:       length of the pattern, at most 64.
+ * char*:     text.
+ * int:       greatest distance of interest.
+ * return:    edit distance, or the bound plus one if distance is greater.
+ */
+extern int boundedDistance(uint64_t*, int, char*, int);
+
+/*
+ * Compares two fuzzy matches by distance, then like compareByRank().
+ *
+ * const void*: pointer to the first match.
+ * const void*: pointer to the second match.
+ * return:      negative, zero or positive if first match goes before, with or after.
+ */
+extern int compareMatches(const void*, const void*);
+
+/*
+ * Verifies candidates of one morsel of a fuzzy search.
+ *
+ * void*: pointer to a fuzzy job.
+ * int:   number of the morsel.
+ */
+extern void verifyMorsel(void*, int);
+
+/*
+ * Searches the knowledge base like search() and writes its query plan instead of the found 
+ * restaurants.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          desired city.
+ * char*:          desired cost.
+ * char*:          desired categories.
+ * char*:          desired rank.
+ * char*:          desired number of reviewers.
+ * char*:          desired moment of the week restaurants are open at.
+ * FILE*:          pointer to a file to write to.
+ */
+extern void explainSearch(KnowledgeBase*, char*, char*, char*, char*, char*, char*, FILE*);
 
 /*
- * Searches the array based on specified parameters for matches. Returns a list of elements
- * matching all parameters.
+ * Plans a search, ordering parameters from the most selective one.
  *
- * ArrayList*: pointer to an array list to search.
- * char*:  desired city.
- * char*:  desired cost.
- * char*:  desired categories.
- * return: pointer to an array list with found elements.
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          desired city.
+ * char*:          desired cost.
+ * char*:          desired categories.
+ * char*:          desired rank.
+ * char*:          desired number of reviewers.
+ * char*:          desired moment of the week restaurants are open at.
+ * return:         pointer to a created query plan.
  */
-extern ArrayList *search(ArrayList*, char*, char*, char*);
+extern QueryPlan *planSearch(KnowledgeBase*, char*, char*, char*, char*, char*, char*);
+
+/*
+ * Runs steps of a query plan in order.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * QueryPlan*:     pointer to a query plan with at least one step.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *runPlan(KnowledgeBase*, QueryPlan*);
+
+/*
+ * Writes steps of a query plan with estimated and actual numbers of candidates.
+ *
+ * QueryPlan*: pointer to a query plan.
+ * FILE*:      pointer to a file to write to.
+ */
+extern void writePlan(QueryPlan*, FILE*);
 
 /*
  * Searches for restaurants matching the city.
  *
- * ArrayList*: pointer to an array list to search.
- * char*:      string of a desired city name.
- * return:     pointer to an array list with found elements.
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * char*:          string of a desired city name.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchCity(KnowledgeBase*, char*);
+
+/*
+ * Searches for restaurants open at a moment of the week.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * int:            minutes after Monday midnight, -1 for an invalid moment.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchOpen(KnowledgeBase*, int);
+
+/*
+ * Finds restaurants within the range of a range step, in the tree or in the column.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * PlanStep*:      pointer to a range step.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *findRange(KnowledgeBase*, PlanStep*);
+
+/*
+ * Finds restaurants within a range in the tree of its column.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * ColumnRange*:   pointer to a range of a column.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchRangeTree(KnowledgeBase*, ColumnRange*);
+
+/*
+ * Writes keys bounding a range in the tree of its column.
+ *
+ * ColumnRange*: pointer to a range of a column.
+ * char*:        buffer for the lowest key within the range.
+ * char*:        buffer for the key past the range, empty if range has no end in the tree.
+ * return:       0 if some value is within the range, -1 otherwise.
  */
-extern ArrayList *searchCity(ArrayList*, char*);
+extern int rangeKeys(ColumnRange*, char*, char*);
 
 /*
- * Searches for restaurants with cost that does not exceed specified value. 
+ * Compares two ids.
  *
- * ArrayList*: pointer ro an array list to search.
- * char*:      string of a maximum cost.
- * return:     pointer to an array list with found elements.
+ * const void*: pointer to the first id.
+ * const void*: pointer to the second id.
+ * return:      negative, zero or positive if first id is less, equal or greater.
  */
-extern ArrayList *searchCost(ArrayList*, char*);
+extern int compareIds(const void*, const void*);
+
+/*
+ * Keeps restaurant ids from a bitmap which value is within a range.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * Bitmap*:        pointer to a bitmap to filter.
+ * ColumnRange*:   pointer to a range of a column.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *filterRange(KnowledgeBase*, Bitmap*, ColumnRange*);
+
+/*
+ * Keeps restaurant ids from a bitmap of restaurants in a city.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * Bitmap*:        pointer to a bitmap to filter.
+ * char*:          pooled handle of a desired city, NULL if no restaurant is in it.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *filterCity(KnowledgeBase*, Bitmap*, char*);
 
 /*
  * Searches for restaurants that have at least one of the specified categories.
  *
- * ArrayList*:  pointer ro an array list to search.
- * LinkedList*: pointer to a list of desired categories.
- * return:      pointer to an array list with found elements.
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * LinkedList*:    pointer to a list of desired categories.
+ * return:         pointer to a bitmap of found restaurant ids.
+ */
+extern Bitmap *searchCategory(KnowledgeBase*, LinkedList*);
+
+/*
+ * Keeps restaurant ids from a bitmap that have at least one of the specified categories.
+ *
+ * KnowledgeBase*: pointer to a knowledge base to search.
+ * Bitmap*:        pointer to a bitmap to filter.
+ * LinkedList*:    pointer to a list of desired categories.
+ * return:         pointer to a bitmap of found restaurant ids.
  */
-extern ArrayList *searchCategory(ArrayList*, LinkedList*);
+extern Bitmap *filterCategories(KnowledgeBase*, Bitmap*, LinkedList*);
 
 /*
- * Merges two array list into one that only contains elements appearing in both lists.
+ * Keeps restaurant ids from a bitmap that match the step of a filter job.
  *
- * ArrayList*: pointer to the first array list to merge.
- * ArrayList*: pointer to the second array list to merge.
- * return:     pointer to a merger array list.
+ * Bitmap*:    pointer to a bitmap to filter.
+ * FilterJob*: pointer to a filter job with the step to match.
+ * return:     pointer to a bitmap of found restaurant ids.
  */
-extern ArrayList *merge(ArrayList*, ArrayList*);
+extern Bitmap *filterIds(Bitmap*, FilterJob*);
+
+/*
+ * Checks candidates of one morsel of a filter job.
+ *
+ * void*: pointer to a filter job.
+ * int:   number of the morsel.
+ */
+extern void filterMorsel(void*, int);
 
 /*
  * Creates a linked list of strings from a single comma-separated string.
@@ -69,4 +338,24 @@ extern ArrayList *merge(ArrayList*, ArrayList*);
  */
 extern LinkedList *stringToList(char*);
 
+/*
+ * Reads a range of a column from a string.
+ *
+ * char*:        string read from the user.
+ * Column:       column of the range.
+ * ColumnRange*: pointer to a range to fill.
+ * return:       0 if string was valid, -1 otherwise.
+ */
+extern int parseRange(char*, Column, ColumnRange*);
+
+/*
+ * Reads a value of a column from the front of a string.
+ *
+ * char*:   string to read from.
+ * Column:  column of the value.
+ * double*: pointer to the read value.
+ * return:  pointer past the value, NULL if string does not start with one.
+ */
+extern char *parseValue(char*, Column, double*);
+
 #endif
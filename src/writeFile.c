@@ -7,28 +7,274 @@
  * version: 12/11/21
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "writeFile.h"
 
 /*
- * Writes a string with information about restaurants to a file with provided vilename.
+ * Writes restaurants stored in a binary tree to a file with provided vilename. Records are 
+ * put into a fixed set of buffers as the tree is traversed, and the buffers are flushed with 
+ * one writev each time all of them are full, so memory does not grow with the tree. File is 
+ * written to a temporary file that is synced and renamed over the old one, so the file is 
+ * either the old one or the new one in full. File that is not a regular one, like a device, 
+ * is written in place.
  * 
- * char*: name of a new file.
- * char*: string with information about restaurants to be written.
+ * *fileName: name of a new file.
+ * *bt:       pointer to a binary tree with restaurants to be written.
+ * return:    0 upon successful execution, -1 if file could not be written.
  */
-int writeFile(char* fileName, char* string) {
-  FILE *outFile = fopen(fileName, "w");
+int writeFile(char* fileName, BinaryTree *bt) {
+  char *temporary = (char*)malloc(strlen(fileName) + 5);
+  struct stat status;
+  int special = stat(fileName, &status) == 0 && !S_ISREG(status.st_mode);
+  FileWriter writer;
+  int descriptor;
+  int failed;
 
-  if (outFile == NULL) { // If failed to open a file.
+  sprintf(temporary, "%s.tmp", fileName);
+  descriptor = open(special ? fileName : temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (descriptor == -1) { // If failed to open a file.
     printf("Could not open file %s.\n", fileName);
+    free(temporary);
     return -1;
   }
 
-  fprintf(outFile, "%s", string);
+  initWriter(&writer, descriptor);
+  traverseBinaryTree(bt, putBTNode, &writer);
+  failed = flushWriter(&writer) != 0;
+  freeWriter(&writer);
+  failed = (!special && fsync(descriptor) != 0) || failed;
+  failed = close(descriptor) != 0 || failed;
+  failed = failed || (!special && rename(temporary, fileName) != 0);
+  if (failed) { // If file was not written whole, leave the old one.
+    printf("Could not write file %s.\n", fileName);
+    if (!special) { // If temporary file was created, remove it.
+      unlink(temporary);
+    }
+  }
+  free(temporary);
+
+  return failed ? -1 : 0;
+}
+
+/*
+ * Initialyzes a writer to a file and allocates its buffers, WRITE_BUFFERS of WRITE_BUFFER 
+ * bytes, which is all the memory it takes.
+ *
+ * *writer:    pointer to a writer.
+ * descriptor: descriptor of a file open for writing.
+ */
+void initWriter(FileWriter *writer, int descriptor) {
+  writer->descriptor = descriptor;
+  writer->current    = 0;
+  writer->used       = 0;
+  writer->failed     = 0;
+  for (int b = 0; b < WRITE_BUFFERS; b++) { // Allocate every buffer.
+    writer->buffers[b] = (char*)malloc(WRITE_BUFFER);
+  }
+}
+
+/*
+ * Appends bytes to a writer, filling buffers in turn and flushing them once all are full.
+ *
+ * *writer: pointer to a writer.
+ * *bytes:  bytes to append.
+ * size:    number of bytes.
+ */
+void putBytes(FileWriter *writer, char *bytes, size_t size) {
+  while (size > 0) { // Copy bytes into as many buffers as they take.
+    size_t part = WRITE_BUFFER - writer->used;
+
+    part = part < size ? part : size;
+    memcpy(writer->buffers[writer->current] + writer->used, bytes, part);
+    writer->used += part;
+    bytes        += part;
+    size         -= part;
+    if (writer->used == WRITE_BUFFER) { // If buffer is full, go on to the next one.
+      writer->current++;
+      writer->used = 0;
+    }
+    if (writer->current == WRITE_BUFFERS) { // If every buffer is full, flush them.
+      flushWriter(writer);
+    }
+  }
+}
+
+/*
+ * Appends a string to a writer.
+ *
+ * *writer: pointer to a writer.
+ * *string: string to append.
+ */
+void putString(FileWriter *writer, char *string) {
+  putBytes(writer, string, strlen(string));
+}
+
+/*
+ * Appends a restaurant to a writer, one field per line followed by an empty line. Produces 
+ * the same text as writeRestaurant().
+ *
+ * *writer:     pointer to a writer.
+ * *restaurant: pointer to a restaurant.
+ */
+void putRestaurant(FileWriter *writer, Restaurant *restaurant) {
+  char text[64]; // Holds an interval or the numbers closing a restaurant.
+  int length;
+
+  putString(writer, restaurant->name);
+  putBytes(writer, "\n", 1);
+  putString(writer, restaurant->city);
+  putBytes(writer, "\n", 1);
+  for (Node *node = restaurant->categories->head; node != NULL; node = node->next) { // Put.
+    putString(writer, node->data);
+    if (node->next != NULL) { // Delimit all but the last category.
+      putBytes(writer, ", ", 2);
+    }
+  }
+  putBytes(writer, "\n", 1);
+  for (int i = 0; i < restaurant->hours.count; i++) { // Put every interval.
+    if (i > 0) { // Delimit all but the first interval.
+      putBytes(writer, ", ", 2);
+    }
+    length = formatInterval(&restaurant->hours.intervals[i], text);
+    putBytes(writer, text, length);
+  }
+  putBytes(writer, "\n", 1);
+  putString(writer, restaurant->cost);
+  text[0] = '\n';
+  length  = 1 + formatRank(restaurant->rank, text + 1);
+  text[length++] = '\n';
+  length += formatInteger(restaurant->reviewers, text + length);
+  text[length++] = '\n';
+  text[length++] = '\n';
+  putBytes(writer, text, length);
+}
+
+/*
+ * Writes a rank with one decimal, the same as "%0.1f" does. Rank times ten is exact in a 
+ * double, and rounding it to an integer in the current rounding mode rounds the same way 
+ * printf() does. Ranks too large for that are written by sprintf().
+ *
+ * rank:   rank to write.
+ * *text:  bytes to write to, at least 48.
+ * return: number of written bytes.
+ */
+int formatRank(float rank, char *text) {
+  double tenths = rint((double)rank * 10);
+  long long whole;
+  int length = 0;
 
-  fclose(outFile);
+  if (!isfinite(tenths) || fabs(tenths) >= 1e15) { // If rank is too large to write by hand.
+    return sprintf(text, "%0.1f", rank);
+  }
+  if (signbit(rank)) { // If rank is negative, write the sign, also of a zero it rounds to.
+    text[length++] = '-';
+    tenths = -tenths;
+  }
+  whole   = (long long)tenths;
+  length += formatInteger(whole / 10, text + length);
+  text[length++] = '.';
+  text[length++] = '0' + whole % 10;
+
+  return length;
+}
+
+/*
+ * Writes an integer in decimal, the same as "%lld" does.
+ *
+ * value:  integer to write.
+ * *text:  bytes to write to, at least 20.
+ * return: number of written bytes.
+ */
+int formatInteger(long long value, char *text) {
+  unsigned long long magnitude = value < 0 ? -(unsigned long long)value
+      : (unsigned long long)value;
+  char digits[20];
+  int count  = 0;
+  int length = 0;
+
+  if (value < 0) { // If integer is negative, write the sign.
+    text[length++] = '-';
+  }
+  do { // Take digits from the last one.
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude > 0);
+  while (count > 0) { // Write digits from the first one.
+    text[length++] = digits[--count];
+  }
+  return length;
+}
+
+/*
+ * Appends restaurants of a node to a writer. Used as a visitor.
+ *
+ * *node:   pointer to a node.
+ * *writer: pointer to a writer.
+ */
+void putBTNode(BTNode *node, void *writer) {
+  for (int i = 0; i < getSize(node->restaurants); i++) { // Put each restaurant.
+    putRestaurant((FileWriter*)writer, getRestaurant(node->restaurants, i));
+  }
+}
+
+/*
+ * Writes filled bytes of every buffer of a writer with one writev, then empties the buffers.
+ * Write that takes only a part of the bytes is continued from where it stopped. Once a write
+ * fails, the writer drops whatever it is given, and reports the failure on every flush.
+ *
+ * *writer: pointer to a writer.
+ * return:  0 upon successful execution, -1 if bytes could not be written.
+ */
+int flushWriter(FileWriter *writer) {
+  struct iovec vectors[WRITE_BUFFERS];
+  struct iovec *vector = vectors;
+  int count = writer->current + (writer->used > 0);
+
+  for (int b = 0; b < count; b++) { // Point to filled bytes of every buffer.
+    vectors[b].iov_base = writer->buffers[b];
+    vectors[b].iov_len  = b < writer->current ? WRITE_BUFFER : writer->used;
+  }
+  while (count > 0 && !writer->failed) { // Write until every buffer is written.
+    ssize_t bytes = writev(writer->descriptor, vector, count);
 
-  return 0;
+    if (bytes == -1 && errno == EINTR) { // If write was interrupted, try again.
+      continue;
+    }
+    if (bytes <= 0) { // If write failed.
+      writer->failed = 1;
+      break;
+    }
+    while (count > 0 && (size_t)bytes >= vector->iov_len) { // Skip written buffers.
+      bytes -= vector->iov_len;
+      vector++;
+      count--;
+    }
+    if (count > 0) { // If a buffer was written in part, continue from where it stopped.
+      vector->iov_base = (char*)vector->iov_base + bytes;
+      vector->iov_len -= bytes;
+    }
+  }
+  writer->current = 0;
+  writer->used    = 0;
+
+  return writer->failed ? -1 : 0;
+}
+
+/*
+ * Frees buffers of a writer.
+ *
+ * *writer: pointer to a writer.
+ */
+void freeWriter(FileWriter *writer) {
+  for (int b = 0; b < WRITE_BUFFERS; b++) { // Free every buffer.
+    free(writer->buffers[b]);
+  }
 }
@@ -10,12 +10,101 @@
  * version: 12/11/21
  */
 
+#include <stddef.h>
+#include "BinaryTree.h"
+
+#define WRITE_BUFFER  (64 * 1024) // Size of an output buffer in bytes.
+#define WRITE_BUFFERS 8           // Number of output buffers, flushed together by one writev.
+
+typedef struct { // Define writer filling a fixed set of buffers and flushing them at once.
+  int descriptor;
+  char *buffers[WRITE_BUFFERS];
+  int current;  // Buffer being filled.
+  size_t used;  // Bytes of the buffer being filled.
+  int failed;   // Whether a flush failed, so the file is not whole.
+} FileWriter;
+
+/*
+ * Writes restaurants stored in a binary tree to a file with provided vilename.
+ *
+ * char*:       name of a new file.
+ * BinaryTree*: pointer to a binary tree with restaurants to be written.
+ * return:      0 upon successful execution, -1 if file could not be written.
+ */
+extern int writeFile(char*, BinaryTree*);
+
+/*
+ * Initialyzes a writer to a file.
+ *
+ * FileWriter*: pointer to a writer.
+ * int:         descriptor of a file open for writing.
+ */
+extern void initWriter(FileWriter*, int);
+
+/*
+ * Appends bytes to a writer, flushing its buffers once all of them are full.
+ *
+ * FileWriter*: pointer to a writer.
+ * char*:       bytes to append.
+ * size_t:      number of bytes.
+ */
+extern void putBytes(FileWriter*, char*, size_t);
+
+/*
+ * Appends a string to a writer.
+ *
+ * FileWriter*: pointer to a writer.
+ * char*:       string to append.
+ */
+extern void putString(FileWriter*, char*);
+
+/*
+ * Appends a restaurant to a writer in the form it is read in.
+ *
+ * FileWriter*: pointer to a writer.
+ * Restaurant*: pointer to a restaurant.
+ */
+extern void putRestaurant(FileWriter*, Restaurant*);
+
+/*
+ * Writes a rank with one decimal, the same as "%0.1f" does.
+ *
+ * float:  rank to write.
+ * char*:  bytes to write to, at least 48.
+ * return: number of written bytes.
+ */
+extern int formatRank(float, char*);
+
+/*
+ * Writes an integer in decimal.
+ *
+ * long long: integer to write.
+ * char*:     bytes to write to, at least 20.
+ * return:    number of written bytes.
+ */
+extern int formatInteger(long long, char*);
+
+/*
+ * Appends restaurants of a node to a writer. Used as a visitor.
+ *
+ * BTNode*: pointer to a node.
+ * void*:   pointer to a writer.
+ */
+extern void putBTNode(BTNode*, void*);
+
 /*
- * Writes a string with information about restaurants to a file with provided vilename.
- * 
- * char*: name of a new file.
- * char*: string with information about restaurants to be written.
+ * Writes filled bytes of every buffer of a writer with one writev.
+ *
+ * FileWriter*: pointer to a writer.
+ * return:      0 upon successful execution, -1 if bytes could not be written.
+ */
+extern int flushWriter(FileWriter*);
+
+/*
+ * Frees buffers of a writer.
+ *
+ * FileWriter*: pointer to a writer.
  */
-extern int writeFile(char*, char*);
+extern void freeWriter(FileWriter*);
 
 #endif